@@ -1,26 +1,434 @@
-function decodeUplink(input) {
-  var data = {};
-  
-  data.preamble = input.bytes[0];
-  data.status = input.bytes[1];
-  data.batteryVoltage = (200.0 + input.bytes[2]) / 100.0;
-  data.crc8le = input.bytes[3];
+// TTN uplink payload formatter for all frame formats of this firmware,
+// see lib/Payload/Payload.hpp
+//
+//   FPort 1  TxFrameData, 10 bytes with BME280, 4 bytes without
+//   FPort 2  compact frame, version 1
+//   FPort 3  backlog frame of samples whose uplink failed, version 1
+//
+// encodeDownlink() builds FPort 10 command downlinks, a stream of tag,
+// length and big endian value, see lib/Command/Command.hpp
+
+// CRC8, polynomial 0x07, init 0x00 (same as lib/CRC8 on the device)
+function crc8(bytes, length) {
+  var crc = 0x00;
+  for (var i = 0; i < length; i++) {
+    crc ^= bytes[i];
+    for (var b = 0; b < 8; b++) {
+      crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) & 0xFF : (crc << 1) & 0xFF;
+    }
+  }
+  return crc;
+}
 
+function int16(value) {
+  return (value & 0x8000) ? value - 0x10000 : value;
+}
+
+function batteryPercentage(voltage) {
   // 100% battery is 4.1V
   // 0% battery is 2.5V
-  var battery = data.batteryVoltage;
-  if ( battery > 4.1 ) {
-    battery = 4.1;
+  if (voltage > 4.1) {
+    voltage = 4.1;
+  }
+  var percentage = Math.round((voltage - 2.5) / (4.1 - 2.5) * 100.0);
+  return percentage < 0 ? 0 : percentage;
+}
+
+function failure(message) {
+  return { data: {}, warnings: [], errors: [message] };
+}
+
+// FPort 1
+function decodeFrame(input) {
+  var bytes = input.bytes;
+  var data = {};
+
+  // reject corrupt frames instead of graphing them
+  if (bytes.length !== 10 && bytes.length !== 4) {
+    return failure("invalid frame length " + bytes.length);
+  }
+  if (crc8(bytes, bytes.length - 1) !== bytes[bytes.length - 1]) {
+    return failure("crc8 mismatch");
+  }
+
+  data.preamble = bytes[0];
+  data.status = bytes[1];
+
+  var index = 2;
+  if (bytes.length === 10) {
+    // BME280 data
+    data.temperature = int16((bytes[3] << 8) | bytes[2]) / 100.0;
+    data.humidity = ((bytes[5] << 8) | bytes[4]) / 100.0;
+    data.pressure = (((bytes[7] << 8) | bytes[6]) + 80000) / 100.0;
+    index = 8;
+  }
+
+  data.batteryVoltage = (200.0 + bytes[index]) / 100.0;
+  data.batteryPercentage = batteryPercentage(data.batteryVoltage);
+  data.crc8le = bytes[index + 1];
+
+  return { data: data, warnings: [], errors: [] };
+}
+
+// samples per frame, MAX_BATCH_SIZE in lib/AppConfig
+var MAX_BATCH_SIZE = 16;
+
+// FPort 2
+var COMPACT_BATCH = 0x20;
+var COMPACT_TEMPERATURE = 0x01;
+var COMPACT_HUMIDITY = 0x02;
+var COMPACT_PRESSURE = 0x04;
+var COMPACT_BATTERY = 0x08;
+var COMPACT_EXTENSION = 0x10;
+
+var COMPACT_STATUS_SENSOR = 0x02;
+
+var COMPACT_EXT_ACK = 0x01;
+var COMPACT_EXT_BUS = 0x02;
+var COMPACT_EXT_JOIN = 0x03;
+var COMPACT_EXT_LINK = 0x04;
+var COMPACT_EXT_BATTERY = 0x05;
+var COMPACT_EXT_SPREAD = 0x06;
+
+var SPREAD_FIELDS = [
+  { flag: COMPACT_TEMPERATURE, name: "temperatureSpread" },
+  { flag: COMPACT_HUMIDITY, name: "humiditySpread" },
+  { flag: COMPACT_PRESSURE, name: "pressureSpread" }
+];
+
+var COMMAND_STATUS = ["ok", "malformed", "unknown", "invalid"];
+
+function decodeExtension(tag, value, data, warnings) {
+  switch (tag) {
+    case COMPACT_EXT_ACK:
+      if (value.length === 3) {
+        data.commandAck = {
+          status: COMMAND_STATUS[value[0]] || value[0],
+          tag: value[1],
+          count: value[2]
+        };
+        return;
+      }
+      break;
+    case COMPACT_EXT_BUS:
+      if (value.length === 6) {
+        data.i2c = {
+          errors: (value[0] << 8) | value[1],
+          retries: (value[2] << 8) | value[3],
+          failures: (value[4] << 8) | value[5]
+        };
+        return;
+      }
+      break;
+    case COMPACT_EXT_JOIN:
+      if (value.length === 2) {
+        data.joinAttempts = (value[0] << 8) | value[1];
+        return;
+      }
+      break;
+    case COMPACT_EXT_LINK:
+      if (value.length === 8) {
+        data.link = {
+          confirmed: (value[0] << 8) | value[1],
+          acked: (value[2] << 8) | value[3],
+          margin: value[4] === 0x80 ? null : (value[4] << 24) >> 24,
+          rssi: value[4] === 0x80 ? null : (((value[5] << 8) | value[6]) << 16) >> 16,
+          txPower: value[7]
+        };
+        return;
+      }
+      break;
+    case COMPACT_EXT_BATTERY:
+      if (value.length === 3) {
+        // the device fuel gauge replaces the linear estimate
+        data.batteryPercentage = value[0];
+        var days = (value[1] << 8) | value[2];
+        if (days !== 0xFFFF) {
+          data.batteryDays = days;
+        }
+        return;
+      }
+      break;
+    case COMPACT_EXT_SPREAD:
+      // standard deviation behind the latest values, same units
+      var spread = {};
+      var pos = 1;
+      for (var i = 0; i < SPREAD_FIELDS.length && value.length > 0; i++) {
+        if (value[0] & SPREAD_FIELDS[i].flag) {
+          spread[SPREAD_FIELDS[i].name] = ((value[pos] << 8) | value[pos + 1]) / 100.0;
+          pos += 2;
+        }
+      }
+      if (value.length > 0 && pos === value.length) {
+        for (var name in spread) {
+          data[name] = spread[name];
+        }
+        return;
+      }
+      break;
+  }
+  var key = "ext" + ("0" + tag.toString(16)).slice(-2);
+  data[key] = value;
+  warnings.push("unknown extension tag " + tag);
+}
+
+function decodeCompact(input) {
+  var bytes = input.bytes;
+  var warnings = [];
+  var data = {};
+
+  if (bytes.length < 3) {
+    return failure("invalid frame length " + bytes.length);
+  }
+  if (crc8(bytes, bytes.length - 1) !== bytes[bytes.length - 1]) {
+    return failure("crc8 mismatch");
+  }
+
+  var end = bytes.length - 1;
+  var pos = 0;
+  var error = null;
+
+  function next() {
+    if (pos >= end) {
+      error = "truncated frame";
+      return 0;
+    }
+    return bytes[pos++];
+  }
+
+  function varint() {
+    var value = 0;
+    var factor = 1;
+    for (var i = 0; i < 5; i++) {
+      var b = next();
+      value += (b & 0x7F) * factor;
+      if (!(b & 0x80)) {
+        return value;
+      }
+      factor *= 128;
+    }
+    error = "invalid varint";
+    return 0;
+  }
+
+  function zigzag() {
+    var value = varint();
+    return (value % 2) ? -(value + 1) / 2 : value / 2;
+  }
+
+  var header = next();
+  data.version = header >> 6;
+  if (data.version !== 1) {
+    return failure("unsupported version " + data.version);
   }
-  data.batteryPercentage =  Math.round((battery - 2.5) / (4.1 - 2.5) * 100.0);
-  if ( data.batteryPercentage < 0 )
-  {
-    data.batteryPercentage = 0;
+  var fields = header & 0x1F;
+  data.status = next();
+  if (data.status & COMPACT_STATUS_SENSOR) {
+    warnings.push("sensor read failed");
   }
 
-  return {
-    data: data,
-    warnings: [],
-    errors: []
-  };
+  var count = 1;
+  data.interval = 0;
+  if (header & COMPACT_BATCH) {
+    count = next();
+    data.interval = varint();
+    if (count > MAX_BATCH_SIZE) {
+      return failure("too many samples " + count);
+    }
+  }
+
+  if (fields & COMPACT_BATTERY) {
+    data.batteryVoltage = (200.0 + next()) / 100.0;
+    data.batteryPercentage = batteryPercentage(data.batteryVoltage);
+  }
+
+  // the last sample was taken right before the uplink
+  var received = input.recvTime ? new Date(input.recvTime).getTime() : Date.now();
+  var temperature = 0;
+  var humidity = 0;
+  var pressure = 101325;
+  var samples = [];
+
+  for (var i = 0; i < count; i++) {
+    var sample = {};
+    if (fields & COMPACT_TEMPERATURE) {
+      temperature += zigzag();
+      sample.temperature = temperature / 100.0;
+    }
+    if (fields & COMPACT_HUMIDITY) {
+      humidity += zigzag();
+      sample.humidity = humidity / 100.0;
+    }
+    if (fields & COMPACT_PRESSURE) {
+      pressure += zigzag();
+      sample.pressure = pressure / 100.0;
+    }
+    sample.time = new Date(received - (count - 1 - i) * data.interval * 1000).toISOString();
+    samples.push(sample);
+  }
+
+  if (fields & COMPACT_EXTENSION) {
+    while (pos < end && !error) {
+      var tag = next();
+      var length = next();
+      var value = [];
+      for (var j = 0; j < length; j++) {
+        value.push(next());
+      }
+      if (!error) {
+        decodeExtension(tag, value, data, warnings);
+      }
+    }
+  }
+
+  if (error || pos !== end) {
+    return failure(error || "trailing bytes");
+  }
+
+  // latest values, same fields as FPort 1
+  if (samples.length > 0) {
+    var latest = samples[samples.length - 1];
+    if ("temperature" in latest) data.temperature = latest.temperature;
+    if ("humidity" in latest) data.humidity = latest.humidity;
+    if ("pressure" in latest) data.pressure = latest.pressure;
+  }
+  if (count > 1) {
+    data.samples = samples;
+  }
+
+  return { data: data, warnings: warnings, errors: [] };
+}
+
+// FPort 3, samples whose uplink failed, lib/Payload/Payload.hpp
+var BACKLOG_REBASED = 0x20;
+var BACKLOG_REF_PRESSURE = 50000;
+
+function decodeBacklog(input) {
+  var bytes = input.bytes;
+  var warnings = [];
+  var data = {};
+
+  if (bytes.length < 3) {
+    return failure("invalid frame length " + bytes.length);
+  }
+  if (crc8(bytes, bytes.length - 1) !== bytes[bytes.length - 1]) {
+    return failure("crc8 mismatch");
+  }
+  data.version = bytes[0] >> 6;
+  if (data.version !== 1) {
+    return failure("unsupported version " + data.version);
+  }
+  var fields = bytes[0] & 0x07;
+  var count = bytes[1];
+  if (count > MAX_BATCH_SIZE) {
+    return failure("too many samples " + count);
+  }
+  var size = 2;
+  for (var f = 1; f <= COMPACT_PRESSURE; f <<= 1) {
+    if (fields & f) size += 2;
+  }
+  if (bytes.length !== 3 + count * size) {
+    return failure("invalid frame length " + bytes.length);
+  }
+  if (bytes[0] & BACKLOG_REBASED) {
+    data.rebased = true;
+    warnings.push("device reset since some samples were taken, their age is a lower bound");
+  }
+
+  var received = input.recvTime ? new Date(input.recvTime).getTime() : Date.now();
+  var pos = 2;
+  function word() {
+    var value = (bytes[pos] << 8) | bytes[pos + 1];
+    pos += 2;
+    return value;
+  }
+
+  data.samples = [];
+  for (var i = 0; i < count; i++) {
+    var sample = {};
+    var age = word();
+    if (fields & COMPACT_TEMPERATURE) {
+      sample.temperature = ((word() << 16) >> 16) / 100.0;
+    }
+    if (fields & COMPACT_HUMIDITY) {
+      sample.humidity = word() / 100.0;
+    }
+    if (fields & COMPACT_PRESSURE) {
+      sample.pressure = (word() + BACKLOG_REF_PRESSURE) / 100.0;
+    }
+    sample.time = new Date(received - age * 60000).toISOString();
+    data.samples.push(sample);
+  }
+
+  return { data: data, warnings: warnings, errors: [] };
+}
+
+function decodeUplink(input) {
+  switch (input.fPort) {
+    case 1:
+      return decodeFrame(input);
+    case 2:
+      return decodeCompact(input);
+    case 3:
+      return decodeBacklog(input);
+    default:
+      return failure("unknown fPort " + input.fPort);
+  }
+}
+
+// FPort 10, lib/Command/Command.hpp
+var COMMANDS = {
+  sleeptime: { tag: 0x01, size: 4 },
+  aggregation: { tag: 0x02, size: 1 },
+  batchsize: { tag: 0x03, size: 1 },
+  deadband: { tag: 0x04, size: [2, 2, 2] },
+  maxsilence: { tag: 0x05, size: 4 },
+  interval: { tag: 0x06, size: [4, 4] },
+  rate: { tag: 0x07, size: [2, 2, 2] },
+  battery: { tag: 0x08, size: [2, 2] },
+  senddelay: { tag: 0x09, size: 4 },
+  oversampling: { tag: 0x0A, size: 1 },
+  datarate: { tag: 0x0B, size: 1 }, // "adr" or 0..5
+  confirmed: { tag: 0x0C, size: 1 }
+};
+
+function bigEndian(value, size, bytes) {
+  for (var i = size - 1; i >= 0; i--) {
+    bytes.push(Math.floor(value / Math.pow(256, i)) & 0xFF);
+  }
+}
+
+// { sleeptime: 900000, deadband: [10, 50, 0], datarate: "adr" }
+function encodeDownlink(input) {
+  var bytes = [];
+  var errors = [];
+  for (var name in input.data) {
+    var command = COMMANDS[name];
+    if (!command) {
+      errors.push("unknown command " + name);
+      continue;
+    }
+    var value = input.data[name];
+    if (name === "datarate" && value === "adr") {
+      value = 0xFF;
+    }
+    var sizes = Array.isArray(command.size) ? command.size : [command.size];
+    var values = Array.isArray(value) ? value : [value];
+    if (values.length !== sizes.length) {
+      errors.push(name + " needs " + sizes.length + " values");
+      continue;
+    }
+    var length = 0;
+    for (var i = 0; i < sizes.length; i++) {
+      length += sizes[i];
+    }
+    bytes.push(command.tag, length);
+    for (var j = 0; j < sizes.length; j++) {
+      bigEndian(values[j], sizes[j], bytes);
+    }
+  }
+  if (errors.length > 0) {
+    return { errors: errors };
+  }
+  return { bytes: bytes, fPort: 10 };
 }
@@ -0,0 +1,217 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+// Aggregation modes (AppConfig.aggregation, downlink A5 02 xx)
+#define AGGREGATION_LAST 0         // last sample only
+#define AGGREGATION_MEAN 1         // arithmetic mean
+#define AGGREGATION_MEDIAN 2       // median
+#define AGGREGATION_TRIMMED_MEAN 3 // mean without the lowest and highest quarter
+#define AGGREGATION_MIN 4          // minimum
+#define AGGREGATION_MAX 5          // maximum
+#define AGGREGATION_MODES 6        // valid modes are below
+
+// Fixed size sample window, no heap, integer arithmetic only.
+// T must be an integer type, N is the window length.
+template <typename T, uint8_t N>
+class Aggregator
+{
+public:
+  void reset()
+  {
+    count = 0;
+  }
+
+  // Returns false if the window is already full
+  bool add(T value)
+  {
+    if (count >= N)
+    {
+      return false;
+    }
+    samples[count++] = value;
+    return true;
+  }
+
+  uint8_t size() const
+  {
+    return count;
+  }
+
+  T last() const
+  {
+    return count ? samples[count - 1] : 0;
+  }
+
+  T min() const
+  {
+    T m = count ? samples[0] : 0;
+    for (uint8_t i = 1; i < count; i++)
+    {
+      if (samples[i] < m)
+      {
+        m = samples[i];
+      }
+    }
+    return m;
+  }
+
+  T max() const
+  {
+    T m = count ? samples[0] : 0;
+    for (uint8_t i = 1; i < count; i++)
+    {
+      if (samples[i] > m)
+      {
+        m = samples[i];
+      }
+    }
+    return m;
+  }
+
+  T mean() const
+  {
+    return meanOf(samples, 0, count);
+  }
+
+  T median() const
+  {
+    if (!count)
+    {
+      return 0;
+    }
+    T s[N];
+    sorted(s);
+    if (count & 1)
+    {
+      return s[count / 2];
+    }
+    return meanOf(s, count / 2 - 1, count / 2 + 1);
+  }
+
+  // Mean of the samples without the lowest and highest quarter
+  T trimmedMean() const
+  {
+    if (!count)
+    {
+      return 0;
+    }
+    T s[N];
+    sorted(s);
+    uint8_t trim = count / 4;
+    return meanOf(s, trim, count - trim);
+  }
+
+  // Population variance in units^2, saturated to 32 bit
+  uint32_t variance() const
+  {
+    if (!count)
+    {
+      return 0;
+    }
+    int64_t sum = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+      sum += samples[i];
+    }
+    int64_t m = sum / count;
+    uint64_t squares = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+      int64_t d = (int64_t)samples[i] - m;
+      squares += (uint64_t)(d * d);
+    }
+    squares /= count;
+    return squares > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)squares;
+  }
+
+  // Standard deviation in units, rounded down, saturated to 16 bit
+  uint16_t deviation() const
+  {
+    uint32_t v = variance();
+    uint32_t root = 0;
+    for (uint32_t bit = 1UL << 30; bit; bit >>= 2)
+    {
+      if (v >= root + bit)
+      {
+        v -= root + bit;
+        root = (root >> 1) + bit;
+      }
+      else
+      {
+        root >>= 1;
+      }
+    }
+    return root > 0xFFFF ? 0xFFFF : (uint16_t)root;
+  }
+
+  T aggregate(uint8_t mode) const
+  {
+    switch (mode)
+    {
+    case AGGREGATION_MEAN:
+      return mean();
+    case AGGREGATION_MEDIAN:
+      return median();
+    case AGGREGATION_TRIMMED_MEAN:
+      return trimmedMean();
+    case AGGREGATION_MIN:
+      return min();
+    case AGGREGATION_MAX:
+      return max();
+    default:
+      return last();
+    }
+  }
+
+private:
+  T samples[N];
+  uint8_t count = 0;
+
+  // Insertion sort into a copy, N is small
+  void sorted(T *s) const
+  {
+    for (uint8_t i = 0; i < count; i++)
+    {
+      T v = samples[i];
+      uint8_t j = i;
+      while (j > 0 && s[j - 1] > v)
+      {
+        s[j] = s[j - 1];
+        j--;
+      }
+      s[j] = v;
+    }
+  }
+
+  // Rounded mean of s[from..to-1]
+  static T meanOf(const T *s, uint8_t from, uint8_t to)
+  {
+    if (to <= from)
+    {
+      return 0;
+    }
+    int64_t sum = 0;
+    for (uint8_t i = from; i < to; i++)
+    {
+      sum += s[i];
+    }
+    int64_t n = to - from;
+    sum += (sum < 0) ? -n / 2 : n / 2;
+    return (T)(sum / n);
+  }
+};
@@ -16,19 +16,18 @@
 
 #include <LoRaWanMinimal_APP.h>
 #include <EEPROM.h>
+#include <ConfigStore.hpp>
+#include <Power.hpp>
 #include "AppConfig.hpp"
 
+static_assert(sizeof(AppConfig) <= CONFIG_RECORD_MAX_DATA, "AppConfig does not fit into a config record");
+static_assert(CONFIG_RECORD_MAX_DATA - sizeof(AppConfig) < CONFIG_BLOCK, "config slots are larger than AppConfig needs");
+
 AppConfig appConfig;
 
 CubeCell_NeoPixel pixels(1, RGB, NEO_GRB + NEO_KHZ800);
 
-static void initBoardLED()
-{
-  pinMode(Vext, OUTPUT);
-  digitalWrite(Vext, LOW);
-  pixels.begin();
-  pixels.clear();
-}
+static bool boardLEDOn;
 
 static uint8_t *generateDevEUIByChipID()
 {
@@ -52,7 +51,9 @@ static void printHex(char *label, uint8_t *buffer, int length)
   Serial.println();
 }
 
-static void read_config()
+// Firmware before the config store kept AppConfig at EEPROM offset 0,
+// true if such a configuration was found
+static bool read_legacy_config()
 {
   EEPROM.begin(512);
 
@@ -62,27 +63,103 @@ static void read_config()
   }
 
   EEPROM.end();
+  return appConfig.magic == EEPROM_MAGIC;
 }
 
-void write_config()
+// Returns true if a legacy configuration has to be migrated
+static bool read_config()
 {
-  EEPROM.begin(512);
-  for (int i = 0; i < sizeof(AppConfig); i++)
+  if (config_store_read(&appConfig, sizeof(AppConfig)) > 0)
   {
-    EEPROM.write(i, *((uint8_t *)&appConfig + i));
+    return false;
   }
-  EEPROM.commit();
-  EEPROM.end();
+  return read_legacy_config();
+}
+
+// Fields appended in later versions are read from unused EEPROM bytes,
+// replace invalid values with their defaults
+static void sanitize_config()
+{
+  if (appConfig.aggregation >= AGGREGATION_MODES)
+  {
+    appConfig.aggregation = AGGREGATION_MODE;
+  }
+  if (appConfig.batchsize == 0 || appConfig.batchsize > MAX_BATCH_SIZE)
+  {
+    appConfig.batchsize = BATCH_SIZE;
+  }
+  if (appConfig.deadbandTemperature == 0xFFFF)
+  {
+    appConfig.deadbandTemperature = DEADBAND_TEMPERATURE;
+  }
+  if (appConfig.deadbandHumidity == 0xFFFF)
+  {
+    appConfig.deadbandHumidity = DEADBAND_HUMIDITY;
+  }
+  if (appConfig.deadbandPressure == 0xFFFF)
+  {
+    appConfig.deadbandPressure = DEADBAND_PRESSURE;
+  }
+  if (appConfig.maxsilence == 0 || appConfig.maxsilence == 0xFFFFFFFF)
+  {
+    appConfig.maxsilence = MAX_SILENCE;
+  }
+  if (appConfig.minsleeptime == 0 || appConfig.maxsleeptime == 0xFFFFFFFF ||
+      appConfig.minsleeptime > appConfig.maxsleeptime)
+  {
+    appConfig.minsleeptime = MIN_SLEEPTIME;
+    appConfig.maxsleeptime = MAX_SLEEPTIME;
+  }
+  if (appConfig.rateTemperature == 0xFFFF)
+  {
+    appConfig.rateTemperature = RATE_TEMPERATURE;
+  }
+  if (appConfig.rateHumidity == 0xFFFF)
+  {
+    appConfig.rateHumidity = RATE_HUMIDITY;
+  }
+  if (appConfig.ratePressure == 0xFFFF)
+  {
+    appConfig.ratePressure = RATE_PRESSURE;
+  }
+  if (appConfig.batteryLow == 0xFFFF || appConfig.batteryCritical == 0xFFFF)
+  {
+    appConfig.batteryLow = BATTERY_LOW;
+    appConfig.batteryCritical = BATTERY_CRITICAL;
+  }
+  if (appConfig.oversampling == 0 || appConfig.oversampling > 5)
+  {
+    appConfig.oversampling = SENSOR_OVERSAMPLING;
+  }
+  if (appConfig.adr > 1)
+  {
+    appConfig.adr = ADAPTIVE_DR;
+  }
+  if (appConfig.datarate > MAX_DR)
+  {
+    appConfig.datarate = FIXED_DR;
+  }
+  if (appConfig.confirmed == 0xFF)
+  {
+    appConfig.confirmed = CONFIRMED_UPLINKS;
+  }
+}
+
+void write_config()
+{
+  config_store_write(&appConfig, sizeof(AppConfig));
 }
 
 void init_app_config()
 {
-  initBoardLED();
+  power_init();
   showBoardLED(50, 0, 0);
 
-  Serial.begin(115200);
+  power_acquire(POWER_UART);
   pinMode(GPIO7, INPUT_PULLUP);
-  delay(6000);
+#if CONSOLE_DELAY > 0
+  delay(CONSOLE_DELAY);
+#endif
 
   Serial.println("\n\nLoRaWAN TTN OTAA, Version: " APP_VERSION " (c)2025 Thorsten Ludewig (t.ludewig@gmail.com)");
   Serial.println("Build timestamp: " __DATE__ " " __TIME__);
@@ -91,15 +168,23 @@ void init_app_config()
   Serial.printf("ChipID: %04X%08X\n\n", (uint32_t)(chipID >> 32), (uint32_t)chipID);
 
   bool reconfigure = digitalRead(GPIO7) == LOW;
+  // a jumper left on GPIO7 would draw current through the pull-up
+  pinMode(GPIO7, ANALOG);
 
   Serial.printf("GPIO0: %s\n\n", reconfigure ? "LOW" : "HIGH");
-  read_config();
+  bool legacy = read_config();
   Serial.println("\nEEPROM read done.\n");
 
   if (appConfig.magic == EEPROM_MAGIC && !reconfigure)
   {
     Serial.println("*** valid eeprom magic found!");
     Serial.println("*** using config from eeprom.");
+    sanitize_config();
+    if (legacy)
+    {
+      Serial.println("*** migrating config to the config store.");
+      write_config();
+    }
   }
   else
   {
@@ -115,6 +200,23 @@ void init_app_config()
 #endif
 
     appConfig.senddelay = DEFAULT_SENDDELAY;
+    appConfig.aggregation = AGGREGATION_MODE;
+    appConfig.batchsize = BATCH_SIZE;
+    appConfig.deadbandTemperature = DEADBAND_TEMPERATURE;
+    appConfig.deadbandHumidity = DEADBAND_HUMIDITY;
+    appConfig.deadbandPressure = DEADBAND_PRESSURE;
+    appConfig.maxsilence = MAX_SILENCE;
+    appConfig.minsleeptime = MIN_SLEEPTIME;
+    appConfig.maxsleeptime = MAX_SLEEPTIME;
+    appConfig.rateTemperature = RATE_TEMPERATURE;
+    appConfig.rateHumidity = RATE_HUMIDITY;
+    appConfig.ratePressure = RATE_PRESSURE;
+    appConfig.batteryLow = BATTERY_LOW;
+    appConfig.batteryCritical = BATTERY_CRITICAL;
+    appConfig.oversampling = SENSOR_OVERSAMPLING;
+    appConfig.adr = ADAPTIVE_DR;
+    appConfig.datarate = FIXED_DR;
+    appConfig.confirmed = CONFIRMED_UPLINKS;
     uint8_t *d = generateDevEUIByChipID();
 
     for (int i = 0; i < 8; i++)
@@ -141,7 +243,17 @@ void init_app_config()
 
   printf("\nMagic    : %08x\n", appConfig.magic);
   printf("Sleeptime: %dms\n", appConfig.sleeptime);
-  printf("Senddelay: %dms\n\n", appConfig.senddelay);
+  printf("Senddelay: %dms\n", appConfig.senddelay);
+  printf("Aggregation: %d\n", appConfig.aggregation);
+  printf("Batchsize: %d\n", appConfig.batchsize);
+  printf("Deadband : %d/%d/%d\n", appConfig.deadbandTemperature, appConfig.deadbandHumidity, appConfig.deadbandPressure);
+  printf("Silence  : %dms\n", appConfig.maxsilence);
+  printf("Interval : %d-%dms\n", appConfig.minsleeptime, appConfig.maxsleeptime);
+  printf("Rate     : %d/%d/%d\n", appConfig.rateTemperature, appConfig.rateHumidity, appConfig.ratePressure);
+  printf("Battery  : %d/%dmV\n", appConfig.batteryLow, appConfig.batteryCritical);
+  printf("Oversampling: %d\n", appConfig.oversampling);
+  printf("ADR      : %d, DR%d\n", appConfig.adr, appConfig.datarate);
+  printf("Confirmed: %d\n\n", appConfig.confirmed);
   printHex("AppEUI", appConfig.appEui, 8);
   printHex("DevEUI", appConfig.devEui, 8);
   printHex("AppKey", appConfig.appKey, 16);
@@ -150,14 +262,22 @@ void init_app_config()
 
 void showBoardLED(uint8_t r, uint8_t g, uint8_t b)
 {
+  if (!boardLEDOn)
+  {
+    power_acquire(POWER_LED);
+    boardLEDOn = true;
+  }
   pixels.setPixelColor(0, pixels.Color(r, g, b));
   delay(50);
   pixels.show();
 }
 
+// Dark LED and Vext off unless the sensors hold it
 void clearBoardLED()
 {
-  pixels.clear();
-  delay(50);
-  pixels.show();
+  if (boardLEDOn)
+  {
+    power_release(POWER_LED);
+    boardLEDOn = false;
+  }
 }
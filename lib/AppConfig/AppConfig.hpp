@@ -16,6 +16,7 @@
  */
 #include <Arduino.h>
 #include <CubeCell_NeoPixel.h>
+#include <Aggregator.hpp>
 
 // Magic number to identify valid EEPROM data
 #define EEPROM_MAGIC 0x19660304
@@ -24,6 +25,90 @@
 #define DEFAULT_SLEEPTIME 1200000
 #define DEFAULT_SENDDELAY 0
 
+// ms to wait at boot for a serial monitor, 0 starts right away
+#ifndef CONSOLE_DELAY
+#ifdef DEBUG
+#define CONSOLE_DELAY 6000
+#else
+#define CONSOLE_DELAY 0
+#endif
+#endif
+
+// Default aggregation of the SENSOR_READ_ITERATIONS samples per cycle
+#ifndef AGGREGATION_MODE
+#define AGGREGATION_MODE AGGREGATION_MEDIAN
+#endif
+
+// Send the standard deviation behind the last sample as COMPACT_EXT_SPREAD
+#ifndef REPORT_SPREAD
+#define REPORT_SPREAD 1
+#endif
+
+// Samples per uplink, 1 sends every sample in its own frame
+#ifndef BATCH_SIZE
+#define BATCH_SIZE 1
+#endif
+#define MAX_BATCH_SIZE 16
+
+// Report by exception, a deadband of 0 ignores the value. With all
+// deadbands 0 every batch is sent.
+#ifndef DEADBAND_TEMPERATURE
+#define DEADBAND_TEMPERATURE 0 // 0.01 degree C
+#endif
+#ifndef DEADBAND_HUMIDITY
+#define DEADBAND_HUMIDITY 0 // 0.01 %
+#endif
+#ifndef DEADBAND_PRESSURE
+#define DEADBAND_PRESSURE 0 // Pa
+#endif
+// Heartbeat, longest time without uplink in milliseconds
+#ifndef MAX_SILENCE
+#define MAX_SILENCE 21600000
+#endif
+
+// Adaptive sampling interval (Scheduler), bounds in milliseconds
+#ifndef MIN_SLEEPTIME
+#define MIN_SLEEPTIME 300000
+#endif
+#ifndef MAX_SLEEPTIME
+#define MAX_SLEEPTIME 3600000
+#endif
+// Rate of change per hour above which the interval is halved, 0 = off
+#ifndef RATE_TEMPERATURE
+#define RATE_TEMPERATURE 0 // 0.01 degree C per hour
+#endif
+#ifndef RATE_HUMIDITY
+#define RATE_HUMIDITY 0 // 0.01 % per hour
+#endif
+#ifndef RATE_PRESSURE
+#define RATE_PRESSURE 0 // Pa per hour
+#endif
+// Battery thresholds in mV, 0 = off
+#ifndef BATTERY_LOW
+#define BATTERY_LOW 0 // double the interval
+#endif
+#ifndef BATTERY_CRITICAL
+#define BATTERY_CRITICAL 0 // use MAX_SLEEPTIME
+#endif
+
+// BME280 oversampling 1..5 (x1..x16) for temperature, pressure and humidity
+#ifndef SENSOR_OVERSAMPLING
+#define SENSOR_OVERSAMPLING 1
+#endif
+
+// Radio, a fixed data rate is only used with ADR off
+#ifndef ADAPTIVE_DR
+#define ADAPTIVE_DR 1
+#endif
+#ifndef FIXED_DR
+#define FIXED_DR 0 // EU868 DR0..DR5
+#endif
+#define MAX_DR 5
+// Every n-th uplink is confirmed, 0 = none
+#ifndef CONFIRMED_UPLINKS
+#define CONFIRMED_UPLINKS 0
+#endif
+
 // Structure to hold application configuration
 typedef struct 
 {
@@ -32,7 +117,24 @@ typedef struct
   uint8_t devEui[8];   // Device EUI
   uint8_t appKey[16];  // Application Key
   uint32_t sleeptime;  // Sleep time in milliseconds
-  uint32_t senddelay;  // Sleep time in milliseconds
+  uint32_t senddelay;  // Delay before an uplink in milliseconds
+  uint8_t aggregation; // Aggregation mode (AGGREGATION_*)
+  uint8_t batchsize;   // Samples per uplink (1..MAX_BATCH_SIZE)
+  uint16_t deadbandTemperature; // 0.01 degree C, 0 = off
+  uint16_t deadbandHumidity;    // 0.01 %, 0 = off
+  uint16_t deadbandPressure;    // Pa, 0 = off
+  uint32_t maxsilence;          // Heartbeat in milliseconds
+  uint32_t minsleeptime;        // Adaptive interval lower bound in milliseconds
+  uint32_t maxsleeptime;        // Adaptive interval upper bound in milliseconds
+  uint16_t rateTemperature;     // 0.01 degree C per hour, 0 = off
+  uint16_t rateHumidity;        // 0.01 % per hour, 0 = off
+  uint16_t ratePressure;        // Pa per hour, 0 = off
+  uint16_t batteryLow;          // mV, 0 = off
+  uint16_t batteryCritical;     // mV, 0 = off
+  uint8_t oversampling;         // BME280 oversampling 1..5
+  uint8_t adr;                  // 1 = adaptive data rate
+  uint8_t datarate;             // data rate with ADR off
+  uint8_t confirmed;            // every n-th uplink confirmed, 0 = none
 } AppConfig;
 
 // Structure to hold data to be transmitted from BME280 sensor
@@ -59,5 +161,6 @@ extern void init_app_config();
 // Function to write configuration to EEPROM
 extern void write_config();
 
+// The LED holds the POWER_LED domain from showBoardLED() to clearBoardLED()
 extern void showBoardLED(uint8_t r, uint8_t g, uint8_t b);
 extern void clearBoardLED();
@@ -22,73 +22,250 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 #include "BME280.h"
+#include <CRC8.hpp>
 
 bool BME280::init(int i2c_addr)
 {
   uint8_t retry = 0;
   uint8_t chip_id = 0;
 
-  _devAddr = i2c_addr;
-  Wire.begin();
+  bus.begin(i2c_addr);
 
   while ((retry++ < 5) && (chip_id != 0x60))
   {
-    chip_id = BME280Read8(BME280_REG_CHIPID);
+    if (retry > 1)
+    {
+      delay(100);
+    }
+    if (!bus.read8(BME280_REG_CHIPID, &chip_id))
+    {
+      chip_id = 0;
+    }
 #ifdef BMP280_DEBUG_PRINT
     Serial.print("Read chip ID: ");
     Serial.println(chip_id);
 #endif
-    delay(100);
   }
 
   if (chip_id != 0x60)
   {
     Serial.println("Read Chip ID fail!");
+    // the part may have been replaced, read the calibration again
+    calibrationValid = false;
     return false;
   }
 
-  dig_T1 = BME280Read16LE(BME280_REG_DIG_T1);
-  dig_T2 = BME280ReadS16LE(BME280_REG_DIG_T2);
-  dig_T3 = BME280ReadS16LE(BME280_REG_DIG_T3);
+  // on later wake-ups only the control registers are written again
+  if (!readCalibration())
+  {
+    Serial.println("Read calibration fail!");
+    return false;
+  }
+  parseCalibration();
 
-  dig_P1 = BME280Read16LE(BME280_REG_DIG_P1);
-  dig_P2 = BME280ReadS16LE(BME280_REG_DIG_P2);
-  dig_P3 = BME280ReadS16LE(BME280_REG_DIG_P3);
-  dig_P4 = BME280ReadS16LE(BME280_REG_DIG_P4);
-  dig_P5 = BME280ReadS16LE(BME280_REG_DIG_P5);
-  dig_P6 = BME280ReadS16LE(BME280_REG_DIG_P6);
-  dig_P7 = BME280ReadS16LE(BME280_REG_DIG_P7);
-  dig_P8 = BME280ReadS16LE(BME280_REG_DIG_P8);
-  dig_P9 = BME280ReadS16LE(BME280_REG_DIG_P9);
+  // stay in sleep mode, conversions are triggered by readForced()
+  return writeControl(BME280_MODE_SLEEP);
+}
 
-  dig_H1 = BME280Read8(BME280_REG_DIG_H1);
-  dig_H2 = BME280Read16LE(BME280_REG_DIG_H2);
-  dig_H3 = BME280Read8(BME280_REG_DIG_H3);
-  dig_H4 = (BME280Read8(BME280_REG_DIG_H4) << 4) | (0x0F & BME280Read8(BME280_REG_DIG_H4 + 1));
-  dig_H5 = (BME280Read8(BME280_REG_DIG_H5 + 1) << 4) | (0x0F & BME280Read8(BME280_REG_DIG_H5) >> 4);
-  dig_H6 = (int8_t)BME280Read8(BME280_REG_DIG_H6);
+// Forget the cached calibration, the next init() reads it from the chip
+void BME280::clearCalibration(void)
+{
+  calibrationValid = false;
+}
 
-  writeRegister(BME280_REG_CONTROLHUMID, 0x05); //Choose 16X oversampling
-  writeRegister(BME280_REG_CONTROL, 0xB7);      //Choose 16X oversampling
+bool BME280::readCalibration(void)
+{
+  if (calibrationValid && calibrationCrc == crc8(calibration, BME280_CALIBRATION_LENGTH))
+  {
+    return true;
+  }
 
-  delay(250);
+  calibrationValid = false;
+  if (!bus.read(BME280_REG_DIG_T1, calibration, BME280_CALIBRATION_TP_LENGTH) ||
+      !bus.read(BME280_REG_DIG_H2, calibration + BME280_CALIBRATION_TP_LENGTH, BME280_CALIBRATION_H_LENGTH))
+  {
+    return false;
+  }
 
+  calibrationCrc = crc8(calibration, BME280_CALIBRATION_LENGTH);
+  calibrationValid = true;
   return true;
 }
 
+// Datasheet table 16, offsets relative to 0x88 and 0xE1
+void BME280::parseCalibration(void)
+{
+  const uint8_t *c = calibration;
+  const uint8_t *h = calibration + BME280_CALIBRATION_TP_LENGTH;
+
+  dig_T1 = (uint16_t)(c[1] << 8 | c[0]);
+  dig_T2 = (int16_t)(c[3] << 8 | c[2]);
+  dig_T3 = (int16_t)(c[5] << 8 | c[4]);
+
+  dig_P1 = (uint16_t)(c[7] << 8 | c[6]);
+  dig_P2 = (int16_t)(c[9] << 8 | c[8]);
+  dig_P3 = (int16_t)(c[11] << 8 | c[10]);
+  dig_P4 = (int16_t)(c[13] << 8 | c[12]);
+  dig_P5 = (int16_t)(c[15] << 8 | c[14]);
+  dig_P6 = (int16_t)(c[17] << 8 | c[16]);
+  dig_P7 = (int16_t)(c[19] << 8 | c[18]);
+  dig_P8 = (int16_t)(c[21] << 8 | c[20]);
+  dig_P9 = (int16_t)(c[23] << 8 | c[22]);
+
+  dig_H1 = c[25];
+  dig_H2 = (int16_t)(h[1] << 8 | h[0]);
+  dig_H3 = h[2];
+  // 12 bit signed values sharing 0xE5
+  dig_H4 = (int16_t)((int8_t)h[3] * 16) | (h[4] & 0x0F);
+  dig_H5 = (int16_t)((int8_t)h[5] * 16) | (h[4] >> 4);
+  dig_H6 = (int8_t)h[6];
+}
+
+void BME280::setOversampling(uint8_t osrs_t, uint8_t osrs_p, uint8_t osrs_h)
+{
+  this->osrs_t = osrs_t > BME280_OVERSAMPLING_X16 ? BME280_OVERSAMPLING_X16 : osrs_t;
+  this->osrs_p = osrs_p > BME280_OVERSAMPLING_X16 ? BME280_OVERSAMPLING_X16 : osrs_p;
+  this->osrs_h = osrs_h > BME280_OVERSAMPLING_X16 ? BME280_OVERSAMPLING_X16 : osrs_h;
+}
+
+// Maximum measurement time in microseconds, datasheet chapter 9.1:
+// 1.25 + 2.3 * T + (2.3 * P + 0.575) + (2.3 * H + 0.575) ms
+uint32_t BME280::getMeasurementTime(void)
+{
+  uint32_t t = 1250;
+
+  if (osrs_t != BME280_OVERSAMPLING_SKIP)
+  {
+    t += 2300 * (1 << (osrs_t - 1));
+  }
+  if (osrs_p != BME280_OVERSAMPLING_SKIP)
+  {
+    t += 2300 * (1 << (osrs_p - 1)) + 575;
+  }
+  if (osrs_h != BME280_OVERSAMPLING_SKIP)
+  {
+    t += 2300 * (1 << (osrs_h - 1)) + 575;
+  }
+
+  return t;
+}
+
+bool BME280::readForced(BME280Data &data)
+{
+  if (!startForced())
+  {
+    return false;
+  }
+  delay((getMeasurementTime() + 999) / 1000);
+  return readForcedResult(data);
+}
+
+// Trigger one conversion, the result is ready after getMeasurementTime()
+bool BME280::startForced(void)
+{
+  return writeControl(BME280_MODE_FORCED);
+}
+
+bool BME280::readForcedResult(BME280Data &data)
+{
+  // the maximum time has passed, so this normally succeeds at once
+  uint8_t polls = 0;
+  uint8_t status;
+  while (true)
+  {
+    if (!bus.read8(BME280_REG_STATUS, &status))
+    {
+      return false;
+    }
+    if (!(status & BME280_STATUS_MEASURING))
+    {
+      break;
+    }
+    if (++polls > 10)
+    {
+      return false;
+    }
+    delay(1);
+  }
+
+  return readAll(data);
+}
+
 int32_t BME280::getTemperature(void)
 {
-  int32_t var1, var2;
+  BME280Data data;
+  return readAll(data) ? data.temperature : 0;
+}
+
+uint32_t BME280::getPressure(void)
+{
+  BME280Data data;
+  return readAll(data) ? data.pressure : 0;
+}
 
-  int32_t adc_T = BME280Read24(BME280_REG_TEMPDATA);
+uint32_t BME280::getHumidity(void)
+{
+  BME280Data data;
+  return readAll(data) ? data.humidity : 0;
+}
+
+bool BME280::readRaw(BME280RawData &raw)
+{
+  uint8_t buffer[BME280_BURST_LENGTH];
 
-  // Check if the last transport successed
-  if (!isTransport_OK)
+  if (!bus.read(BME280_REG_PRESSUREDATA, buffer, BME280_BURST_LENGTH))
   {
-    return 0;
+    return false;
+  }
+
+  raw.adc_P = ((uint32_t)buffer[0] << 12) | ((uint32_t)buffer[1] << 4) | (buffer[2] >> 4);
+  raw.adc_T = ((uint32_t)buffer[3] << 12) | ((uint32_t)buffer[4] << 4) | (buffer[5] >> 4);
+  raw.adc_H = ((uint32_t)buffer[6] << 8) | buffer[7];
+
+  return true;
+}
+
+bool BME280::readAll(BME280Data &data)
+{
+  BME280RawData raw;
+
+  if (!readRaw(raw))
+  {
+    return false;
   }
 
-  adc_T >>= 4;
+  compensate(raw, data);
+  return true;
+}
+
+void BME280::compensate(const BME280RawData &raw, BME280Data &data, uint8_t mode)
+{
+  int32_t t_fine;
+
+  // all three values are compensated from the same snapshot, so
+  // pressure and humidity always use the matching t_fine
+  data.temperature = compensateTemperature(raw.adc_T, t_fine);
+
+  // humidity in 1/4194304 %, scaled to 0.001 %
+  uint32_t h = compensateHumidity(raw.adc_H, t_fine);
+
+  if (mode == BME280_COMPENSATION_64BIT)
+  {
+    data.pressure = compensatePressure64(raw.adc_P, t_fine);
+    data.humidity = (uint64_t)h * 1000 / 4194304;
+  }
+  else
+  {
+    data.pressure = compensatePressure32(raw.adc_P, t_fine) * 10;
+    // 1000 / 2^22 = 125 / 2^19, the shift by 7 keeps the product in 32 bit
+    data.humidity = ((h >> 7) * 125 + 2048) >> 12;
+  }
+}
+
+int32_t BME280::compensateTemperature(int32_t adc_T, int32_t &t_fine)
+{
+  int32_t var1, var2;
+
   var1 = (((adc_T >> 3) - ((int32_t)(dig_T1 << 1))) * ((int32_t)dig_T2)) >> 11;
   var2 = (((((adc_T >> 4) - ((int32_t)dig_T1)) * ((adc_T >> 4) - ((int32_t)dig_T1))) >> 12)
          * ((int32_t)dig_T3)) >> 14;
@@ -98,16 +275,12 @@ int32_t BME280::getTemperature(void)
   return (t_fine * 50 + 1280) >> 8;
 }
 
-uint32_t BME280::getPressure(void)
+uint32_t BME280::compensatePressure64(int32_t adc_P, int32_t t_fine)
 {
   int64_t var1, var2, var3, var4;
 
-  // getTemperature(); // must be done first to get t_fine
-
-  int32_t adc_P = BME280Read24(BME280_REG_PRESSUREDATA);
-  if (adc_P == 0x800000) // value in case pressure measurement was disabled
-    return NAN;
-  adc_P >>= 4;
+  if (adc_P == 0x80000) // value in case pressure measurement was disabled
+    return 0;
 
   var1 = ((int64_t)t_fine) - 128000;
   var2 = var1 * var1 * (int64_t)dig_P6;
@@ -132,20 +305,43 @@ uint32_t BME280::getPressure(void)
   return ( var4 * 10 ) / 256.0;
 }
 
-uint32_t BME280::getHumidity(void)
+// Datasheet chapter 8.2, pressure in Pa. No 64 bit arithmetic, which
+// the Cortex-M0+ only has as slow library calls.
+uint32_t BME280::compensatePressure32(int32_t adc_P, int32_t t_fine)
 {
-  int32_t v_x1_u32r, adc_H;
-
-  // Call getTemperature to get t_fine
-  // getTemperature();
-  // Check if the last transport successed
+  int32_t var1, var2;
+  uint32_t p;
 
-  if (!isTransport_OK)
-  {
+  if (adc_P == 0x80000) // value in case pressure measurement was disabled
     return 0;
+
+  var1 = (t_fine >> 1) - (int32_t)64000;
+  var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)dig_P6);
+  var2 = var2 + ((var1 * ((int32_t)dig_P5)) * 2);
+  var2 = (var2 >> 2) + (((int32_t)dig_P4) * 65536);
+  var1 = (((dig_P3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) +
+          ((((int32_t)dig_P2) * var1) >> 1)) >> 18;
+  var1 = ((32768 + var1) * ((int32_t)dig_P1)) >> 15;
+
+  if (var1 == 0) {
+    return 0; // avoid exception caused by division by zero
   }
 
-  adc_H = BME280Read16(BME280_REG_HUMIDITYDATA);
+  p = (((uint32_t)(((int32_t)1048576) - adc_P) - (var2 >> 12))) * 3125;
+  if (p < 0x80000000)
+    p = (p << 1) / ((uint32_t)var1);
+  else
+    p = (p / (uint32_t)var1) * 2;
+
+  var1 = (((int32_t)dig_P9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+  var2 = (((int32_t)(p >> 2)) * ((int32_t)dig_P8)) >> 13;
+
+  return (uint32_t)((int32_t)p + ((var1 + var2 + dig_P7) >> 4));
+}
+
+uint32_t BME280::compensateHumidity(int32_t adc_H, int32_t t_fine)
+{
+  int32_t v_x1_u32r;
 
   v_x1_u32r = (t_fine - ((int32_t)76800));
   v_x1_u32r = (((((adc_H << 14) - (((int32_t)dig_H4) << 20) - (((int32_t)dig_H5) * v_x1_u32r)) + ((
@@ -162,114 +358,12 @@ uint32_t BME280::getHumidity(void)
   v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
   v_x1_u32r = (v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r);
 
-  uint64_t v = v_x1_u32r;
-  v *= 1000;
-  v /= 4194304;
-
-  //  return (uint32_t)(v_x1_u32r >> 12) / 1024.0;
-  return v;
-}
-
-uint8_t BME280::BME280Read8(uint8_t reg)
-{
-  Wire.beginTransmission(_devAddr);
-  Wire.write(reg);
-  Wire.endTransmission();
-
-  Wire.requestFrom(_devAddr, 1);
-  // return 0 if slave didn't response
-  if (Wire.available() < 1)
-  {
-    isTransport_OK = false;
-    return 0;
-  }
-  else
-  {
-    isTransport_OK = true;
-  }
-
-  return Wire.read();
-}
-
-uint16_t BME280::BME280Read16(uint8_t reg)
-{
-  uint8_t msb, lsb;
-
-  Wire.beginTransmission(_devAddr);
-  Wire.write(reg);
-  Wire.endTransmission();
-
-  Wire.requestFrom(_devAddr, 2);
-  // return 0 if slave didn't response
-  if (Wire.available() < 2)
-  {
-    isTransport_OK = false;
-    return 0;
-  }
-  else
-  {
-    isTransport_OK = true;
-  }
-  msb = Wire.read();
-  lsb = Wire.read();
-
-  return (uint16_t)msb << 8 | lsb;
-}
-
-uint16_t BME280::BME280Read16LE(uint8_t reg)
-{
-  uint16_t data = BME280Read16(reg);
-  return (data >> 8) | (data << 8);
-}
-
-int16_t BME280::BME280ReadS16(uint8_t reg)
-{
-  return (int16_t)BME280Read16(reg);
-}
-
-int16_t BME280::BME280ReadS16LE(uint8_t reg)
-{
-  return (int16_t)BME280Read16LE(reg);
-}
-
-uint32_t BME280::BME280Read24(uint8_t reg)
-{
-  uint32_t data;
-
-  Wire.beginTransmission(_devAddr);
-  Wire.write(reg);
-  Wire.endTransmission();
-
-  Wire.requestFrom(_devAddr, 3);
-  // return 0 if slave didn't response
-  if (Wire.available() < 3)
-  {
-    isTransport_OK = false;
-    return 0;
-  }
-  else if (isTransport_OK == false)
-  {
-    isTransport_OK = true;
-    if (!init(_devAddr))
-    {
-#ifdef BMP280_DEBUG_PRINT
-      Serial.println("Device not connected or broken!");
-#endif
-    }
-  }
-  data = Wire.read();
-  data <<= 8;
-  data |= Wire.read();
-  data <<= 8;
-  data |= Wire.read();
-
-  return data;
+  return v_x1_u32r;
 }
 
-void BME280::writeRegister(uint8_t reg, uint8_t val)
+bool BME280::writeControl(uint8_t mode)
 {
-  Wire.beginTransmission(_devAddr); // start transmission to device
-  Wire.write(reg);                  // send register address
-  Wire.write(val);                  // send value to write
-  Wire.endTransmission();           // end transmission
+  // ctrl_hum only becomes effective after a write to ctrl_meas
+  return bus.write8(BME280_REG_CONTROLHUMID, osrs_h) &&
+         bus.write8(BME280_REG_CONTROL, (osrs_t << 5) | (osrs_p << 2) | mode);
 }
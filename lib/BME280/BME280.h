@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <I2CTransport.hpp>
 
 #define BME280_ADDRESS   0x76
 
@@ -58,21 +59,88 @@ THE SOFTWARE.
 #define BME280_REG_CAL26           0xE1
 
 #define BME280_REG_CONTROLHUMID    0xF2
+#define BME280_REG_STATUS          0xF3
 #define BME280_REG_CONTROL         0xF4
 #define BME280_REG_CONFIG          0xF5
 #define BME280_REG_PRESSUREDATA    0xF7
 #define BME280_REG_TEMPDATA        0xFA
 #define BME280_REG_HUMIDITYDATA    0xFD
 
+// ctrl_meas mode bits
+#define BME280_MODE_SLEEP          0x00
+#define BME280_MODE_FORCED         0x01
+
+// status register, set while a conversion is running
+#define BME280_STATUS_MEASURING    0x08
+
+// osrs_t, osrs_p and osrs_h register values
+#define BME280_OVERSAMPLING_SKIP   0x00
+#define BME280_OVERSAMPLING_X1     0x01
+#define BME280_OVERSAMPLING_X2     0x02
+#define BME280_OVERSAMPLING_X4     0x03
+#define BME280_OVERSAMPLING_X8     0x04
+#define BME280_OVERSAMPLING_X16    0x05
+
+// 0xF7..0xFE: press_msb .. hum_lsb, read in one burst
+#define BME280_BURST_LENGTH        8
+
+// calibration registers, read in two bursts: 0x88..0xA1 and 0xE1..0xE7
+#define BME280_CALIBRATION_TP_LENGTH 26
+#define BME280_CALIBRATION_H_LENGTH  7
+#define BME280_CALIBRATION_LENGTH    (BME280_CALIBRATION_TP_LENGTH + BME280_CALIBRATION_H_LENGTH)
+
+// Compensation back-ends, BME280_COMPENSATION selects the one readAll() uses
+#define BME280_COMPENSATION_64BIT  0 // Bosch 64 bit pressure, 0.1 Pa resolution (reference)
+#define BME280_COMPENSATION_32BIT  1 // Bosch 32 bit pressure, 1 Pa resolution, fixed point humidity
+
+#ifndef BME280_COMPENSATION
+#define BME280_COMPENSATION BME280_COMPENSATION_32BIT
+#endif
+
+// Raw ADC values of one measurement, all taken from the same burst read
+typedef struct
+{
+  int32_t adc_P;
+  int32_t adc_T;
+  int32_t adc_H;
+} BME280RawData;
+
+// Compensated values of one measurement
+typedef struct
+{
+  int32_t temperature; // Temperature in 0.001 degree C
+  uint32_t humidity;   // Humidity in 0.001 %
+  uint32_t pressure;   // Pressure in 0.1 Pa
+} BME280Data;
+
 class BME280 {
   public:
     bool init(int i2c_addr = BME280_ADDRESS);
     int32_t getTemperature(void);
     uint32_t getPressure(void);
     uint32_t getHumidity(void);
+    bool readRaw(BME280RawData &raw);
+    bool readAll(BME280Data &data);
+    void compensate(const BME280RawData &raw, BME280Data &data, uint8_t mode = BME280_COMPENSATION);
+    void setOversampling(uint8_t osrs_t, uint8_t osrs_p, uint8_t osrs_h);
+    uint32_t getMeasurementTime(void);
+    bool readForced(BME280Data &data);
+    bool startForced(void);
+    bool readForcedResult(BME280Data &data);
+    void clearCalibration(void);
   private:
-    int _devAddr;
-    bool isTransport_OK;
+    I2CTransport bus;
+
+    uint8_t osrs_t = BME280_OVERSAMPLING_X16;
+    uint8_t osrs_p = BME280_OVERSAMPLING_X16;
+    uint8_t osrs_h = BME280_OVERSAMPLING_X16;
+
+    // Calibration registers as read from the chip. They never change for
+    // a part, so they are read once and kept in RAM, which is retained in
+    // deep sleep. The CRC guards the copy, not the I2C transfer.
+    uint8_t calibration[BME280_CALIBRATION_LENGTH];
+    uint8_t calibrationCrc;
+    bool calibrationValid = false;
 
     // Calibration data
     uint16_t dig_T1;
@@ -93,16 +161,15 @@ class BME280 {
     int16_t dig_H4;
     int16_t dig_H5;
     int8_t  dig_H6;
-    int32_t t_fine;
 
     // private functions
-    uint8_t BME280Read8(uint8_t reg);
-    uint16_t BME280Read16(uint8_t reg);
-    uint16_t BME280Read16LE(uint8_t reg);
-    int16_t BME280ReadS16(uint8_t reg);
-    int16_t BME280ReadS16LE(uint8_t reg);
-    uint32_t BME280Read24(uint8_t reg);
-    void writeRegister(uint8_t reg, uint8_t val);
+    bool readCalibration(void);
+    void parseCalibration(void);
+    int32_t compensateTemperature(int32_t adc_T, int32_t &t_fine);
+    uint32_t compensatePressure64(int32_t adc_P, int32_t t_fine);
+    uint32_t compensatePressure32(int32_t adc_P, int32_t t_fine);
+    uint32_t compensateHumidity(int32_t adc_H, int32_t t_fine);
+    bool writeControl(uint8_t mode);
 };
 
 #endif
\ No newline at end of file
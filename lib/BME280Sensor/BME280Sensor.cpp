@@ -0,0 +1,72 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AppConfig.hpp>
+#include "BME280Sensor.hpp"
+
+BME280 bme; // use I2C interface
+
+bool BME280Sensor::begin()
+{
+  if (!bme.init())
+  {
+    Serial.println("Could not find a valid BME280 sensor, check wiring, "
+                   "address, sensor ID!");
+    return false;
+  }
+  bme.setOversampling(appConfig.oversampling, appConfig.oversampling, appConfig.oversampling);
+  return true;
+}
+
+bool BME280Sensor::start()
+{
+  return bme.startForced();
+}
+
+uint32_t BME280Sensor::conversionTime()
+{
+  return (bme.getMeasurementTime() + 999) / 1000;
+}
+
+bool BME280Sensor::read(SensorSample *sample)
+{
+  BME280Data data;
+  if (!bme.readForcedResult(data))
+  {
+    return false;
+  }
+  sample->temperature = data.temperature / 10;
+  sample->humidity = data.humidity / 10;
+  sample->pressure = data.pressure / 10;
+  return true;
+}
+
+// The bus stays with POWER_I2C, the sensor is in sleep mode after a
+// forced conversion
+void BME280Sensor::end()
+{
+}
+
+void BME280Sensor::print(const SensorSample *sample)
+{
+#ifdef DEBUG
+  printf("temperature = %.02f°C [%d]\n", sample->temperature / 100.0, sample->temperature);
+  printf("humidity = %.02f%% [%d]\n", sample->humidity / 100.0, sample->humidity);
+  printf("pressure = %.02fhPa [%d]\n", sample->pressure / 100.0, sample->pressure);
+#else
+  (void)sample;
+#endif
+}
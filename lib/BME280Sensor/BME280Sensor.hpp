@@ -0,0 +1,38 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <BME280.h>
+#include <Payload.hpp>
+
+extern BME280 bme;
+
+// BME280 driver for SensorPipeline, one forced measurement per start
+struct BME280Sensor
+{
+  static const uint8_t fields = COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE;
+
+  // zig-zag varints of the full range: -40..85 degree C, 0..100 %,
+  // 300..1100 hPa, 3 bytes each
+  static const uint8_t sampleBytes = 3 + 3 + 3;
+
+  static bool begin();
+  static bool start();
+  static uint32_t conversionTime();
+  static bool read(SensorSample *sample);
+  static void end();
+  static void print(const SensorSample *sample);
+};
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <EEPROM.h>
+#include "Backlog.hpp"
+
+#define BACKLOG_SIZE (BACKLOG_CAPACITY * BACKLOG_RECORD_SIZE + BACKLOG_BLOCK)
+
+static_assert(BACKLOG_SIZE < 256, "backlog image indexed with uint8_t");
+static_assert(BACKLOG_RECORD_SIZE * 2 == BACKLOG_BLOCK, "two records per block");
+
+// Header block: magic, version, first, count, rebased, crc8, 0xFF padding
+#define HEADER_CRC 5
+
+// The sample as it reads back from the EEPROM
+static SensorSample saturated(const SensorSample *sample)
+{
+  SensorSample s;
+  s.temperature = backlog_value(COMPACT_TEMPERATURE, backlog_word(COMPACT_TEMPERATURE, sample->temperature));
+  s.humidity = backlog_value(COMPACT_HUMIDITY, backlog_word(COMPACT_HUMIDITY, sample->humidity));
+  s.pressure = backlog_value(COMPACT_PRESSURE, backlog_word(COMPACT_PRESSURE, sample->pressure));
+  return s;
+}
+
+static void put16(uint8_t *p, uint16_t value)
+{
+  p[0] = value >> 8;
+  p[1] = value;
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+  return p[0] << 8 | p[1];
+}
+
+static void readImage(uint8_t *image)
+{
+  EEPROM.begin(512);
+  for (uint8_t i = 0; i < BACKLOG_SIZE; i++)
+  {
+    image[i] = EEPROM.read(BACKLOG_OFFSET + i);
+  }
+  EEPROM.end();
+}
+
+// Put the records and the header block into the EEPROM image, free
+// slots keep their content
+static void serialize(const Backlog *backlog, uint8_t *image)
+{
+  for (uint8_t n = 0; n < backlog->count; n++)
+  {
+    uint8_t i = (backlog->first + n) % BACKLOG_CAPACITY;
+    const BacklogRecord *r = &backlog->records[i];
+    uint8_t *p = image + i * BACKLOG_RECORD_SIZE;
+    put16(p, r->stamp);
+    put16(p + 2, backlog_word(COMPACT_TEMPERATURE, r->sample.temperature));
+    put16(p + 4, backlog_word(COMPACT_HUMIDITY, r->sample.humidity));
+    put16(p + 6, backlog_word(COMPACT_PRESSURE, r->sample.pressure));
+  }
+
+  uint8_t *header = image + BACKLOG_HEADER_OFFSET - BACKLOG_OFFSET;
+  memset(header, 0xFF, BACKLOG_BLOCK);
+  header[0] = BACKLOG_MAGIC;
+  header[1] = BACKLOG_STORE_VERSION;
+  header[2] = backlog->first;
+  header[3] = backlog->count;
+  header[4] = backlog->rebased;
+  header[HEADER_CRC] = crc8(image, header + HEADER_CRC - image);
+}
+
+static bool deserialize(Backlog *backlog, const uint8_t *image)
+{
+  const uint8_t *header = image + BACKLOG_HEADER_OFFSET - BACKLOG_OFFSET;
+  if (header[0] != BACKLOG_MAGIC || header[1] != BACKLOG_STORE_VERSION ||
+      header[HEADER_CRC] != crc8(image, header + HEADER_CRC - image) ||
+      header[2] >= BACKLOG_CAPACITY || header[3] > BACKLOG_CAPACITY || header[4] > header[3])
+  {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < BACKLOG_CAPACITY; i++)
+  {
+    BacklogRecord *r = &backlog->records[i];
+    const uint8_t *p = image + i * BACKLOG_RECORD_SIZE;
+    r->stamp = get16(p);
+    r->sample.temperature = backlog_value(COMPACT_TEMPERATURE, get16(p + 2));
+    r->sample.humidity = backlog_value(COMPACT_HUMIDITY, get16(p + 4));
+    r->sample.pressure = backlog_value(COMPACT_PRESSURE, get16(p + 6));
+  }
+  backlog->first = header[2];
+  backlog->count = header[3];
+  backlog->rebased = header[4];
+  return true;
+}
+
+void backlog_open(Backlog *backlog, uint32_t now)
+{
+  uint8_t image[BACKLOG_SIZE];
+  readImage(image);
+
+  memset(backlog, 0, sizeof(Backlog));
+  if (!deserialize(backlog, image))
+  {
+    memset(backlog, 0, sizeof(Backlog));
+    return;
+  }
+
+  if (backlog->count > 0)
+  {
+    // millis() started again, the newest record counts as taken at boot
+    uint8_t newest = (backlog->first + backlog->count - 1) % BACKLOG_CAPACITY;
+    uint16_t shift = (uint16_t)(now >> 16) - backlog->records[newest].stamp;
+    for (uint8_t i = 0; i < backlog->count; i++)
+    {
+      backlog->records[(backlog->first + i) % BACKLOG_CAPACITY].stamp += shift;
+    }
+    backlog->rebased = backlog->count;
+    backlog->dirty = true;
+  }
+#ifdef DEBUG
+  printf("backlog: %d samples\n", backlog->count);
+#endif
+}
+
+void backlog_push(Backlog *backlog, const SensorSample *sample, uint32_t taken)
+{
+  if (backlog->count == BACKLOG_CAPACITY)
+  {
+    backlog_drop(backlog, 1);
+  }
+
+  BacklogRecord *r = &backlog->records[(backlog->first + backlog->count) % BACKLOG_CAPACITY];
+  r->stamp = taken >> 16;
+  r->sample = saturated(sample);
+  backlog->count++;
+  if (backlog->unsaved < backlog->count)
+  {
+    backlog->unsaved++;
+  }
+  backlog->dirty = true;
+}
+
+void backlog_drop(Backlog *backlog, uint8_t count)
+{
+  if (count > backlog->count)
+  {
+    count = backlog->count;
+  }
+  backlog->first = (backlog->first + count) % BACKLOG_CAPACITY;
+  backlog->count -= count;
+  backlog->rebased = backlog->rebased > count ? backlog->rebased - count : 0;
+  if (backlog->unsaved > backlog->count)
+  {
+    backlog->unsaved = backlog->count;
+  }
+  backlog->dirty = true;
+}
+
+bool backlog_save(Backlog *backlog, bool force)
+{
+  if (!backlog->dirty || (!force && backlog->unsaved < BACKLOG_BATCH))
+  {
+    return false;
+  }
+
+  uint8_t stored[BACKLOG_SIZE];
+  uint8_t image[BACKLOG_SIZE];
+  readImage(stored);
+  memcpy(image, stored, BACKLOG_SIZE);
+  serialize(backlog, image);
+
+  bool written = false;
+  EEPROM.begin(512);
+  for (uint8_t block = 0; block < BACKLOG_SIZE; block += BACKLOG_BLOCK)
+  {
+    if (memcmp(stored + block, image + block, BACKLOG_BLOCK) == 0)
+    {
+      continue;
+    }
+    for (uint8_t i = block; i < block + BACKLOG_BLOCK; i++)
+    {
+      EEPROM.write(BACKLOG_OFFSET + i, image[i]);
+    }
+    written = true;
+  }
+  if (written)
+  {
+    EEPROM.commit();
+  }
+  EEPROM.end();
+
+  backlog->dirty = false;
+  backlog->unsaved = 0;
+  return written;
+}
+
+uint8_t backlog_encode(const Backlog *backlog, uint8_t fields, uint32_t now,
+                       uint8_t *buffer, uint8_t size, uint8_t *count)
+{
+  SensorSample samples[BACKLOG_CAPACITY];
+  uint16_t ages[BACKLOG_CAPACITY];
+
+  for (uint8_t i = 0; i < backlog->count; i++)
+  {
+    const BacklogRecord *r = &backlog->records[(backlog->first + i) % BACKLOG_CAPACITY];
+    uint32_t age = (uint16_t)((uint16_t)(now >> 16) - r->stamp) * 65536ULL / 60000;
+    samples[i] = r->sample;
+    ages[i] = age > 0xFFFF ? 0xFFFF : age;
+  }
+
+  // as many of the oldest records as fit, decoders take MAX_BATCH_SIZE
+  uint8_t most = backlog->count < MAX_BATCH_SIZE ? backlog->count : MAX_BATCH_SIZE;
+  for (uint8_t n = most; n > 0; n--)
+  {
+    if (encode_backlog(fields, backlog->rebased > 0, samples, ages, n, NULL, size) > 0)
+    {
+      *count = n;
+      return encode_backlog(fields, backlog->rebased > 0, samples, ages, n, buffer, size);
+    }
+  }
+  *count = 0;
+  return 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <Payload.hpp>
+
+// Store and forward backlog for samples whose uplink failed.
+//
+// A ring of BACKLOG_CAPACITY records behind the session in the EEPROM,
+// the oldest record is overwritten when it is full. 26 records bridge
+// about 8.5 hours at the default interval of 20 minutes. The ring is kept
+// in RAM, which survives deep sleep, and written in 16 byte blocks:
+// records 288 .. 495, two per block, and the header block 496 .. 511.
+// Only blocks that differ from the EEPROM are written, and new records
+// only once BACKLOG_BATCH of them are pending.
+//
+// A record keeps the time it was taken as millis() >> 16 (65.5 s units),
+// which wraps together with millis(). After a reset the time base is lost,
+// the stored records are moved so the newest one was taken at boot and
+// are sent with BACKLOG_REBASED.
+
+#define BACKLOG_OFFSET 288
+#define BACKLOG_RECORD_SIZE 8
+#define BACKLOG_BLOCK 16
+// the rest of the EEPROM after the header block
+#define BACKLOG_CAPACITY ((512 - BACKLOG_OFFSET - BACKLOG_BLOCK) / BACKLOG_RECORD_SIZE)
+#define BACKLOG_HEADER_OFFSET (BACKLOG_OFFSET + BACKLOG_CAPACITY * BACKLOG_RECORD_SIZE)
+#define BACKLOG_MAGIC 0xB1
+#define BACKLOG_STORE_VERSION 2
+
+// Records collected in RAM before they are written
+#ifndef BACKLOG_BATCH
+#define BACKLOG_BATCH 2
+#endif
+
+typedef struct
+{
+  uint16_t stamp; // millis() >> 16 when the sample was taken
+  SensorSample sample;
+} BacklogRecord;
+
+typedef struct
+{
+  BacklogRecord records[BACKLOG_CAPACITY];
+  uint8_t first;   // index of the oldest record
+  uint8_t count;
+  uint8_t rebased; // oldest records taken before the last reset
+  uint8_t unsaved; // records not yet written to the EEPROM
+  bool dirty;      // RAM and EEPROM differ
+} Backlog;
+
+// Load the backlog from the EEPROM, an invalid one is empty
+extern void backlog_open(Backlog *backlog, uint32_t now);
+
+// Append a sample taken at millis() time taken, drops the oldest if full
+extern void backlog_push(Backlog *backlog, const SensorSample *sample, uint32_t taken);
+
+// Remove the count oldest records after they were sent
+extern void backlog_drop(Backlog *backlog, uint8_t count);
+
+// Write the changed blocks once BACKLOG_BATCH records are pending, or any
+// change with force. True if the EEPROM was written.
+extern bool backlog_save(Backlog *backlog, bool force);
+
+// Backlog frame of the oldest records that fit into size, at most
+// MAX_BATCH_SIZE, *count is set to the number of records in it. Returns the frame length, 0 if empty.
+extern uint8_t backlog_encode(const Backlog *backlog, uint8_t fields, uint32_t now,
+                              uint8_t *buffer, uint8_t size, uint8_t *count);
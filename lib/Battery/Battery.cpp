@@ -0,0 +1,135 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Aggregator.hpp>
+#include "Battery.hpp"
+
+#define DAY 86400UL
+
+// LiPo open circuit voltage in mV at 100 %, 95 %, .. 0 %
+static const uint16_t curve[] = {
+    4200, 4150, 4110, 4080, 4020, 3980, 3950, 3910, 3870, 3850, 3840,
+    3820, 3800, 3790, 3770, 3750, 3730, 3710, 3690, 3610, 3300};
+
+#define CURVE_POINTS (sizeof(curve) / sizeof(curve[0]))
+#define CURVE_STEP (10000 / (CURVE_POINTS - 1)) // 0.01 %
+
+uint16_t battery_level(uint16_t voltage)
+{
+  if (voltage >= curve[0])
+  {
+    return 10000;
+  }
+  for (uint8_t i = 1; i < CURVE_POINTS; i++)
+  {
+    if (voltage >= curve[i])
+    {
+      // linear between two points of the curve
+      uint32_t above = voltage - curve[i];
+      uint32_t span = curve[i - 1] - curve[i];
+      return (CURVE_POINTS - 1 - i) * CURVE_STEP + (above * CURVE_STEP + span / 2) / span;
+    }
+  }
+  return 0;
+}
+
+uint16_t battery_measure()
+{
+  Aggregator<int32_t, BATTERY_SAMPLES> samples;
+  for (uint8_t i = 0; i < BATTERY_SAMPLES; i++)
+  {
+    samples.add(getBatteryVoltage());
+  }
+  return samples.trimmedMean();
+}
+
+// Discharge rate from the charge used since the reference
+static void updateRate(BatteryState *state)
+{
+  if (state->level > state->reference + BATTERY_RATE_STEP)
+  {
+    // charged
+    state->reference = state->level;
+    state->elapsed = 0;
+    return;
+  }
+  if (state->reference < state->level + BATTERY_RATE_STEP || state->elapsed == 0)
+  {
+    return;
+  }
+
+  uint64_t rate = (uint64_t)(state->reference - state->level) * DAY * 100 / state->elapsed;
+  if (rate > 0xFFFFFFFFULL)
+  {
+    rate = 0xFFFFFFFFULL;
+  }
+  if (rate == 0)
+  {
+    rate = 1;
+  }
+  state->rate = state->rate ? (state->rate * 3ULL + rate) / 4 : rate;
+  state->reference = state->level;
+  state->elapsed = 0;
+#ifdef DEBUG
+  printf("battery: %lu.%04lu %% per day\n", (unsigned long)(state->rate / 10000), (unsigned long)(state->rate % 10000));
+#endif
+}
+
+void battery_update(BatteryState *state, uint16_t voltage, uint32_t now)
+{
+  int32_t sample = (int32_t)voltage * 16;
+  int32_t smoothed = state->smoothed;
+
+  if (state->smoothed == 0 || abs(sample - smoothed) > BATTERY_JUMP * 16)
+  {
+    state->smoothed = sample;
+    state->level = battery_level(voltage);
+    state->reference = state->level;
+    state->elapsed = 0;
+    state->carry = 0;
+    state->last = now;
+    return;
+  }
+
+  state->smoothed = smoothed + ((sample - smoothed) >> BATTERY_SMOOTHING);
+  state->level = battery_level(battery_voltage(state));
+
+  uint32_t ms = now - state->last + state->carry;
+  state->elapsed += ms / 1000;
+  state->carry = ms % 1000;
+  state->last = now;
+
+  updateRate(state);
+}
+
+uint16_t battery_voltage(const BatteryState *state)
+{
+  return (state->smoothed + 8) / 16;
+}
+
+uint8_t battery_percent(const BatteryState *state)
+{
+  return (state->level + 50) / 100;
+}
+
+uint16_t battery_days(const BatteryState *state)
+{
+  if (state->rate == 0)
+  {
+    return BATTERY_DAYS_UNKNOWN;
+  }
+  uint32_t days = state->level * 100UL / state->rate;
+  return days < BATTERY_DAYS_UNKNOWN ? days : BATTERY_DAYS_UNKNOWN - 1;
+}
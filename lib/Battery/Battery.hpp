@@ -0,0 +1,77 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+// Battery fuel gauge
+//
+// The voltage is measured once per cycle at the same point, sensors off
+// and radio idle, so the load is always the same. BATTERY_SAMPLES ADC
+// conversions are averaged without the lowest and highest quarter, the
+// result is smoothed with an exponential moving average in RAM. A jump of
+// more than BATTERY_JUMP restarts the average, e.g. after a battery swap.
+//
+// The state of charge comes from a LiPo discharge curve. The remaining
+// days are extrapolated from the time the last BATTERY_RATE_STEP of
+// charge took.
+
+// ADC conversions per measurement
+#ifndef BATTERY_SAMPLES
+#define BATTERY_SAMPLES 8
+#endif
+// moving average weight of a new measurement, 1 / 2^n
+#ifndef BATTERY_SMOOTHING
+#define BATTERY_SMOOTHING 2
+#endif
+// mV, a larger change restarts the moving average
+#ifndef BATTERY_JUMP
+#define BATTERY_JUMP 200
+#endif
+// 0.01 %, charge used before the discharge rate is measured again
+#ifndef BATTERY_RATE_STEP
+#define BATTERY_RATE_STEP 200
+#endif
+
+#define BATTERY_DAYS_UNKNOWN 0xFFFF
+
+typedef struct
+{
+  uint32_t smoothed;  // mV * 16, 0 before the first measurement
+  uint16_t level;     // 0.01 % state of charge
+  uint16_t reference; // level at the start of the rate measurement
+  uint32_t elapsed;   // s since reference
+  uint16_t carry;     // ms not yet counted in elapsed
+  uint32_t last;      // millis() of the last update
+  uint32_t rate;      // 0.0001 % per day, 0 = unknown
+} BatteryState;
+
+// Average of BATTERY_SAMPLES conversions in mV
+extern uint16_t battery_measure();
+
+// Feed a measurement taken at millis() now
+extern void battery_update(BatteryState *state, uint16_t voltage, uint32_t now);
+
+// Smoothed voltage in mV, 0 before the first measurement
+extern uint16_t battery_voltage(const BatteryState *state);
+
+// State of charge in %
+extern uint8_t battery_percent(const BatteryState *state);
+
+// Estimated days until empty, BATTERY_DAYS_UNKNOWN before a rate was measured
+extern uint16_t battery_days(const BatteryState *state);
+
+// State of charge of a LiPo cell at rest in 0.01 %
+extern uint16_t battery_level(uint16_t voltage);
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CRC8.hpp"
+
+uint8_t crc8_bitwise(const uint8_t *data, int length)
+{
+  uint8_t crc = 0x00;
+  while (length--)
+  {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      if (crc & 0x80)
+      {
+        crc = (uint8_t)((crc << 1) ^ CRC8_POLYNOMIAL);
+      }
+      else
+      {
+        crc <<= 1;
+      }
+    }
+  }
+  return crc;
+}
+
+uint8_t crc8_nibble(const uint8_t *data, int length)
+{
+  const uint8_t *table = crc8_detail::Tables::nibble;
+  uint8_t crc = 0x00;
+  while (length--)
+  {
+    crc ^= *data++;
+    crc = (uint8_t)(crc << 4) ^ table[crc >> 4];
+    crc = (uint8_t)(crc << 4) ^ table[crc >> 4];
+  }
+  return crc;
+}
+
+uint8_t crc8_table(const uint8_t *data, int length)
+{
+  const uint8_t *table = crc8_detail::Tables::byte;
+  uint8_t crc = 0x00;
+  while (length--)
+  {
+    crc = table[crc ^ *data++];
+  }
+  return crc;
+}
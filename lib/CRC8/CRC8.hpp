@@ -0,0 +1,84 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+// CRC8 with polynomial 0x07 and init 0x00 (CRC-8/SMBUS), used for the
+// frame checksums. Three implementations with the same result:
+//
+//   crc8_bitwise  no table, 8 shifts per byte
+//   crc8_nibble   16 byte table, 2 lookups per byte
+//   crc8_table    256 byte table, 1 lookup per byte
+//
+// crc8() uses the 256 byte table, build with -DCRC8_NIBBLE_TABLE to
+// save flash. The tables are generated by the compiler.
+
+#define CRC8_POLYNOMIAL 0x07
+
+namespace crc8_detail
+{
+  // crc shifted by the given number of bits through the polynomial
+  constexpr uint8_t shift(uint8_t crc, int bits)
+  {
+    return bits == 0 ? crc : shift((crc & 0x80) ? (uint8_t)((crc << 1) ^ CRC8_POLYNOMIAL) : (uint8_t)(crc << 1), bits - 1);
+  }
+
+  template <int... I>
+  struct Table
+  {
+    static const uint8_t byte[sizeof...(I)];
+    static const uint8_t nibble[16];
+  };
+
+  template <int... I>
+  const uint8_t Table<I...>::byte[sizeof...(I)] = {shift(I, 8)...};
+
+  template <int... I>
+  const uint8_t Table<I...>::nibble[16] = {
+      shift(0x00, 4), shift(0x10, 4), shift(0x20, 4), shift(0x30, 4),
+      shift(0x40, 4), shift(0x50, 4), shift(0x60, 4), shift(0x70, 4),
+      shift(0x80, 4), shift(0x90, 4), shift(0xA0, 4), shift(0xB0, 4),
+      shift(0xC0, 4), shift(0xD0, 4), shift(0xE0, 4), shift(0xF0, 4)};
+
+  // Build<256>::type is Table<0, 1, ..., 255>
+  template <int N, int... I>
+  struct Build : Build<N - 1, N - 1, I...>
+  {
+  };
+
+  template <int... I>
+  struct Build<0, I...>
+  {
+    typedef Table<I...> type;
+  };
+
+  typedef Build<256>::type Tables;
+
+  static_assert(shift(0x01, 8) == 0x07, "CRC8 table generation");
+}
+
+extern uint8_t crc8_bitwise(const uint8_t *data, int length);
+extern uint8_t crc8_nibble(const uint8_t *data, int length);
+extern uint8_t crc8_table(const uint8_t *data, int length);
+
+inline uint8_t crc8(const uint8_t *data, int length)
+{
+#ifdef CRC8_NIBBLE_TABLE
+  return crc8_nibble(data, length);
+#else
+  return crc8_table(data, length);
+#endif
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Command.hpp"
+
+typedef struct
+{
+  uint8_t tag;
+  uint8_t length; // value bytes
+  bool (*apply)(AppConfig *config, const uint8_t *value);
+} Command;
+
+static uint16_t u16(const uint8_t *value)
+{
+  return (value[0] << 8) + value[1];
+}
+
+static uint32_t u32(const uint8_t *value)
+{
+  return ((uint32_t)value[0] << 24) + ((uint32_t)value[1] << 16) + (value[2] << 8) + value[3];
+}
+
+static bool setSleeptime(AppConfig *config, const uint8_t *value)
+{
+  uint32_t sleeptime = u32(value);
+  if (sleeptime > 86400000) // one day
+  {
+    return false;
+  }
+  config->sleeptime = sleeptime;
+  return true;
+}
+
+static bool setAggregation(AppConfig *config, const uint8_t *value)
+{
+  if (value[0] >= AGGREGATION_MODES)
+  {
+    return false;
+  }
+  config->aggregation = value[0];
+  return true;
+}
+
+static bool setBatchsize(AppConfig *config, const uint8_t *value)
+{
+  if (value[0] < 1 || value[0] > MAX_BATCH_SIZE)
+  {
+    return false;
+  }
+  config->batchsize = value[0];
+  return true;
+}
+
+static bool setDeadband(AppConfig *config, const uint8_t *value)
+{
+  uint16_t temperature = u16(value);
+  uint16_t humidity = u16(value + 2);
+  uint16_t pressure = u16(value + 4);
+  if (temperature == 0xFFFF || humidity == 0xFFFF || pressure == 0xFFFF)
+  {
+    return false;
+  }
+  config->deadbandTemperature = temperature;
+  config->deadbandHumidity = humidity;
+  config->deadbandPressure = pressure;
+  return true;
+}
+
+static bool setMaxsilence(AppConfig *config, const uint8_t *value)
+{
+  uint32_t maxsilence = u32(value);
+  if (maxsilence == 0 || maxsilence > 604800000) // one week
+  {
+    return false;
+  }
+  config->maxsilence = maxsilence;
+  return true;
+}
+
+static bool setInterval(AppConfig *config, const uint8_t *value)
+{
+  uint32_t min = u32(value);
+  uint32_t max = u32(value + 4);
+  if (min < 1000 || max > 86400000) // one day
+  {
+    return false;
+  }
+  config->minsleeptime = min;
+  config->maxsleeptime = max;
+  return true;
+}
+
+static bool setRate(AppConfig *config, const uint8_t *value)
+{
+  uint16_t temperature = u16(value);
+  uint16_t humidity = u16(value + 2);
+  uint16_t pressure = u16(value + 4);
+  if (temperature == 0xFFFF || humidity == 0xFFFF || pressure == 0xFFFF)
+  {
+    return false;
+  }
+  config->rateTemperature = temperature;
+  config->rateHumidity = humidity;
+  config->ratePressure = pressure;
+  return true;
+}
+
+static bool setBattery(AppConfig *config, const uint8_t *value)
+{
+  uint16_t low = u16(value);
+  uint16_t critical = u16(value + 2);
+  if (low == 0xFFFF || critical == 0xFFFF)
+  {
+    return false;
+  }
+  config->batteryLow = low;
+  config->batteryCritical = critical;
+  return true;
+}
+
+static bool setSenddelay(AppConfig *config, const uint8_t *value)
+{
+  uint32_t senddelay = u32(value);
+  if (senddelay > 60000) // one minute
+  {
+    return false;
+  }
+  config->senddelay = senddelay;
+  return true;
+}
+
+static bool setOversampling(AppConfig *config, const uint8_t *value)
+{
+  if (value[0] < 1 || value[0] > 5)
+  {
+    return false;
+  }
+  config->oversampling = value[0];
+  return true;
+}
+
+static bool setDatarate(AppConfig *config, const uint8_t *value)
+{
+  if (value[0] == 0xFF)
+  {
+    config->adr = 1;
+    return true;
+  }
+  if (value[0] > MAX_DR)
+  {
+    return false;
+  }
+  config->adr = 0;
+  config->datarate = value[0];
+  return true;
+}
+
+static bool setConfirmed(AppConfig *config, const uint8_t *value)
+{
+  if (value[0] == 0xFF)
+  {
+    return false;
+  }
+  config->confirmed = value[0];
+  return true;
+}
+
+static const Command commands[] = {
+    {COMMAND_SLEEPTIME, 4, setSleeptime},
+    {COMMAND_AGGREGATION, 1, setAggregation},
+    {COMMAND_BATCHSIZE, 1, setBatchsize},
+    {COMMAND_DEADBAND, 6, setDeadband},
+    {COMMAND_MAXSILENCE, 4, setMaxsilence},
+    {COMMAND_INTERVAL, 8, setInterval},
+    {COMMAND_RATE, 6, setRate},
+    {COMMAND_BATTERY, 4, setBattery},
+    {COMMAND_SENDDELAY, 4, setSenddelay},
+    {COMMAND_OVERSAMPLING, 1, setOversampling},
+    {COMMAND_DATARATE, 1, setDatarate},
+    {COMMAND_CONFIRMED, 1, setConfirmed},
+};
+
+static const Command *findCommand(uint8_t tag)
+{
+  for (uint8_t i = 0; i < sizeof(commands) / sizeof(Command); i++)
+  {
+    if (commands[i].tag == tag)
+    {
+      return &commands[i];
+    }
+  }
+  return NULL;
+}
+
+// Apply one command to config, COMMAND_OK or the reason it was rejected
+static uint8_t apply(AppConfig *config, uint8_t tag, const uint8_t *value, uint8_t length)
+{
+  const Command *command = findCommand(tag);
+  if (command == NULL || command->length != length)
+  {
+    return COMMAND_UNKNOWN;
+  }
+  return command->apply(config, value) ? COMMAND_OK : COMMAND_INVALID;
+}
+
+// Check the fields that only make sense together, 0 if config is
+// consistent or the tag of the command that sets them
+static uint8_t inconsistent(const AppConfig *config)
+{
+  if (config->minsleeptime > config->maxsleeptime)
+  {
+    return COMMAND_INTERVAL;
+  }
+  // 0 disables a threshold, the low battery interval starts above critical
+  if (config->batteryLow && config->batteryCritical && config->batteryLow < config->batteryCritical)
+  {
+    return COMMAND_BATTERY;
+  }
+  return 0;
+}
+
+// Store config if it differs from appConfig
+static bool commit(const AppConfig *config)
+{
+  if (memcmp(config, &appConfig, sizeof(AppConfig)) == 0)
+  {
+    return false;
+  }
+  appConfig = *config;
+  write_config();
+  return true;
+}
+
+CommandAck handle_command_downlink(const uint8_t *msg, uint8_t size)
+{
+  CommandAck ack = {COMMAND_OK, 0, 0};
+  AppConfig config = appConfig;
+  uint8_t pos = 0;
+
+  while (pos < size)
+  {
+    if (size - pos < 2 || size - pos - 2 < msg[pos + 1])
+    {
+      ack.status = COMMAND_MALFORMED;
+      ack.tag = msg[pos];
+      return ack;
+    }
+
+    uint8_t tag = msg[pos];
+    uint8_t length = msg[pos + 1];
+    ack.count++;
+#ifdef DEBUG
+    printf("command %02X, %d bytes\n", tag, length);
+#endif
+
+    uint8_t status = apply(&config, tag, msg + pos + 2, length);
+    if (status != COMMAND_OK)
+    {
+      ack.status = status;
+      ack.tag = tag;
+      return ack;
+    }
+    pos += 2 + length;
+  }
+
+  uint8_t tag = inconsistent(&config);
+  if (tag)
+  {
+    ack.status = COMMAND_INVALID;
+    ack.tag = tag;
+    return ack;
+  }
+  commit(&config);
+  return ack;
+}
+
+bool handle_config_downlink(const uint8_t *msg, uint8_t size)
+{
+  if (size < 2 || msg[0] != 0xa5)
+  {
+    return false;
+  }
+
+  // the A5 codes are the TLV tags of the first commands
+  AppConfig config = appConfig;
+  if (msg[1] > COMMAND_BATTERY || apply(&config, msg[1], msg + 2, size - 2) != COMMAND_OK ||
+      inconsistent(&config))
+  {
+    return false;
+  }
+  return commit(&config);
+}
@@ -0,0 +1,65 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <AppConfig.hpp>
+
+// Configuration downlinks
+//
+// FPort FPORT_COMMAND carries a stream of (tag, length, value) commands,
+// values big endian. All commands of a downlink are validated first and
+// applied together with a single config write, one invalid command
+// rejects the whole downlink. So does a result whose fields contradict
+// each other (min interval above max, low battery below critical). The result is acked in the next compact
+// uplink (COMPACT_EXT_ACK).
+//
+// The older single command downlinks A5 <legacy> <value> on any other
+// port use the same handlers.
+
+#define FPORT_COMMAND 10
+
+//                              tag   legacy  value
+#define COMMAND_SLEEPTIME 0x01    // A5 01  uint32 ms, at most one day
+#define COMMAND_AGGREGATION 0x02  // A5 02  uint8 AGGREGATION_*
+#define COMMAND_BATCHSIZE 0x03    // A5 03  uint8 1..MAX_BATCH_SIZE
+#define COMMAND_DEADBAND 0x04     // A5 04  uint16 temperature, humidity, pressure
+#define COMMAND_MAXSILENCE 0x05   // A5 05  uint32 ms, at most one week
+#define COMMAND_INTERVAL 0x06     // A5 06  uint32 min, uint32 max ms
+#define COMMAND_RATE 0x07         // A5 07  uint16 temperature, humidity, pressure per hour
+#define COMMAND_BATTERY 0x08      // A5 08  uint16 low, uint16 critical mV
+#define COMMAND_SENDDELAY 0x09    //        uint32 ms, at most one minute
+#define COMMAND_OVERSAMPLING 0x0A //        uint8 1..5 (x1..x16)
+#define COMMAND_DATARATE 0x0B     //        uint8 0..MAX_DR fixed, 0xFF ADR
+#define COMMAND_CONFIRMED 0x0C    //        uint8 every n-th uplink confirmed, 0 none
+
+// Ack status
+#define COMMAND_OK 0
+#define COMMAND_MALFORMED 1 // TLV stream does not add up
+#define COMMAND_UNKNOWN 2   // unknown tag or wrong value length
+#define COMMAND_INVALID 3   // value out of range or inconsistent config
+
+typedef struct
+{
+  uint8_t status; // COMMAND_*
+  uint8_t tag;    // rejected command, 0 if all were applied
+  uint8_t count;  // commands in the downlink
+} CommandAck;
+
+// Apply a TLV command downlink
+extern CommandAck handle_command_downlink(const uint8_t *msg, uint8_t size);
+
+// Apply an A5 downlink, true if the config changed
+extern bool handle_config_downlink(const uint8_t *msg, uint8_t size);
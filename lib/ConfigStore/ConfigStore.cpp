@@ -0,0 +1,151 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <EEPROM.h>
+#include <CRC8.hpp>
+#include "ConfigStore.hpp"
+
+static int slotAddress(uint8_t slot)
+{
+  return CONFIG_STORE_OFFSET + slot * CONFIG_SLOT_SIZE;
+}
+
+static uint8_t recordCrc(uint8_t *record)
+{
+  ConfigRecordHeader *header = (ConfigRecordHeader *)record;
+  uint8_t stored = header->crc8;
+  header->crc8 = 0;
+  uint8_t crc = crc8(record, sizeof(ConfigRecordHeader) + header->length);
+  header->crc8 = stored;
+  return crc;
+}
+
+// Read a slot into record, true if it holds a valid record
+static bool readSlot(uint8_t slot, uint8_t *record)
+{
+  int address = slotAddress(slot);
+  for (int i = 0; i < CONFIG_SLOT_SIZE; i++)
+  {
+    record[i] = EEPROM.read(address + i);
+  }
+
+  ConfigRecordHeader *header = (ConfigRecordHeader *)record;
+  return header->magic == CONFIG_RECORD_MAGIC &&
+         header->length <= CONFIG_RECORD_MAX_DATA &&
+         header->crc8 == recordCrc(record);
+}
+
+// Index of the newest valid slot, -1 if there is none
+static int8_t findNewest(uint8_t *record)
+{
+  int8_t newest = -1;
+  uint32_t sequence = 0;
+  uint8_t buffer[CONFIG_SLOT_SIZE];
+
+  for (uint8_t slot = 0; slot < CONFIG_SLOTS; slot++)
+  {
+    if (!readSlot(slot, buffer))
+    {
+      continue;
+    }
+    uint32_t s = ((ConfigRecordHeader *)buffer)->sequence;
+    if (newest < 0 || (int32_t)(s - sequence) > 0)
+    {
+      newest = slot;
+      sequence = s;
+      memcpy(record, buffer, CONFIG_SLOT_SIZE);
+    }
+  }
+  return newest;
+}
+
+uint8_t config_store_read(void *data, uint8_t size)
+{
+  uint8_t record[CONFIG_SLOT_SIZE];
+
+  EEPROM.begin(512);
+  int8_t newest = findNewest(record);
+  EEPROM.end();
+
+  memset(data, 0xFF, size);
+  if (newest < 0)
+  {
+    return 0;
+  }
+
+  uint8_t length = ((ConfigRecordHeader *)record)->length;
+  memcpy(data, record + sizeof(ConfigRecordHeader), length < size ? length : size);
+#ifdef DEBUG
+  printf("config record %d, sequence %u\n", newest, ((ConfigRecordHeader *)record)->sequence);
+#endif
+  return length;
+}
+
+bool config_store_write(const void *data, uint8_t size)
+{
+  if (size > CONFIG_RECORD_MAX_DATA)
+  {
+    return false;
+  }
+
+  uint8_t record[CONFIG_SLOT_SIZE];
+  ConfigRecordHeader *header = (ConfigRecordHeader *)record;
+
+  EEPROM.begin(512);
+  int8_t newest = findNewest(record);
+
+  if (newest >= 0 && header->length == size &&
+      memcmp(record + sizeof(ConfigRecordHeader), data, size) == 0)
+  {
+    EEPROM.end();
+    return true; // unchanged
+  }
+
+  uint8_t slot = newest < 0 ? 1 : (newest + 1) % CONFIG_SLOTS;
+  uint32_t sequence = newest < 0 ? 1 : header->sequence + 1;
+
+  memset(record, 0xFF, sizeof(record));
+  header->magic = CONFIG_RECORD_MAGIC;
+  header->length = size;
+  header->crc8 = 0;
+  header->sequence = sequence;
+  memcpy(record + sizeof(ConfigRecordHeader), data, size);
+  header->crc8 = recordCrc(record);
+
+  int address = slotAddress(slot);
+  int changed = 0;
+  uint8_t length = sizeof(ConfigRecordHeader) + size;
+  for (uint8_t i = 0; i < length; i++)
+  {
+    if (EEPROM.read(address + i) != record[i])
+    {
+      EEPROM.write(address + i, record[i]);
+      changed++;
+    }
+  }
+
+  bool success = true;
+  if (changed > 0)
+  {
+    success = EEPROM.commit();
+  }
+  EEPROM.end();
+
+#ifdef DEBUG
+  printf("config record %d, sequence %u, %d bytes written\n", slot, sequence, changed);
+#endif
+  return success;
+}
@@ -0,0 +1,56 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+// Log structured record store for the configuration.
+//
+// EEPROM layout (512 bytes)
+//   0 .. 191  config store, CONFIG_SLOTS slots of CONFIG_SLOT_SIZE bytes
+// 192 .. 287  LoRaWAN session (Session.hpp)
+// 288 .. 511  store and forward backlog (Backlog.hpp)
+//
+// Every write appends a sequence numbered, CRC8 protected record to the
+// slot after the newest one, round robin. The newest valid record wins,
+// a torn write therefore falls back to the previous configuration. Only
+// bytes that differ from the EEPROM content are written and an unchanged
+// configuration is not written at all.
+
+#define CONFIG_STORE_OFFSET 0
+#define CONFIG_BLOCK 16
+#define CONFIG_SLOT_SIZE 96 // header and AppConfig, rounded up to CONFIG_BLOCK
+#define CONFIG_SLOTS 2
+#define CONFIG_RECORD_MAGIC 0xC5A7
+
+typedef struct
+{
+  uint16_t magic;    // CONFIG_RECORD_MAGIC
+  uint8_t length;    // data bytes following the header
+  uint8_t crc8;      // crc8 of header (crc8 = 0) and data
+  uint32_t sequence; // incremented with every record
+} ConfigRecordHeader;
+
+#define CONFIG_RECORD_MAX_DATA (CONFIG_SLOT_SIZE - sizeof(ConfigRecordHeader))
+
+// Copy the newest valid record into data. Bytes beyond the stored length
+// are set to 0xFF like erased EEPROM. Returns the stored length, 0 if
+// there is no valid record.
+extern uint8_t config_store_read(void *data, uint8_t size);
+
+// Append data as a new record, true if it is stored. Without any valid
+// record slot 1 is used first, slot 0 may still hold a configuration of
+// firmware before the config store.
+extern bool config_store_write(const void *data, uint8_t size);
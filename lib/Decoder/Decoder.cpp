@@ -0,0 +1,295 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include "Decoder.hpp"
+
+// FPort 1 frame with and without the BME280 values
+#define FRAME_LENGTH 10
+#define FRAME_LENGTH_BATTERY 4
+
+static DecodeResult decodeFrame(const uint8_t *buffer, uint8_t length, Uplink *uplink)
+{
+  if (length != FRAME_LENGTH && length != FRAME_LENGTH_BATTERY)
+  {
+    return DECODE_LENGTH;
+  }
+  if (crc8(buffer, length - 1) != buffer[length - 1])
+  {
+    return DECODE_CRC;
+  }
+
+  uplink->status = buffer[1];
+  uplink->fields = COMPACT_BATTERY;
+  uplink->batch.count = 1;
+
+  uint8_t index = 2;
+  if (length == FRAME_LENGTH)
+  {
+    // little endian, see TxFrameData
+    SensorSample *s = &uplink->batch.samples[0];
+    s->temperature = (int16_t)(buffer[2] | buffer[3] << 8);
+    s->humidity = (uint16_t)(buffer[4] | buffer[5] << 8);
+    s->pressure = (uint16_t)(buffer[6] | buffer[7] << 8) + 80000;
+    uplink->fields |= COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE;
+    index = 8;
+  }
+  uplink->voltage = buffer[index] * 10 + 2000;
+  return DECODE_OK;
+}
+
+// COMPACT_EXT_SPREAD, ignored if the length does not match the flags
+static void decodeSpread(const uint8_t *value, uint8_t length, Uplink *uplink)
+{
+  if (length == 0)
+  {
+    return;
+  }
+  const uint8_t flags[] = {COMPACT_TEMPERATURE, COMPACT_HUMIDITY, COMPACT_PRESSURE};
+  int32_t deviations[3] = {};
+  uint8_t pos = 1;
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    if (value[0] & flags[i])
+    {
+      if (pos + 2 > length)
+      {
+        return;
+      }
+      deviations[i] = value[pos] << 8 | value[pos + 1];
+      pos += 2;
+    }
+  }
+  if (pos != length)
+  {
+    return;
+  }
+  uplink->spread = true;
+  uplink->deviation.temperature = deviations[0];
+  uplink->deviation.humidity = deviations[1];
+  uplink->deviation.pressure = deviations[2];
+}
+
+static DecodeResult decodeCompact(const uint8_t *buffer, uint8_t length, Uplink *uplink)
+{
+  if (length < 3)
+  {
+    return DECODE_LENGTH;
+  }
+  if (crc8(buffer, length - 1) != buffer[length - 1])
+  {
+    return DECODE_CRC;
+  }
+
+  CompactHeader header;
+  if (!decode_compact(buffer, length, &header, &uplink->batch))
+  {
+    return DECODE_FORMAT;
+  }
+  uplink->status = header.status;
+  uplink->fields = header.fields;
+  uplink->interval = header.interval;
+  uplink->voltage = header.voltage;
+
+  // battery gauge and spread, the other extensions are device state
+  for (uint8_t i = 0; i + 2 <= header.extensionLength; i += 2 + header.extension[i + 1])
+  {
+    const uint8_t *value = header.extension + i + 2;
+    if (header.extension[i] == COMPACT_EXT_BATTERY && header.extension[i + 1] == 3 &&
+        i + 5 <= header.extensionLength)
+    {
+      uplink->gauge = true;
+      uplink->percent = value[0];
+      uplink->days = value[1] << 8 | value[2];
+    }
+    if (header.extension[i] == COMPACT_EXT_SPREAD)
+    {
+      decodeSpread(value, header.extension[i + 1], uplink);
+    }
+  }
+  return DECODE_OK;
+}
+
+static DecodeResult decodeBacklog(const uint8_t *buffer, uint8_t length, Uplink *uplink)
+{
+  if (length < 3)
+  {
+    return DECODE_LENGTH;
+  }
+  if (crc8(buffer, length - 1) != buffer[length - 1])
+  {
+    return DECODE_CRC;
+  }
+  if (!decode_backlog(buffer, length, &uplink->fields, &uplink->rebased, &uplink->batch, uplink->ages))
+  {
+    return DECODE_FORMAT;
+  }
+  return DECODE_OK;
+}
+
+DecodeResult decode_uplink(uint8_t port, const uint8_t *buffer, uint8_t length, Uplink *uplink)
+{
+  memset(uplink, 0, sizeof(Uplink));
+  uplink->port = port;
+
+  switch (port)
+  {
+  case FPORT_FRAME:
+    return decodeFrame(buffer, length, uplink);
+  case FPORT_COMPACT:
+    return decodeCompact(buffer, length, uplink);
+  case FPORT_BACKLOG:
+    return decodeBacklog(buffer, length, uplink);
+  default:
+    return DECODE_PORT;
+  }
+}
+
+uint8_t battery_percentage(uint16_t voltage)
+{
+  if (voltage > 4100)
+  {
+    voltage = 4100;
+  }
+  if (voltage <= 2500)
+  {
+    return 0;
+  }
+  // rounded (v - 2.5) / (4.1 - 2.5) * 100
+  return ((voltage - 2500) * 100 + 800) / 1600;
+}
+
+// Bounds checked text output, keeps counting past the end
+typedef struct
+{
+  char *buffer;
+  size_t size;
+  size_t length;
+} Writer;
+
+static void put(Writer *w, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static void put(Writer *w, const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  size_t room = w->length < w->size ? w->size - w->length : 0;
+  int n = vsnprintf(w->buffer + (room ? w->length : 0), room, format, args);
+  va_end(args);
+  w->length += n > 0 ? n : 0;
+}
+
+// Fixed point value / 100, no trailing zeros
+static void putCentis(Writer *w, char separator, const char *name, int32_t value)
+{
+  const char *sign = value < 0 ? "-" : "";
+  uint32_t v = value < 0 ? -(int64_t)value : value;
+  uint32_t fraction = v % 100;
+
+  put(w, "%c%s=%s%u", separator, name, sign, (unsigned)(v / 100));
+  if (fraction % 10)
+  {
+    put(w, ".%02u", (unsigned)fraction);
+  }
+  else if (fraction)
+  {
+    put(w, ".%u", (unsigned)(fraction / 10));
+  }
+}
+
+// Measurement names escape comma and space
+static void putMeasurement(Writer *w, const char *measurement)
+{
+  for (const char *c = measurement; *c; c++)
+  {
+    put(w, (*c == ',' || *c == ' ') ? "\\%c" : "%c", *c);
+  }
+}
+
+size_t format_line_protocol(const char *measurement, const Uplink *uplink, uint32_t fcnt,
+                            uint64_t received, char *buffer, size_t size)
+{
+  Writer w = {buffer, size, 0};
+  uint8_t count = uplink->batch.count;
+  // a header only compact frame still has the battery
+  uint8_t points = count > 0 || uplink->port == FPORT_BACKLOG ? count : 1;
+  uint8_t fields = count > 0 ? uplink->fields : uplink->fields & COMPACT_BATTERY;
+
+  for (uint8_t i = 0; i < points; i++)
+  {
+    const SensorSample *s = &uplink->batch.samples[i];
+    uint64_t age = uplink->port == FPORT_BACKLOG ? uplink->ages[i] * 60ULL
+                                                 : (uint64_t)(points - 1 - i) * uplink->interval;
+    uint64_t time = received - age * 1000000000ULL;
+    char separator = ' ';
+
+    putMeasurement(&w, measurement);
+    if (fields & COMPACT_TEMPERATURE)
+    {
+      putCentis(&w, separator, "temperature", s->temperature);
+      separator = ',';
+    }
+    if (fields & COMPACT_HUMIDITY)
+    {
+      putCentis(&w, separator, "humidity", s->humidity);
+      separator = ',';
+    }
+    if (fields & COMPACT_PRESSURE)
+    {
+      putCentis(&w, separator, "pressure", s->pressure); // hPa
+      separator = ',';
+    }
+    if (fields & COMPACT_BATTERY)
+    {
+      putCentis(&w, separator, "batteryVoltage", uplink->voltage / 10);
+      put(&w, ",batteryPercentage=%u", uplink->gauge ? uplink->percent : battery_percentage(uplink->voltage));
+      if (uplink->gauge && uplink->days != 0xFFFF)
+      {
+        put(&w, ",batteryDays=%u", uplink->days);
+      }
+      separator = ',';
+    }
+    if (uplink->spread && i == count - 1)
+    {
+      if (uplink->fields & COMPACT_TEMPERATURE)
+      {
+        putCentis(&w, separator, "temperatureSpread", uplink->deviation.temperature);
+        separator = ',';
+      }
+      if (uplink->fields & COMPACT_HUMIDITY)
+      {
+        putCentis(&w, separator, "humiditySpread", uplink->deviation.humidity);
+        separator = ',';
+      }
+      if (uplink->fields & COMPACT_PRESSURE)
+      {
+        putCentis(&w, separator, "pressureSpread", uplink->deviation.pressure);
+        separator = ',';
+      }
+    }
+    put(&w, "%cf_cnt=%u %llu\n", separator, (unsigned)fcnt, (unsigned long long)time);
+  }
+
+  if (w.length >= size)
+  {
+    if (size > 0)
+    {
+      buffer[0] = 0;
+    }
+    return 0;
+  }
+  return w.length;
+}
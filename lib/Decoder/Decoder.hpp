@@ -0,0 +1,61 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <Payload.hpp>
+
+// Reference decoder for the uplink formats, the same rules as
+// integrations/ttn/payload_formatter.js. Used on the host by the tests
+// and tools/replay_bench.cpp, the firmware does not link it.
+
+typedef enum
+{
+  DECODE_OK = 0,
+  DECODE_PORT = 1,   // unknown FPort
+  DECODE_LENGTH = 2, // wrong frame length
+  DECODE_CRC = 3,    // crc8 mismatch
+  DECODE_FORMAT = 4, // unsupported version, truncated or trailing bytes
+} DecodeResult;
+
+// One decoded uplink, samples oldest first
+typedef struct
+{
+  uint8_t port;
+  uint8_t status;
+  uint8_t fields;    // COMPACT_* flags, FPort 1 frames are mapped onto them
+  uint32_t interval; // seconds between samples, 0 for a single sample
+  uint16_t voltage;  // mV, 0 without COMPACT_BATTERY
+  bool gauge;        // COMPACT_EXT_BATTERY present
+  uint8_t percent;   // device state of charge, only with gauge
+  uint16_t days;     // remaining days, only with gauge, 0xFFFF unknown
+  bool spread;       // COMPACT_EXT_SPREAD present
+  SensorSample deviation; // standard deviation behind the last sample, only with spread
+  bool rebased;      // FPort 3, some ages are lower bounds
+  uint16_t ages[MAX_BATCH_SIZE]; // FPort 3, minutes before the uplink per sample
+  SampleBatch batch;
+} Uplink;
+
+extern DecodeResult decode_uplink(uint8_t port, const uint8_t *buffer, uint8_t length, Uplink *uplink);
+
+// Battery percentage of frames without COMPACT_EXT_BATTERY, 2.5V - 4.1V
+extern uint8_t battery_percentage(uint16_t voltage);
+
+// InfluxDB line protocol, one line per sample with the fields the
+// Node-RED flow writes. received is the time of the uplink in ns, the
+// last sample was taken at that time, backlog samples at their age. Returns the length written, or 0
+// if the lines do not fit into size.
+extern size_t format_line_protocol(const char *measurement, const Uplink *uplink, uint32_t fcnt,
+                                   uint64_t received, char *buffer, size_t size);
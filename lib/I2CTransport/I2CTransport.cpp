@@ -0,0 +1,137 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "I2CTransport.hpp"
+
+I2CCounters i2cCounters;
+
+static void increment(uint16_t *counter)
+{
+  if (*counter < 0xFFFF)
+  {
+    (*counter)++;
+  }
+}
+
+void i2c_clear_counters()
+{
+  memset(&i2cCounters, 0, sizeof(i2cCounters));
+}
+
+void I2CTransport::begin(uint8_t address)
+{
+  this->address = address;
+}
+
+bool I2CTransport::read(uint8_t reg, uint8_t *data, uint8_t length)
+{
+  uint32_t start = millis();
+  for (uint8_t attempt = 0;; attempt++)
+  {
+    if (readOnce(reg, data, length))
+    {
+      return true;
+    }
+    if (!retry(attempt, start))
+    {
+      return false;
+    }
+  }
+}
+
+bool I2CTransport::read8(uint8_t reg, uint8_t *value)
+{
+  return read(reg, value, 1);
+}
+
+bool I2CTransport::write(uint8_t reg, const uint8_t *data, uint8_t length)
+{
+  uint32_t start = millis();
+  for (uint8_t attempt = 0;; attempt++)
+  {
+    if (writeOnce(reg, data, length))
+    {
+      return true;
+    }
+    if (!retry(attempt, start))
+    {
+      return false;
+    }
+  }
+}
+
+bool I2CTransport::write8(uint8_t reg, uint8_t value)
+{
+  return write(reg, &value, 1);
+}
+
+// Register pointer write, then a burst read with auto increment
+bool I2CTransport::readOnce(uint8_t reg, uint8_t *data, uint8_t length)
+{
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  if (Wire.endTransmission() != 0)
+  {
+    return false;
+  }
+
+  if (Wire.requestFrom(address, length) < length || Wire.available() < length)
+  {
+    // drain a short read, it must not show up in the next one
+    while (Wire.available() > 0)
+    {
+      Wire.read();
+    }
+    return false;
+  }
+
+  for (uint8_t i = 0; i < length; i++)
+  {
+    data[i] = Wire.read();
+  }
+  return true;
+}
+
+bool I2CTransport::writeOnce(uint8_t reg, const uint8_t *data, uint8_t length)
+{
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  for (uint8_t i = 0; i < length; i++)
+  {
+    Wire.write(data[i]);
+  }
+  return Wire.endTransmission() == 0;
+}
+
+// Count the failed attempt, wait the backoff and return true if another
+// attempt fits into the attempts and time budget
+bool I2CTransport::retry(uint8_t attempt, uint32_t start)
+{
+  increment(&i2cCounters.errors);
+
+  uint32_t backoff = (uint32_t)I2C_BACKOFF << attempt;
+  if (attempt + 1 >= I2C_ATTEMPTS || millis() - start + backoff > I2C_TIMEOUT)
+  {
+    increment(&i2cCounters.failures);
+#ifdef DEBUG
+    Serial.printf("I2C 0x%02x failed after %d attempts\n", address, attempt + 1);
+#endif
+    return false;
+  }
+
+  increment(&i2cCounters.retries);
+  delay(backoff);
+  return true;
+}
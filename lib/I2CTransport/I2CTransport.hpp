@@ -0,0 +1,69 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <Wire.h>
+
+// Tries per transaction, the first one included
+#ifndef I2C_ATTEMPTS
+#define I2C_ATTEMPTS 3
+#endif
+
+// ms before the first retry, doubled for every further one
+#ifndef I2C_BACKOFF
+#define I2C_BACKOFF 1
+#endif
+
+// ms a transaction may take including all retries, no retry is started
+// that would end after it
+#ifndef I2C_TIMEOUT
+#define I2C_TIMEOUT 10
+#endif
+
+// Cumulative since boot over all transports, saturating
+typedef struct
+{
+  uint16_t errors;   // failed attempts: NACK, short read
+  uint16_t retries;  // attempts repeated after an error
+  uint16_t failures; // transactions given up
+} I2CCounters;
+
+extern I2CCounters i2cCounters;
+
+// Register access to one I2C device with a bounded retry policy.
+// A failure costs at most I2C_TIMEOUT ms and is reported by the return
+// value, the data is not touched by a failed read. Wire itself is
+// started and ended with the POWER_I2C domain.
+class I2CTransport
+{
+public:
+  void begin(uint8_t address);
+
+  bool read(uint8_t reg, uint8_t *data, uint8_t length);
+  bool read8(uint8_t reg, uint8_t *value);
+  bool write(uint8_t reg, const uint8_t *data, uint8_t length);
+  bool write8(uint8_t reg, uint8_t value);
+
+private:
+  uint8_t address;
+
+  bool readOnce(uint8_t reg, uint8_t *data, uint8_t length);
+  bool writeOnce(uint8_t reg, const uint8_t *data, uint8_t length);
+  bool retry(uint8_t attempt, uint32_t start);
+};
+
+// Clear the counters, for tests
+extern void i2c_clear_counters();
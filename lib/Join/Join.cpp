@@ -0,0 +1,218 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Join.hpp"
+
+#define HOUR 3600000UL
+
+// Join request on air in ms for DR0 (SF12) .. DR5 (SF7), rounded up
+static const uint16_t airtimes[] = {1483, 824, 371, 206, 114, 62};
+
+uint32_t join_airtime(int8_t datarate)
+{
+  if (datarate < 0 || datarate > 5)
+  {
+    return airtimes[0];
+  }
+  return airtimes[datarate];
+}
+
+int8_t join_trial_datarate(uint8_t trial)
+{
+  if (trial % 48 == 0)
+  {
+    return 0;
+  }
+  if (trial % 32 == 0)
+  {
+    return 1;
+  }
+  if (trial % 24 == 0)
+  {
+    return 2;
+  }
+  if (trial % 16 == 0)
+  {
+    return 3;
+  }
+  if (trial % 8 == 0)
+  {
+    return 4;
+  }
+  return 5;
+}
+
+uint8_t join_trials(int8_t datarate)
+{
+  static const uint8_t trials[] = {48, 32, 24, 16, 8, 1};
+  if (datarate < 0 || datarate > 5)
+  {
+    return trials[0];
+  }
+  return trials[datarate];
+}
+
+// Length of the duty cycle period that began at periodStart and its budget
+static uint32_t periodLength(const JoinState *state, uint32_t *budget)
+{
+  uint32_t since = state->periodStart - state->start;
+  if (since < HOUR)
+  {
+    *budget = 36000;
+    return HOUR;
+  }
+  if (since < 11 * HOUR)
+  {
+    *budget = 36000;
+    return 10 * HOUR;
+  }
+  *budget = 8700;
+  return 24 * HOUR;
+}
+
+// Move periodStart to the period that contains now
+static void advancePeriod(JoinState *state, uint32_t now)
+{
+  uint32_t budget;
+  uint32_t length = periodLength(state, &budget);
+  while (now - state->periodStart >= length)
+  {
+    state->periodStart += length;
+    state->periodAirtime = 0;
+    length = periodLength(state, &budget);
+  }
+}
+
+void join_init(JoinState *state, uint32_t now, uint8_t seed)
+{
+  memset(state, 0, sizeof(JoinState));
+  state->start = now;
+  state->periodStart = now;
+  state->backoff = JOIN_BACKOFF_MIN;
+  state->offset = seed;
+}
+
+// The channels enabled in userChannelsMask that may carry a join request
+static uint16_t joinChannels()
+{
+  uint16_t channels = userChannelsMask[0] & JOIN_CHANNELS;
+  return channels ? channels : JOIN_CHANNELS;
+}
+
+// n-th enabled channel, modulo their number
+static uint16_t nthChannel(uint16_t channels, uint8_t n)
+{
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    count += (channels >> i) & 1;
+  }
+  n %= count;
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    if (((channels >> i) & 1) && n-- == 0)
+    {
+      return 1 << i;
+    }
+  }
+  return channels;
+}
+
+JoinAttempt join_next(JoinState *state, uint32_t now)
+{
+  JoinAttempt attempt;
+  uint8_t rates = JOIN_DR_MAX - JOIN_DR_MIN + 1;
+  uint8_t step = state->attempts + state->offset;
+
+  attempt.datarate = JOIN_DR_MAX - (state->attempts % rates);
+  attempt.trials = join_trials(attempt.datarate);
+  attempt.channelsMask = nthChannel(joinChannels(), step);
+  // the core keeps the trials inside a 1 % duty cycle
+  attempt.airtime = 0;
+  attempt.timeout = 0;
+  for (uint8_t trial = 1; trial <= attempt.trials; trial++)
+  {
+    uint32_t airtime = join_airtime(join_trial_datarate(trial));
+    attempt.airtime += airtime;
+    attempt.timeout += airtime * 100 + JOIN_RX_WINDOWS;
+  }
+
+  // half of the backoff fixed, half random
+  uint32_t wait;
+  if (state->attempts == 0)
+  {
+    wait = cubecell_random(JOIN_FIRST_JITTER);
+  }
+  else
+  {
+    wait = state->backoff / 2 + cubecell_random(state->backoff / 2 + 1);
+  }
+
+  // postpone to the next period while the budget is used up
+  uint32_t at = now + wait;
+  advancePeriod(state, at);
+  uint32_t budget;
+  uint32_t length = periodLength(state, &budget);
+  if (state->periodAirtime + attempt.airtime > budget)
+  {
+    at = state->periodStart + length + cubecell_random(JOIN_BACKOFF_MIN);
+  }
+
+  attempt.wait = at - now;
+  return attempt;
+}
+
+void join_apply(const JoinAttempt *attempt)
+{
+  uint16_t mask[6] = {attempt->channelsMask, 0, 0, 0, 0, 0};
+  MibRequestConfirm_t mib;
+
+  mib.Type = MIB_CHANNELS_MASK;
+  mib.Param.ChannelsMask = mask;
+  LoRaMacMibSetRequestConfirm(&mib);
+}
+
+LoRaMacStatus_t join_request(const JoinAttempt *attempt, uint8_t *appEui, uint8_t *appKey, uint8_t *devEui)
+{
+  MlmeReq_t mlme;
+  mlme.Type = MLME_JOIN;
+  mlme.Req.Join.DevEui = devEui;
+  mlme.Req.Join.AppEui = appEui;
+  mlme.Req.Join.AppKey = appKey;
+  mlme.Req.Join.NbTrials = attempt->trials;
+  return LoRaMacMlmeRequest(&mlme);
+}
+
+void join_attempted(JoinState *state, const JoinAttempt *attempt, uint32_t now)
+{
+  advancePeriod(state, now);
+  state->periodAirtime += attempt->airtime;
+  if (state->attempts < 0xFFFF)
+  {
+    state->attempts++;
+  }
+  if (state->attempts > 1)
+  {
+    state->backoff = state->backoff >= JOIN_BACKOFF_MAX / 2 ? JOIN_BACKOFF_MAX : state->backoff * 2;
+  }
+}
+
+void join_restore()
+{
+  MibRequestConfirm_t mib;
+  mib.Type = MIB_CHANNELS_MASK;
+  mib.Param.ChannelsMask = userChannelsMask;
+  LoRaMacMibSetRequestConfirm(&mib);
+}
@@ -0,0 +1,108 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <LoRaWanMinimal_APP.h>
+
+// OTAA join scheduling. A failed join is retried after an exponential
+// backoff with random jitter, so nodes that lost their session at the
+// same time do not join in lockstep. Every attempt uses the next join
+// channel and reaches down to the next data rate, and the time on air is
+// kept inside the join duty cycle of the LoRaWAN specification:
+//
+//   first hour            36 s
+//   next 10 hours         36 s
+//   every following day   8.7 s
+//
+// The MAC core picks the data rate of a join request itself, from the
+// number of the trial within one MLME join request (RegionAlternateDr,
+// EU868: every trial DR5, every 8th DR4 .. every 48th DR0), and
+// overrides MIB_CHANNELS_DATARATE. An attempt therefore is one MLME join
+// request with as many trials as it takes to reach its data rate.
+
+// ms before the first retry, doubled for every further one
+#ifndef JOIN_BACKOFF_MIN
+#define JOIN_BACKOFF_MIN 15000
+#endif
+#ifndef JOIN_BACKOFF_MAX
+#define JOIN_BACKOFF_MAX 3600000
+#endif
+// random delay before the first attempt
+#ifndef JOIN_FIRST_JITTER
+#define JOIN_FIRST_JITTER 5000
+#endif
+
+// lowest data rate reached by the attempts, from JOIN_DR_MAX down to
+// JOIN_DR_MIN
+#ifndef JOIN_DR_MAX
+#define JOIN_DR_MAX 5
+#endif
+#ifndef JOIN_DR_MIN
+#define JOIN_DR_MIN 0
+#endif
+
+// EU868 default channels, the only ones known before the join accept
+#define JOIN_CHANNELS 0x0007
+
+// ms until both receive windows of a join request have passed
+#define JOIN_RX_WINDOWS 7000
+
+typedef struct
+{
+  uint32_t start;          // millis() of the first attempt
+  uint32_t periodStart;    // begin of the current duty cycle period
+  uint32_t periodAirtime;  // ms on air in the current period
+  uint32_t backoff;        // ms, before jitter
+  uint16_t attempts;       // since join_init()
+  uint8_t offset;          // device specific start of the rotation
+} JoinState;
+
+typedef struct
+{
+  uint32_t wait;         // ms from now until the attempt
+  int8_t datarate;       // of the last trial
+  uint8_t trials;        // NbTrials of the MLME join request
+  uint16_t channelsMask; // MIB_CHANNELS_MASK, one join channel
+  uint32_t airtime;      // ms on air of all trials
+  uint32_t timeout;      // ms until the core has given up on all trials
+} JoinAttempt;
+
+// seed spreads the rotation of different devices, e.g. a devEui byte
+extern void join_init(JoinState *state, uint32_t now, uint8_t seed);
+
+// Plan the next attempt
+extern JoinAttempt join_next(JoinState *state, uint32_t now);
+
+// Set the channel of the attempt, call right before join_request()
+extern void join_apply(const JoinAttempt *attempt);
+
+// Send the MLME join request of the attempt, the result arrives
+// asynchronously (LoRaWAN.isJoined()) within attempt->timeout
+extern LoRaMacStatus_t join_request(const JoinAttempt *attempt, uint8_t *appEui, uint8_t *appKey, uint8_t *devEui);
+
+// Book the attempt, call after its result whatever it was
+extern void join_attempted(JoinState *state, const JoinAttempt *attempt, uint32_t now);
+
+// Enable all channels of userChannelsMask again, call after the join
+extern void join_restore();
+
+// ms on air of a join request (23 bytes, 125 kHz) at an EU868 data rate
+extern uint32_t join_airtime(int8_t datarate);
+
+// EU868 data rate the core uses for the n-th trial (1 based) of a join
+// request, and the number of trials it takes to reach a data rate
+extern int8_t join_trial_datarate(uint8_t trial);
+extern uint8_t join_trials(int8_t datarate);
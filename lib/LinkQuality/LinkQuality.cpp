@@ -0,0 +1,188 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "LinkQuality.hpp"
+
+// Demodulation floor in dB for EU868 DR0 (SF12) .. DR6 (SF7/250 kHz),
+// rounded towards less margin
+static const int8_t snrFloor[] = {-20, -17, -15, -12, -10, -7, -7};
+
+void link_init(LinkState *state)
+{
+  memset(state, 0, sizeof(LinkState));
+  state->txPower = LINK_TX_POWER_MAX;
+  state->sinceAdjust = LINK_HOLD;
+}
+
+void link_downlink(LinkState *state, int16_t rssi, int8_t snr, uint8_t rxSlot, uint8_t datarate)
+{
+  int16_t margin = snr - snrFloor[datarate < sizeof(snrFloor) ? datarate : 0];
+  if (rxSlot)
+  {
+    margin -= LINK_RX2_OFFSET;
+  }
+
+  LinkSample *sample = &state->samples[state->head];
+  sample->rssi = rssi;
+  sample->snr = snr;
+  sample->margin = margin < -127 ? -127 : margin > 127 ? 127 : margin;
+  sample->rxSlot = rxSlot;
+  state->head = (state->head + 1) % LINK_WINDOW;
+  if (state->count < LINK_WINDOW)
+  {
+    state->count++;
+  }
+#ifdef DEBUG
+  printf("link: rssi %d dBm, snr %d dB, margin %d dB, RX%d\n", rssi, snr, sample->margin, rxSlot + 1);
+#endif
+}
+
+int8_t link_margin(const LinkState *state)
+{
+  if (state->count == 0)
+  {
+    return LINK_MARGIN_UNKNOWN;
+  }
+  int16_t sum = 0;
+  for (uint8_t i = 0; i < state->count; i++)
+  {
+    sum += state->samples[i].margin;
+  }
+  return sum / state->count;
+}
+
+int16_t link_rssi(const LinkState *state)
+{
+  if (state->count == 0)
+  {
+    return 0;
+  }
+  int32_t sum = 0;
+  for (uint8_t i = 0; i < state->count; i++)
+  {
+    sum += state->samples[i].rssi;
+  }
+  return sum / state->count;
+}
+
+bool link_degraded(const LinkState *state)
+{
+  if (state->missedAcks > 0)
+  {
+    return true;
+  }
+  if (state->count == 0)
+  {
+    return false;
+  }
+  int8_t mean = link_margin(state);
+  int8_t latest = state->samples[(state->head + LINK_WINDOW - 1) % LINK_WINDOW].margin;
+  return mean < LINK_MARGIN_LOW || latest < mean - LINK_MARGIN_DROP;
+}
+
+bool link_confirm(const LinkState *state, uint8_t every)
+{
+  uint16_t uplink = state->sinceConfirmed + 1;
+  if (every > 0 && uplink >= every)
+  {
+    return true;
+  }
+  return uplink >= LINK_CONFIRM_DEGRADED && link_degraded(state);
+}
+
+void link_sent(LinkState *state, bool confirmed, bool acked)
+{
+  if (state->sinceAdjust < 0xFF)
+  {
+    state->sinceAdjust++;
+  }
+  if (!confirmed)
+  {
+    if (state->sinceConfirmed < 0xFF)
+    {
+      state->sinceConfirmed++;
+    }
+    return;
+  }
+
+  state->sinceConfirmed = 0;
+  if (state->confirmed < 0xFFFF)
+  {
+    state->confirmed++;
+  }
+  if (acked)
+  {
+    state->missedAcks = 0;
+    if (state->acked < 0xFFFF)
+    {
+      state->acked++;
+    }
+  }
+  else if (state->missedAcks < 0xFF)
+  {
+    state->missedAcks++;
+  }
+}
+
+bool link_adjust(LinkState *state, uint8_t datarate)
+{
+  if (state->sinceAdjust < LINK_HOLD)
+  {
+    return false;
+  }
+
+  if (link_degraded(state))
+  {
+    // full power first, then a more robust data rate
+    if (state->txPower != LINK_TX_POWER_MAX)
+    {
+      state->txPower = LINK_TX_POWER_MAX;
+    }
+    else if (state->datarateDrop < datarate)
+    {
+      state->datarateDrop++;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  else if (state->count == LINK_WINDOW && link_margin(state) >= LINK_MARGIN_HIGH)
+  {
+    // back to the configured data rate first, then less power
+    if (state->datarateDrop > 0)
+    {
+      state->datarateDrop--;
+    }
+    else if (state->txPower < LINK_TX_POWER_MIN)
+    {
+      state->txPower++;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  else
+  {
+    return false;
+  }
+
+#ifdef DEBUG
+  printf("link: TX power %d, data rate -%d\n", state->txPower, state->datarateDrop);
+#endif
+  state->sinceAdjust = 0;
+  return true;
+}
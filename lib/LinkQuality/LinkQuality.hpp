@@ -0,0 +1,111 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+// Link quality and confirmed uplink policy
+//
+// Every downlink leaves its RSSI, SNR and receive window in a small
+// rolling window. The SNR is turned into a margin above the demodulation
+// floor of the downlink data rate, so samples of different data rates
+// compare. The gateway sends RX2 downlinks with more power, their margin
+// is reduced by LINK_RX2_OFFSET.
+//
+// An uplink is confirmed every n-th frame (AppConfig.confirmed) and more
+// often while the link is degraded: the mean margin is low, the latest
+// margin dropped well below the mean or the last confirmed uplink was not
+// acked. With a fixed data rate the policy also trades TX power and data
+// rate for margin, with ADR the network server owns both.
+
+// samples in the rolling window
+#ifndef LINK_WINDOW
+#define LINK_WINDOW 8
+#endif
+// dB, below this mean margin the link is degraded
+#ifndef LINK_MARGIN_LOW
+#define LINK_MARGIN_LOW 5
+#endif
+// dB, above this mean margin over a full window TX power is reduced
+#ifndef LINK_MARGIN_HIGH
+#define LINK_MARGIN_HIGH 15
+#endif
+// dB, a sample this far below the mean degrades the link
+#ifndef LINK_MARGIN_DROP
+#define LINK_MARGIN_DROP 6
+#endif
+// dB, RX2 power advantage of the gateway (EU868 27 dBm vs 14 dBm)
+#ifndef LINK_RX2_OFFSET
+#define LINK_RX2_OFFSET 13
+#endif
+// every n-th uplink is confirmed while the link is degraded
+#ifndef LINK_CONFIRM_DEGRADED
+#define LINK_CONFIRM_DEGRADED 4
+#endif
+// uplinks between two TX power or data rate steps
+#ifndef LINK_HOLD
+#define LINK_HOLD 4
+#endif
+
+// EU868 TX power index (MIB_CHANNELS_TX_POWER), every step 2 dB less
+#define LINK_TX_POWER_MAX 0
+#define LINK_TX_POWER_MIN 7
+
+#define LINK_MARGIN_UNKNOWN -128
+
+typedef struct
+{
+  int16_t rssi;   // dBm
+  int8_t snr;     // dB
+  int8_t margin;  // dB above the demodulation floor
+  uint8_t rxSlot; // 0 = RX1, 1 = RX2
+} LinkSample;
+
+typedef struct
+{
+  LinkSample samples[LINK_WINDOW];
+  uint8_t head;           // next sample is written here
+  uint8_t count;          // samples in the window
+  uint8_t sinceConfirmed; // uplinks since the last confirmed one
+  uint8_t missedAcks;     // confirmed uplinks in a row without ack
+  uint8_t sinceAdjust;    // uplinks since the last TX power or data rate step
+  uint8_t txPower;        // LINK_TX_POWER_MAX..LINK_TX_POWER_MIN
+  uint8_t datarateDrop;   // data rates below the configured fixed one
+  uint16_t confirmed;     // confirmed uplinks since boot
+  uint16_t acked;         // confirmed uplinks with ack since boot
+} LinkState;
+
+extern void link_init(LinkState *state);
+
+// Record a downlink, datarate is the one it was received with
+extern void link_downlink(LinkState *state, int16_t rssi, int8_t snr, uint8_t rxSlot, uint8_t datarate);
+
+// Mean margin of the window in dB, LINK_MARGIN_UNKNOWN without samples
+extern int8_t link_margin(const LinkState *state);
+
+// Mean RSSI of the window in dBm, 0 without samples
+extern int16_t link_rssi(const LinkState *state);
+
+extern bool link_degraded(const LinkState *state);
+
+// Confirm the next uplink? every is AppConfig.confirmed, 0 = only while degraded
+extern bool link_confirm(const LinkState *state, uint8_t every);
+
+// Book an uplink, acked is the send result of a confirmed one
+extern void link_sent(LinkState *state, bool confirmed, bool acked);
+
+// One TX power or data rate step for a fixed data rate, true if either
+// changed. datarate is the configured fixed data rate.
+extern bool link_adjust(LinkState *state, uint8_t datarate);
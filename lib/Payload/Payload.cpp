@@ -0,0 +1,411 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Payload.hpp"
+
+void init_frame(TxFrameData *frame, uint8_t status)
+{
+  frame->preamble = FRAME_PREAMBLE;
+  frame->status = status;
+}
+
+#ifdef HAS_BME280
+void pack_sensor_data(TxFrameData *frame, int32_t temperature, int32_t humidity, int32_t pressure)
+{
+  frame->temperature = temperature & 0xFFFF;
+  frame->humidity = humidity & 0xFFFF;
+  frame->pressure = (pressure - 80000) & 0xFFFF;
+}
+#endif
+
+uint8_t battery_byte(uint16_t voltage)
+{
+  if (voltage < 2000)
+  {
+    voltage = 2000;
+  }
+  if (voltage > 4550)
+  {
+    voltage = 4550;
+  }
+  return (voltage - 2000) / 10;
+}
+
+void pack_battery(TxFrameData *frame, uint16_t voltage)
+{
+  frame->battery = battery_byte(voltage);
+}
+
+void seal_frame(TxFrameData *frame)
+{
+  frame->crc8 = crc8((uint8_t *)frame, sizeof(TxFrameData) - 1);
+}
+
+bool batch_add(SampleBatch *batch, const SensorSample *sample)
+{
+  if (batch->count >= MAX_BATCH_SIZE)
+  {
+    return false;
+  }
+  batch->samples[batch->count++] = *sample;
+  return true;
+}
+
+uint8_t put_extension(uint8_t *buffer, uint8_t length, uint8_t size,
+                      uint8_t tag, const uint8_t *value, uint8_t valueLength)
+{
+  if (length + 2 + valueLength > size)
+  {
+    return length;
+  }
+  buffer[length++] = tag;
+  buffer[length++] = valueLength;
+  memcpy(buffer + length, value, valueLength);
+  return length + valueLength;
+}
+
+// Bounds checked output, counts only if buffer is NULL
+typedef struct
+{
+  uint8_t *buffer;
+  uint16_t size;
+  uint16_t length;
+} Writer;
+
+static void put(Writer *w, uint8_t value)
+{
+  if (w->buffer && w->length < w->size)
+  {
+    w->buffer[w->length] = value;
+  }
+  w->length++;
+}
+
+static void putVarint(Writer *w, uint32_t value)
+{
+  while (value >= 0x80)
+  {
+    put(w, (value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  put(w, value);
+}
+
+static uint32_t zigzag(int32_t value)
+{
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static void putSample(Writer *w, uint8_t fields, const SensorSample *s, const SensorSample *ref)
+{
+  if (fields & COMPACT_TEMPERATURE)
+  {
+    putVarint(w, zigzag(s->temperature - ref->temperature));
+  }
+  if (fields & COMPACT_HUMIDITY)
+  {
+    putVarint(w, zigzag(s->humidity - ref->humidity));
+  }
+  if (fields & COMPACT_PRESSURE)
+  {
+    putVarint(w, zigzag(s->pressure - ref->pressure));
+  }
+}
+
+uint8_t encode_compact(const CompactHeader *header, const SampleBatch *batch,
+                       uint8_t *buffer, uint8_t size)
+{
+  static const SensorSample reference = {
+      COMPACT_REF_TEMPERATURE, COMPACT_REF_HUMIDITY, COMPACT_REF_PRESSURE};
+
+  Writer w = {buffer, size, 0};
+  uint8_t fields = header->fields & 0x1F;
+  bool isBatch = batch->count != 1;
+
+  if (header->extensionLength == 0)
+  {
+    fields &= ~COMPACT_EXTENSION;
+  }
+
+  put(&w, (COMPACT_VERSION << 6) | (isBatch ? COMPACT_BATCH : 0) | fields);
+  put(&w, header->status);
+
+  if (isBatch)
+  {
+    put(&w, batch->count);
+    putVarint(&w, header->interval);
+  }
+
+  if (fields & COMPACT_BATTERY)
+  {
+    put(&w, battery_byte(header->voltage));
+  }
+
+  for (uint8_t i = 0; i < batch->count; i++)
+  {
+    putSample(&w, fields, &batch->samples[i], i == 0 ? &reference : &batch->samples[i - 1]);
+  }
+
+  if (fields & COMPACT_EXTENSION)
+  {
+    for (uint8_t i = 0; i < header->extensionLength; i++)
+    {
+      put(&w, header->extension[i]);
+    }
+  }
+
+  if (buffer && w.length < w.size)
+  {
+    buffer[w.length] = crc8(buffer, w.length);
+  }
+  w.length++;
+
+  return w.length <= size ? w.length : 0;
+}
+
+// Bounds checked input
+typedef struct
+{
+  const uint8_t *buffer;
+  uint8_t length;
+  uint8_t position;
+  bool error;
+} Reader;
+
+static uint8_t get(Reader *r)
+{
+  if (r->position >= r->length)
+  {
+    r->error = true;
+    return 0;
+  }
+  return r->buffer[r->position++];
+}
+
+static uint32_t getVarint(Reader *r)
+{
+  uint32_t value = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7)
+  {
+    uint8_t b = get(r);
+    value |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+    {
+      return value;
+    }
+  }
+  r->error = true;
+  return 0;
+}
+
+bool decode_compact(const uint8_t *buffer, uint8_t length,
+                    CompactHeader *header, SampleBatch *batch)
+{
+  if (length < 3 || crc8(buffer, length - 1) != buffer[length - 1])
+  {
+    return false;
+  }
+
+  // crc8 is not part of the content
+  Reader r = {buffer, (uint8_t)(length - 1), 0, false};
+  uint8_t first = get(&r);
+
+  memset(header, 0, sizeof(CompactHeader));
+  header->version = first >> 6;
+  header->fields = first & 0x1F;
+  if (header->version != COMPACT_VERSION)
+  {
+    return false;
+  }
+
+  header->status = get(&r);
+  batch->count = 1;
+
+  if (first & COMPACT_BATCH)
+  {
+    batch->count = get(&r);
+    header->interval = getVarint(&r);
+    if (batch->count > MAX_BATCH_SIZE)
+    {
+      return false;
+    }
+  }
+
+  if (header->fields & COMPACT_BATTERY)
+  {
+    header->voltage = get(&r) * 10 + 2000;
+  }
+
+  SensorSample s = {COMPACT_REF_TEMPERATURE, COMPACT_REF_HUMIDITY, COMPACT_REF_PRESSURE};
+  for (uint8_t i = 0; i < batch->count; i++)
+  {
+    if (header->fields & COMPACT_TEMPERATURE)
+    {
+      s.temperature += unzigzag(getVarint(&r));
+    }
+    if (header->fields & COMPACT_HUMIDITY)
+    {
+      s.humidity += unzigzag(getVarint(&r));
+    }
+    if (header->fields & COMPACT_PRESSURE)
+    {
+      s.pressure += unzigzag(getVarint(&r));
+    }
+    batch->samples[i] = s;
+  }
+
+  if (header->fields & COMPACT_EXTENSION)
+  {
+    header->extension = buffer + r.position;
+    header->extensionLength = r.length - r.position;
+    r.position = r.length;
+  }
+
+  return !r.error && r.position == r.length;
+}
+
+uint16_t backlog_word(uint8_t field, int32_t value)
+{
+  int32_t min = 0;
+  if (field == COMPACT_TEMPERATURE)
+  {
+    min = -32768;
+  }
+  else if (field == COMPACT_PRESSURE)
+  {
+    value -= BACKLOG_REF_PRESSURE;
+  }
+  if (value < min)
+  {
+    value = min;
+  }
+  if (value > min + 0xFFFF)
+  {
+    value = min + 0xFFFF;
+  }
+  return (uint16_t)value;
+}
+
+int32_t backlog_value(uint8_t field, uint16_t word)
+{
+  if (field == COMPACT_TEMPERATURE)
+  {
+    return (int16_t)word;
+  }
+  if (field == COMPACT_PRESSURE)
+  {
+    return word + BACKLOG_REF_PRESSURE;
+  }
+  return word;
+}
+
+static void put16(Writer *w, uint16_t value)
+{
+  put(w, value >> 8);
+  put(w, value);
+}
+
+uint8_t encode_backlog(uint8_t fields, bool rebased, const SensorSample *samples,
+                       const uint16_t *ages, uint8_t count, uint8_t *buffer, uint8_t size)
+{
+  Writer w = {buffer, size, 0};
+  fields &= BACKLOG_FIELDS;
+
+  put(&w, (BACKLOG_VERSION << 6) | (rebased ? BACKLOG_REBASED : 0) | fields);
+  put(&w, count);
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    const SensorSample *s = &samples[i];
+    put16(&w, ages[i]);
+    if (fields & COMPACT_TEMPERATURE)
+    {
+      put16(&w, backlog_word(COMPACT_TEMPERATURE, s->temperature));
+    }
+    if (fields & COMPACT_HUMIDITY)
+    {
+      put16(&w, backlog_word(COMPACT_HUMIDITY, s->humidity));
+    }
+    if (fields & COMPACT_PRESSURE)
+    {
+      put16(&w, backlog_word(COMPACT_PRESSURE, s->pressure));
+    }
+  }
+
+  if (buffer && w.length < w.size)
+  {
+    buffer[w.length] = crc8(buffer, w.length);
+  }
+  w.length++;
+
+  return w.length <= size ? w.length : 0;
+}
+
+static uint16_t get16(Reader *r)
+{
+  uint16_t value = get(r) << 8;
+  return value | get(r);
+}
+
+bool decode_backlog(const uint8_t *buffer, uint8_t length, uint8_t *fields, bool *rebased,
+                    SampleBatch *batch, uint16_t *ages)
+{
+  if (length < 3 || crc8(buffer, length - 1) != buffer[length - 1])
+  {
+    return false;
+  }
+
+  Reader r = {buffer, (uint8_t)(length - 1), 0, false};
+  uint8_t first = get(&r);
+  if ((first >> 6) != BACKLOG_VERSION)
+  {
+    return false;
+  }
+  *fields = first & BACKLOG_FIELDS;
+  *rebased = (first & BACKLOG_REBASED) != 0;
+
+  batch->count = get(&r);
+  if (batch->count > MAX_BATCH_SIZE)
+  {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < batch->count; i++)
+  {
+    SensorSample *s = &batch->samples[i];
+    memset(s, 0, sizeof(SensorSample));
+    ages[i] = get16(&r);
+    if (*fields & COMPACT_TEMPERATURE)
+    {
+      s->temperature = backlog_value(COMPACT_TEMPERATURE, get16(&r));
+    }
+    if (*fields & COMPACT_HUMIDITY)
+    {
+      s->humidity = backlog_value(COMPACT_HUMIDITY, get16(&r));
+    }
+    if (*fields & COMPACT_PRESSURE)
+    {
+      s->pressure = backlog_value(COMPACT_PRESSURE, get16(&r));
+    }
+  }
+
+  return !r.error && r.position == r.length;
+}
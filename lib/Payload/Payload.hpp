@@ -0,0 +1,162 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <AppConfig.hpp>
+#include <CRC8.hpp>
+
+// Preamble of a TxFrameData frame
+#define FRAME_PREAMBLE 0x5A
+
+// Uplink ports
+#define FPORT_FRAME 1   // TxFrameData, build with -DLEGACY_FRAME
+#define FPORT_COMPACT 2 // compact frame
+#define FPORT_BACKLOG 3 // samples that could not be sent in time
+
+// Compact frame, version 1
+//
+//   header   bits 7..6 version, bit 5 batch, bits 4..0 COMPACT_* field flags
+//   status
+//   count    samples, only with the batch bit
+//   interval varint, seconds between samples, only with the batch bit
+//   battery  (mV - 2000) / 10, only with COMPACT_BATTERY
+//   samples  count x present fields as zig-zag varints, oldest first.
+//            The first sample is relative to COMPACT_REF_*, every later
+//            sample is the delta to the one before.
+//   extension (tag, length, value) records up to the crc, only with
+//            COMPACT_EXTENSION
+//   crc8
+//
+// The last sample was taken right before the uplink. A batch of 0
+// samples is a header only frame, sent when all sensor reads failed.
+// Decoders must skip extension tags they do not know.
+#define COMPACT_VERSION 1
+#define COMPACT_BATCH 0x20
+#define COMPACT_TEMPERATURE 0x01 // 0.01 degree C
+#define COMPACT_HUMIDITY 0x02    // 0.01 %
+#define COMPACT_PRESSURE 0x04    // Pa
+#define COMPACT_BATTERY 0x08
+#define COMPACT_EXTENSION 0x10
+
+// Status flags
+#define COMPACT_STATUS_OK 0x01     // always set
+#define COMPACT_STATUS_SENSOR 0x02 // sensor init or a read of the last measurement failed
+#define COMPACT_STATUS_BUS 0x04    // new I2C errors, the counters follow as COMPACT_EXT_BUS
+
+// Extension tags
+#define COMPACT_EXT_ACK 0x01 // status, tag, count of the last command downlink (Command.hpp)
+#define COMPACT_EXT_BUS 0x02 // I2C errors, retries, failures since boot, 16 bit big endian (I2CTransport.hpp)
+#define COMPACT_EXT_JOIN 0x03 // join requests sent for the current session, 16 bit big endian (Join.hpp)
+#define COMPACT_EXT_LINK 0x04 // confirmed, acked uplinks 16 bit, margin dB int8 (-128 unknown), RSSI dBm int16, TX power (LinkQuality.hpp)
+#define COMPACT_EXT_BATTERY 0x05 // state of charge %, remaining days 16 bit big endian (0xFFFF unknown) (Battery.hpp)
+#define COMPACT_EXT_SPREAD 0x06 // COMPACT_* field flags, then the standard deviation of the last sample per field, 16 bit big endian (Aggregator.hpp)
+
+#define COMPACT_REF_TEMPERATURE 0
+#define COMPACT_REF_HUMIDITY 0
+#define COMPACT_REF_PRESSURE 101325
+
+// Largest frame the encoder writes (EU868 DR5..DR7)
+#define COMPACT_MAX_SIZE 222
+
+// Backlog frame, version 1
+//
+//   header   bits 7..6 version, bit 5 BACKLOG_REBASED, bits 2..0 COMPACT_*
+//            sensor field flags
+//   count
+//   samples  count x age and the present fields, 16 bit big endian each:
+//            age in minutes before the uplink, temperature 0.01 degree C
+//            signed, humidity 0.01 %, pressure in Pa - BACKLOG_REF_PRESSURE
+//   crc8
+//
+// Samples are oldest first and only sent after the compact frame of the
+// current cycle, see lib/Backlog.
+#define BACKLOG_VERSION 1
+#define BACKLOG_REBASED 0x20 // some samples are older than the last reset, their age is a lower bound
+#define BACKLOG_FIELDS (COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE)
+#define BACKLOG_REF_PRESSURE 50000
+
+// One aggregated measurement
+typedef struct
+{
+  int32_t temperature; // 0.01 degree C
+  int32_t humidity;    // 0.01 %
+  int32_t pressure;    // Pa
+} SensorSample;
+
+typedef struct
+{
+  uint8_t count;
+  SensorSample samples[MAX_BATCH_SIZE];
+} SampleBatch;
+
+// Everything in a compact frame except the samples
+typedef struct
+{
+  uint8_t version;
+  uint8_t fields;   // COMPACT_* flags
+  uint8_t status;
+  uint32_t interval; // seconds, 0 for single sample frames
+  uint16_t voltage;  // mV, 0 without COMPACT_BATTERY
+  const uint8_t *extension;
+  uint8_t extensionLength;
+} CompactHeader;
+
+// Set preamble and status, sensor values are kept
+extern void init_frame(TxFrameData *frame, uint8_t status);
+
+#ifdef HAS_BME280
+// temperature in 0.01 degree C, humidity in 0.01 %, pressure in Pa
+extern void pack_sensor_data(TxFrameData *frame, int32_t temperature, int32_t humidity, int32_t pressure);
+#endif
+
+// Battery voltage in mV, 2.00V - 4.55V
+extern void pack_battery(TxFrameData *frame, uint16_t voltage);
+extern uint8_t battery_byte(uint16_t voltage);
+
+// Calculate and set the crc8 of a frame
+extern void seal_frame(TxFrameData *frame);
+
+// Append a sample, false if the batch is full
+extern bool batch_add(SampleBatch *batch, const SensorSample *sample);
+
+// Append a (tag, length, value) record to an extension buffer, returns
+// the new length or length unchanged if it does not fit into size
+extern uint8_t put_extension(uint8_t *buffer, uint8_t length, uint8_t size,
+                             uint8_t tag, const uint8_t *value, uint8_t valueLength);
+
+// Encode a compact frame, returns its length or 0 if it is larger than size.
+// With buffer == NULL only the length is calculated.
+extern uint8_t encode_compact(const CompactHeader *header, const SampleBatch *batch,
+                              uint8_t *buffer, uint8_t size);
+
+// Decode a compact frame, false on a wrong version, length or crc8.
+// header->extension points into buffer.
+extern bool decode_compact(const uint8_t *buffer, uint8_t length,
+                           CompactHeader *header, SampleBatch *batch);
+
+// 16 bit backlog representation of a COMPACT_* field value, saturated
+extern uint16_t backlog_word(uint8_t field, int32_t value);
+extern int32_t backlog_value(uint8_t field, uint16_t word);
+
+// Encode a backlog frame of count samples with their age in minutes,
+// returns its length or 0 if it is larger than size
+extern uint8_t encode_backlog(uint8_t fields, bool rebased, const SensorSample *samples,
+                              const uint16_t *ages, uint8_t count, uint8_t *buffer, uint8_t size);
+
+// Decode a backlog frame, false on a wrong version, length or crc8.
+// ages needs room for MAX_BATCH_SIZE entries.
+extern bool decode_backlog(const uint8_t *buffer, uint8_t length, uint8_t *fields, bool *rebased,
+                           SampleBatch *batch, uint16_t *ages);
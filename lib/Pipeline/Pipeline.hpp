@@ -0,0 +1,214 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <Aggregator.hpp>
+#include <Payload.hpp>
+
+// Compile time sensor pipeline
+//
+// A driver is a type with static members only:
+//
+//   static const uint8_t fields;      COMPACT_* flags of the values it sets
+//   static const uint8_t sampleBytes; worst case compact bytes per sample
+//   static bool begin();              configure, false if missing
+//   static bool start();              trigger one measurement
+//   static uint32_t conversionTime(); ms until the measurement is done
+//   static bool read(SensorSample *); the finished measurement into its fields
+//   static void end();                done until the next cycle
+//   static void print(const SensorSample *);
+//
+// Vext and the I2C bus are switched by the application (lib/Power)
+// around begin() and end().
+// SensorPipeline<A, B, ...> combines drivers without runtime dispatch.
+// Its fields go into the header of every compact frame, the decoders
+// therefore need no change for another combination of sensors.
+
+template <typename... Drivers>
+struct SensorPipeline;
+
+template <>
+struct SensorPipeline<>
+{
+  static const uint8_t fields = 0;
+  static const uint8_t sampleBytes = 0;
+
+  static bool begin() { return true; }
+  static bool start() { return true; }
+  static uint32_t conversionTime() { return 0; }
+  static bool read(SensorSample *) { return true; }
+  static void end() {}
+  static void print(const SensorSample *) {}
+};
+
+template <typename First, typename... Rest>
+struct SensorPipeline<First, Rest...>
+{
+  typedef SensorPipeline<Rest...> Next;
+  static_assert((First::fields & Next::fields) == 0, "two drivers set the same field");
+  static_assert((First::fields & ~(COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE)) == 0,
+                "drivers can only set sample fields");
+
+  static const uint8_t fields = First::fields | Next::fields;
+  static const uint8_t sampleBytes = First::sampleBytes + Next::sampleBytes;
+
+  // every driver is started, false if one of them failed
+  static bool begin()
+  {
+    bool ok = First::begin();
+    return Next::begin() && ok;
+  }
+
+  // all drivers convert in parallel
+  static bool start()
+  {
+    bool ok = First::start();
+    return Next::start() && ok;
+  }
+
+  static uint32_t conversionTime()
+  {
+    return First::conversionTime() > Next::conversionTime() ? First::conversionTime() : Next::conversionTime();
+  }
+
+  static bool read(SensorSample *sample)
+  {
+    bool ok = First::read(sample);
+    return Next::read(sample) && ok;
+  }
+
+  static void end()
+  {
+    First::end();
+    Next::end();
+  }
+
+  static void print(const SensorSample *sample)
+  {
+    First::print(sample);
+    Next::print(sample);
+  }
+};
+
+// Largest compact frame of a pipeline: header, status, count, interval
+// varint, battery, samples, extension and crc8
+template <typename Pipeline>
+constexpr uint16_t compact_frame_size(uint8_t samples, uint8_t extension)
+{
+  return 1 + 1 + 1 + 5 + 1 + samples * Pipeline::sampleBytes + extension + 1;
+}
+
+// Aggregates the fields of a pipeline, unused fields keep one slot only
+template <uint8_t Fields, uint8_t N>
+class SampleAggregator
+{
+public:
+  void reset()
+  {
+    count = 0;
+    temperatures.reset();
+    humidities.reset();
+    pressures.reset();
+  }
+
+  void add(const SensorSample *sample)
+  {
+    if (count >= N)
+    {
+      return;
+    }
+    count++;
+    if (Fields & COMPACT_TEMPERATURE)
+    {
+      temperatures.add(sample->temperature);
+    }
+    if (Fields & COMPACT_HUMIDITY)
+    {
+      humidities.add(sample->humidity);
+    }
+    if (Fields & COMPACT_PRESSURE)
+    {
+      pressures.add(sample->pressure);
+    }
+  }
+
+  uint8_t size() const
+  {
+    return count;
+  }
+
+  SensorSample aggregate(uint8_t mode) const
+  {
+    SensorSample sample = {};
+    if (Fields & COMPACT_TEMPERATURE)
+    {
+      sample.temperature = temperatures.aggregate(mode);
+    }
+    if (Fields & COMPACT_HUMIDITY)
+    {
+      sample.humidity = humidities.aggregate(mode);
+    }
+    if (Fields & COMPACT_PRESSURE)
+    {
+      sample.pressure = pressures.aggregate(mode);
+    }
+    return sample;
+  }
+
+  // Standard deviation of every field, same units as the sample
+  SensorSample deviation() const
+  {
+    SensorSample sample = {};
+    if (Fields & COMPACT_TEMPERATURE)
+    {
+      sample.temperature = temperatures.deviation();
+    }
+    if (Fields & COMPACT_HUMIDITY)
+    {
+      sample.humidity = humidities.deviation();
+    }
+    if (Fields & COMPACT_PRESSURE)
+    {
+      sample.pressure = pressures.deviation();
+    }
+    return sample;
+  }
+
+#ifdef DEBUG
+  void print() const
+  {
+    printf("samples = %d\n", count);
+    if (Fields & COMPACT_TEMPERATURE)
+    {
+      printf("temperature min/max/dev = %d/%d/%u\n", temperatures.min(), temperatures.max(), temperatures.deviation());
+    }
+    if (Fields & COMPACT_HUMIDITY)
+    {
+      printf("humidity min/max/dev = %d/%d/%u\n", humidities.min(), humidities.max(), humidities.deviation());
+    }
+    if (Fields & COMPACT_PRESSURE)
+    {
+      printf("pressure min/max/dev = %d/%d/%u\n", pressures.min(), pressures.max(), pressures.deviation());
+    }
+  }
+#endif
+
+private:
+  uint8_t count = 0;
+  Aggregator<int32_t, (Fields & COMPACT_TEMPERATURE) ? N : 1> temperatures; // 0.01 degree C
+  Aggregator<int32_t, (Fields & COMPACT_HUMIDITY) ? N : 1> humidities;      // 0.01 %
+  Aggregator<int32_t, (Fields & COMPACT_PRESSURE) ? N : 1> pressures;       // Pa
+};
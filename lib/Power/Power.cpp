@@ -0,0 +1,215 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Wire.h>
+#include <AppConfig.hpp>
+#include "Power.hpp"
+
+#define NO_PIN 0xFF
+
+// Vext is not parked, its P-MOSFET is off only while the pin drives HIGH
+static const uint8_t domainPins[POWER_DOMAINS][2] = {
+    {NO_PIN, NO_PIN},   // POWER_VEXT
+    {SDA, SCL},         // POWER_I2C
+    {UART_TX, UART_RX}, // POWER_UART
+    {RGB, NO_PIN},      // POWER_LED
+    {ADC, NO_PIN},      // POWER_ADC
+};
+
+static uint8_t counts[POWER_DOMAINS];
+static PowerEvent events[POWER_LOG_SIZE];
+static uint8_t eventHead; // next event is written here
+static uint8_t eventCount;
+
+static bool needsVext(PowerDomain domain)
+{
+  return domain == POWER_I2C || domain == POWER_LED;
+}
+
+static void record(uint8_t domain, uint8_t event)
+{
+  PowerEvent *e = &events[eventHead];
+  e->time = millis();
+  e->domain = domain;
+  e->event = event;
+  e->held = power_held();
+  eventHead = (eventHead + 1) % POWER_LOG_SIZE;
+  if (eventCount < POWER_LOG_SIZE)
+  {
+    eventCount++;
+  }
+}
+
+static void park(PowerDomain domain)
+{
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    if (domainPins[domain][i] != NO_PIN)
+    {
+      pinMode(domainPins[domain][i], ANALOG);
+    }
+  }
+}
+
+static void switchOn(PowerDomain domain)
+{
+  switch (domain)
+  {
+  case POWER_VEXT:
+    pinMode(Vext, OUTPUT);
+    digitalWrite(Vext, LOW);
+    break;
+  case POWER_I2C:
+    Wire.begin();
+    break;
+  case POWER_UART:
+    Serial.begin(POWER_UART_BAUD);
+    break;
+  case POWER_LED:
+    pixels.begin();
+    pixels.clear();
+    break;
+  default:
+    // getBatteryVoltage() configures the ADC pin itself
+    break;
+  }
+}
+
+static void switchOff(PowerDomain domain)
+{
+  switch (domain)
+  {
+  case POWER_VEXT:
+    pinMode(Vext, OUTPUT);
+    digitalWrite(Vext, HIGH);
+    break;
+  case POWER_I2C:
+    Wire.end();
+    break;
+  case POWER_UART:
+    Serial.flush();
+    Serial.end();
+    break;
+  case POWER_LED:
+    pixels.clear();
+    pixels.show();
+    break;
+  default:
+    break;
+  }
+  park(domain);
+}
+
+void power_init()
+{
+  memset(counts, 0, sizeof(counts));
+  power_log_clear();
+  switchOff(POWER_VEXT);
+  for (uint8_t d = POWER_I2C; d < POWER_DOMAINS; d++)
+  {
+    park((PowerDomain)d);
+  }
+}
+
+void power_acquire(PowerDomain domain)
+{
+  if (needsVext(domain))
+  {
+    power_acquire(POWER_VEXT);
+  }
+  if (counts[domain]++ == 0)
+  {
+    switchOn(domain);
+    record(domain, POWER_EVENT_ON);
+  }
+}
+
+void power_release(PowerDomain domain)
+{
+  if (counts[domain] == 0)
+  {
+    return;
+  }
+  if (--counts[domain] == 0)
+  {
+    switchOff(domain);
+    record(domain, POWER_EVENT_OFF);
+  }
+  if (needsVext(domain))
+  {
+    power_release(POWER_VEXT);
+  }
+}
+
+uint8_t power_held()
+{
+  uint8_t held = 0;
+  for (uint8_t d = 0; d < POWER_DOMAINS; d++)
+  {
+    if (counts[d])
+    {
+      held |= POWER_BIT(d);
+    }
+  }
+  return held;
+}
+
+uint8_t power_park()
+{
+  for (uint8_t d = 0; d < POWER_DOMAINS; d++)
+  {
+    if (!counts[d])
+    {
+      park((PowerDomain)d);
+    }
+  }
+  record(POWER_DOMAINS, POWER_EVENT_SLEEP);
+  return power_held();
+}
+
+uint8_t power_log_size()
+{
+  return eventCount;
+}
+
+const PowerEvent *power_log_event(uint8_t index)
+{
+  if (index >= eventCount)
+  {
+    return NULL;
+  }
+  uint8_t first = (eventHead + POWER_LOG_SIZE - eventCount) % POWER_LOG_SIZE;
+  return &events[(first + index) % POWER_LOG_SIZE];
+}
+
+void power_log_clear()
+{
+  eventHead = 0;
+  eventCount = 0;
+}
+
+void power_dump()
+{
+#ifdef DEBUG
+  static const char *names[POWER_DOMAINS + 1] = {"vext", "i2c", "uart", "led", "adc", "all"};
+  static const char *actions[] = {"on", "off", "sleep"};
+  for (uint8_t i = 0; i < eventCount; i++)
+  {
+    const PowerEvent *e = power_log_event(i);
+    printf("power: %lu %s %s, held %02x\n", (unsigned long)e->time, names[e->domain], actions[e->event], e->held);
+  }
+  power_log_clear();
+#endif
+}
@@ -0,0 +1,87 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+// Power domains
+//
+// Every peripheral that draws current while the MCU sleeps is a domain
+// with a reference count. power_acquire() switches a domain on with its
+// first user, power_release() switches it off with its last one. I2C and
+// the RGB LED hang on the Vext rail and hold it while they are on, the
+// rail drops only after the bus is ended and the LED is dark.
+//
+// A domain that is off has its pins parked in ANALOG mode, no pull-up,
+// no input buffer and no path into an unpowered sensor. power_park() is
+// called before lowPowerHandler() and parks them again in case a library
+// touched them. Every switch and every sleep is recorded in a small log
+// in RAM, the unit tests check the order, DEBUG builds print it.
+
+typedef enum
+{
+  POWER_VEXT, // switched sensor and LED rail, active low
+  POWER_I2C,  // Wire, needs Vext
+  POWER_UART, // Serial
+  POWER_LED,  // RGB NeoPixel, needs Vext
+  POWER_ADC,  // battery measurement
+  POWER_DOMAINS
+} PowerDomain;
+
+#define POWER_BIT(domain) (1 << (domain))
+
+#define POWER_EVENT_ON 0
+#define POWER_EVENT_OFF 1
+#define POWER_EVENT_SLEEP 2 // power_park(), domain is POWER_DOMAINS
+
+// events kept in the log, older ones are overwritten
+#ifndef POWER_LOG_SIZE
+#define POWER_LOG_SIZE 16
+#endif
+
+#ifndef POWER_UART_BAUD
+#define POWER_UART_BAUD 115200
+#endif
+
+typedef struct
+{
+  uint32_t time;  // millis()
+  uint8_t domain; // PowerDomain
+  uint8_t event;  // POWER_EVENT_*
+  uint8_t held;   // POWER_BIT mask of the domains on after the event
+} PowerEvent;
+
+// All domains off and parked, clears the log. Call once at boot.
+extern void power_init();
+
+extern void power_acquire(PowerDomain domain);
+
+// Releasing a domain nobody holds does nothing
+extern void power_release(PowerDomain domain);
+
+// POWER_BIT mask of the domains that are on
+extern uint8_t power_held();
+
+// Park the pins of all domains that are off, call right before
+// lowPowerHandler(). Returns power_held(), 0 is the sleep current floor.
+extern uint8_t power_park();
+
+// Events in the log, oldest first
+extern uint8_t power_log_size();
+extern const PowerEvent *power_log_event(uint8_t index);
+extern void power_log_clear();
+
+// Print and clear the log (DEBUG builds only)
+extern void power_dump();
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Profiler.hpp"
+
+#ifdef PROFILE
+
+static ProfileEvent events[PROFILE_BUFFER_SIZE];
+static uint8_t head;
+static uint8_t count;
+static uint16_t dropped;
+
+void profile_event(uint8_t event)
+{
+  events[head].timestamp = millis();
+  events[head].event = event;
+  head = (head + 1) % PROFILE_BUFFER_SIZE;
+
+  if (count < PROFILE_BUFFER_SIZE)
+  {
+    count++;
+  }
+  else
+  {
+    dropped++;
+  }
+}
+
+uint8_t profile_count()
+{
+  return count;
+}
+
+const ProfileEvent *profile_get(uint8_t index)
+{
+  if (index >= count)
+  {
+    return NULL;
+  }
+  return &events[(head + PROFILE_BUFFER_SIZE - count + index) % PROFILE_BUFFER_SIZE];
+}
+
+void profile_dump()
+{
+  if (dropped)
+  {
+    Serial.printf("PROFILE DROPPED %d\n", dropped);
+  }
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    const ProfileEvent *e = profile_get(i);
+    Serial.printf("PROFILE %u %c %d\n", (unsigned int)e->timestamp,
+                  (e->event & PROFILE_BEGIN_FLAG) ? 'B' : 'E',
+                  e->event & ~PROFILE_BEGIN_FLAG);
+  }
+  Serial.flush();
+
+  count = 0;
+  dropped = 0;
+}
+
+#endif
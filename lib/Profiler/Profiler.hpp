@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+// Phases of the wake/measure/send/sleep cycle
+#define PROFILE_JOIN 1
+#define PROFILE_SENSOR_INIT 2
+#define PROFILE_SENSOR_READ 3
+#define PROFILE_BATTERY 4
+#define PROFILE_SEND 5
+#define PROFILE_SLEEP 6
+
+// Set on begin events, cleared on end events
+#define PROFILE_BEGIN_FLAG 0x80
+
+#ifndef PROFILE_BUFFER_SIZE
+#define PROFILE_BUFFER_SIZE 32
+#endif
+
+// Build with -DPROFILE to enable the probes, without it they compile to nothing.
+// Timestamps come from millis(), which keeps running in deep sleep.
+#ifdef PROFILE
+#define PROFILE_BEGIN(phase) profile_event((phase) | PROFILE_BEGIN_FLAG)
+#define PROFILE_END(phase) profile_event(phase)
+#define PROFILE_DUMP() profile_dump()
+#else
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase)
+#define PROFILE_DUMP()
+#endif
+
+typedef struct
+{
+  uint32_t timestamp; // millis()
+  uint8_t event;      // phase | PROFILE_BEGIN_FLAG
+} ProfileEvent;
+
+#ifdef PROFILE
+// Record an event, the oldest one is overwritten when the buffer is full
+extern void profile_event(uint8_t event);
+
+// Number of buffered events, index 0 is the oldest
+extern uint8_t profile_count();
+extern const ProfileEvent *profile_get(uint8_t index);
+
+// Print all buffered events as "PROFILE <ms> <B|E> <phase>" and clear the buffer
+extern void profile_dump();
+#endif
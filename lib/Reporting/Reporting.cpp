@@ -0,0 +1,58 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Reporting.hpp"
+
+static bool outside(int32_t value, int32_t reference, uint16_t deadband)
+{
+  int32_t delta = value - reference;
+  return (delta < 0 ? -delta : delta) > deadband;
+}
+
+bool report_due(const ReportState *state, const SampleBatch *batch, uint32_t now)
+{
+  if (!state->valid ||
+      (appConfig.deadbandTemperature == 0 && appConfig.deadbandHumidity == 0 &&
+       appConfig.deadbandPressure == 0))
+  {
+    return true;
+  }
+
+  if (now - state->time >= appConfig.maxsilence)
+  {
+    return true;
+  }
+
+  for (uint8_t i = 0; i < batch->count; i++)
+  {
+    const SensorSample *s = &batch->samples[i];
+    if ((appConfig.deadbandTemperature && outside(s->temperature, state->sample.temperature, appConfig.deadbandTemperature)) ||
+        (appConfig.deadbandHumidity && outside(s->humidity, state->sample.humidity, appConfig.deadbandHumidity)) ||
+        (appConfig.deadbandPressure && outside(s->pressure, state->sample.pressure, appConfig.deadbandPressure)))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void report_sent(ReportState *state, const SensorSample *sample, uint32_t now)
+{
+  state->valid = true;
+  state->sample = *sample;
+  state->time = now;
+}
@@ -0,0 +1,36 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <AppConfig.hpp>
+#include <Payload.hpp>
+
+// Report by exception: a batch is only sent if one of its samples left
+// the deadband around the last sent sample, or if nothing was sent for
+// appConfig.maxsilence milliseconds. All deadbands 0 sends every batch.
+
+typedef struct
+{
+  bool valid;          // false until the first successful uplink
+  SensorSample sample; // last sample of the last sent batch
+  uint32_t time;       // millis() of the last sent batch
+} ReportState;
+
+// True if the batch has to be sent
+extern bool report_due(const ReportState *state, const SampleBatch *batch, uint32_t now);
+
+// Remember the last sample of a successfully sent batch
+extern void report_sent(ReportState *state, const SensorSample *sample, uint32_t now);
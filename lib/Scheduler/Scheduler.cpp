@@ -0,0 +1,159 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Scheduler.hpp"
+
+static bool rateEnabled()
+{
+  return appConfig.rateTemperature || appConfig.rateHumidity || appConfig.ratePressure;
+}
+
+// Change of one value per hour over the window
+static uint32_t ratePerHour(int32_t first, int32_t last, uint32_t span)
+{
+  int64_t delta = (int64_t)last - first;
+  if (delta < 0)
+  {
+    delta = -delta;
+  }
+  uint64_t rate = (uint64_t)delta * 3600000ULL / span;
+  return rate > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)rate;
+}
+
+// +1 fast, -1 stable, 0 in between or disabled
+static int8_t classify(uint32_t rate, uint16_t threshold)
+{
+  if (threshold == 0)
+  {
+    return -1;
+  }
+  if (rate > threshold)
+  {
+    return 1;
+  }
+  return (rate <= threshold / 2) ? -1 : 0;
+}
+
+static void addSample(SchedulerState *state, const SensorSample *sample, uint32_t now)
+{
+  if (state->count == SCHEDULER_WINDOW)
+  {
+    memmove(&state->samples[0], &state->samples[1], (SCHEDULER_WINDOW - 1) * sizeof(SensorSample));
+    memmove(&state->times[0], &state->times[1], (SCHEDULER_WINDOW - 1) * sizeof(uint32_t));
+    state->count--;
+  }
+  state->samples[state->count] = *sample;
+  state->times[state->count] = now;
+  state->count++;
+}
+
+// Adapt the interval once per added sample, a cycle without one keeps it
+static uint32_t rateInterval(SchedulerState *state, bool added)
+{
+  if (state->interval == 0 || state->sleeptime != appConfig.sleeptime)
+  {
+    // first cycle or new sleeptime by downlink, keep the newest sample only
+    state->interval = appConfig.sleeptime;
+    state->sleeptime = appConfig.sleeptime;
+    if (state->count > 1)
+    {
+      state->samples[0] = state->samples[state->count - 1];
+      state->times[0] = state->times[state->count - 1];
+      state->count = 1;
+    }
+  }
+
+  if (!added || state->count < 2)
+  {
+    return state->interval;
+  }
+
+  uint32_t span = state->times[state->count - 1] - state->times[0];
+  if (span == 0)
+  {
+    return state->interval;
+  }
+
+  const SensorSample *first = &state->samples[0];
+  const SensorSample *last = &state->samples[state->count - 1];
+  int8_t t = classify(ratePerHour(first->temperature, last->temperature, span), appConfig.rateTemperature);
+  int8_t h = classify(ratePerHour(first->humidity, last->humidity, span), appConfig.rateHumidity);
+  int8_t p = classify(ratePerHour(first->pressure, last->pressure, span), appConfig.ratePressure);
+
+  if (t > 0 || h > 0 || p > 0)
+  {
+    state->interval /= 2;
+  }
+  else if (t < 0 && h < 0 && p < 0)
+  {
+    state->interval += state->interval / 4;
+  }
+
+  if (state->interval < appConfig.minsleeptime)
+  {
+    state->interval = appConfig.minsleeptime;
+  }
+  if (state->interval > appConfig.maxsleeptime)
+  {
+    state->interval = appConfig.maxsleeptime;
+  }
+  return state->interval;
+}
+
+uint32_t schedule_next(SchedulerState *state, const SensorSample *sample, uint32_t now, uint16_t voltage)
+{
+  if (sample != NULL)
+  {
+    addSample(state, sample, now);
+  }
+
+  bool adaptive = rateEnabled();
+  uint32_t interval;
+
+  if (adaptive)
+  {
+    interval = rateInterval(state, sample != NULL);
+  }
+  else
+  {
+    state->interval = 0;
+    interval = appConfig.sleeptime;
+  }
+
+  // a low battery never shortens the interval
+  uint32_t longest = appConfig.maxsleeptime > interval ? appConfig.maxsleeptime : interval;
+
+  if (appConfig.batteryCritical && voltage < appConfig.batteryCritical)
+  {
+    adaptive = true;
+    interval = longest;
+  }
+  else if (appConfig.batteryLow && voltage < appConfig.batteryLow)
+  {
+    adaptive = true;
+    interval = (interval > longest / 2) ? longest : interval * 2;
+  }
+
+  if (adaptive && interval < appConfig.minsleeptime)
+  {
+    interval = appConfig.minsleeptime;
+  }
+
+#ifdef DEBUG
+  printf("next interval = %dms\n", interval);
+#endif
+  return interval;
+}
@@ -0,0 +1,43 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <AppConfig.hpp>
+#include <Payload.hpp>
+
+// Adaptive sampling interval. The rate of change over the last
+// SCHEDULER_WINDOW samples halves the interval if any value moves faster
+// than its appConfig.rate* threshold and lengthens it by a quarter while
+// all values move slower than half of it. A low battery doubles the
+// interval, a critical one uses appConfig.maxsleeptime. A cycle without
+// a sample keeps the rate based interval. With adaptation
+// enabled the result stays within appConfig.minsleeptime..maxsleeptime,
+// with all thresholds 0 appConfig.sleeptime is used unchanged.
+
+#define SCHEDULER_WINDOW 4
+
+typedef struct
+{
+  uint8_t count;                          // samples in the window
+  SensorSample samples[SCHEDULER_WINDOW]; // oldest first
+  uint32_t times[SCHEDULER_WINDOW];       // millis() of the samples
+  uint32_t interval;                      // rate based interval, 0 = restart
+  uint32_t sleeptime;                     // appConfig.sleeptime it is based on
+} SchedulerState;
+
+// Add the sample of this cycle (NULL if none) and return the time in
+// milliseconds until the next cycle
+extern uint32_t schedule_next(SchedulerState *state, const SensorSample *sample, uint32_t now, uint16_t voltage);
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <EEPROM.h>
+#include <CRC8.hpp>
+#include "Session.hpp"
+
+static_assert(sizeof(LoRaSession) <= SESSION_SIZE, "LoRaSession does not fit in front of the backlog");
+
+static LoRaSession session;
+static bool sessionValid = false;
+
+static void write_session()
+{
+  session.crc8 = crc8((const uint8_t *)&session, offsetof(LoRaSession, crc8));
+
+  EEPROM.begin(512);
+  for (uint8_t i = 0; i < sizeof(LoRaSession); i++)
+  {
+    EEPROM.write(SESSION_OFFSET + i, *((uint8_t *)&session + i));
+  }
+  EEPROM.commit();
+  EEPROM.end();
+}
+
+static bool read_session()
+{
+  EEPROM.begin(512);
+  for (uint8_t i = 0; i < sizeof(LoRaSession); i++)
+  {
+    *((uint8_t *)&session + i) = EEPROM.read(SESSION_OFFSET + i);
+  }
+  EEPROM.end();
+
+  return session.magic == SESSION_MAGIC && session.version == SESSION_VERSION &&
+         session.crc8 == crc8((const uint8_t *)&session, offsetof(LoRaSession, crc8)) &&
+         memcmp(session.devEui, appConfig.devEui, sizeof(session.devEui)) == 0 &&
+         session.appKeyCrc == crc8(appConfig.appKey, sizeof(appConfig.appKey));
+}
+
+static uint32_t uplinkCounter()
+{
+  MibRequestConfirm_t mib;
+  mib.Type = MIB_UPLINK_COUNTER;
+  LoRaMacMibGetRequestConfirm(&mib);
+  return mib.Param.UpLinkCounter;
+}
+
+bool session_save()
+{
+  MibRequestConfirm_t mib;
+
+  memset(&session, 0, sizeof(session));
+  session.magic = SESSION_MAGIC;
+  session.version = SESSION_VERSION;
+  memcpy(session.devEui, appConfig.devEui, sizeof(session.devEui));
+  session.appKeyCrc = crc8(appConfig.appKey, sizeof(appConfig.appKey));
+
+  mib.Type = MIB_NWK_SKEY;
+  if (LoRaMacMibGetRequestConfirm(&mib) != LORAMAC_STATUS_OK)
+  {
+    sessionValid = false;
+    return false;
+  }
+  memcpy(session.nwkSKey, mib.Param.NwkSKey, sizeof(session.nwkSKey));
+
+  mib.Type = MIB_APP_SKEY;
+  if (LoRaMacMibGetRequestConfirm(&mib) != LORAMAC_STATUS_OK)
+  {
+    sessionValid = false;
+    return false;
+  }
+  memcpy(session.appSKey, mib.Param.AppSKey, sizeof(session.appSKey));
+
+  mib.Type = MIB_DEV_ADDR;
+  LoRaMacMibGetRequestConfirm(&mib);
+  session.devAddr = mib.Param.DevAddr;
+
+  mib.Type = MIB_DOWNLINK_COUNTER;
+  LoRaMacMibGetRequestConfirm(&mib);
+  session.downlinkCounter = mib.Param.DownLinkCounter;
+
+  mib.Type = MIB_CHANNELS_DATARATE;
+  LoRaMacMibGetRequestConfirm(&mib);
+  session.datarate = mib.Param.ChannelsDatarate;
+
+  mib.Type = MIB_ADR;
+  LoRaMacMibGetRequestConfirm(&mib);
+  session.adr = mib.Param.AdrEnable;
+
+  mib.Type = MIB_RECEIVE_DELAY_1;
+  LoRaMacMibGetRequestConfirm(&mib);
+  session.receiveDelay1 = mib.Param.ReceiveDelay1;
+
+  mib.Type = MIB_RECEIVE_DELAY_2;
+  LoRaMacMibGetRequestConfirm(&mib);
+  session.receiveDelay2 = mib.Param.ReceiveDelay2;
+
+  mib.Type = MIB_RX2_CHANNEL;
+  LoRaMacMibGetRequestConfirm(&mib);
+  session.rx2Frequency = mib.Param.Rx2Channel.Frequency;
+  session.rx2Datarate = mib.Param.Rx2Channel.Datarate;
+
+  mib.Type = MIB_CHANNELS;
+  LoRaMacMibGetRequestConfirm(&mib);
+  for (uint8_t i = 0; i < SESSION_CHANNELS; i++)
+  {
+    const ChannelParams_t *channel = &mib.Param.ChannelList[SESSION_FIRST_CHANNEL + i];
+    session.channelFrequency[i] = channel->Frequency;
+    session.channelDrRange[i] = channel->DrRange.Value;
+  }
+
+  mib.Type = MIB_CHANNELS_MASK;
+  LoRaMacMibGetRequestConfirm(&mib);
+  session.channelsMask = mib.Param.ChannelsMask[0];
+
+  session.uplinkCounter = uplinkCounter() + SESSION_COUNTER_GAP;
+
+  write_session();
+  sessionValid = true;
+#ifdef DEBUG
+  printf("session saved, devaddr = %08X, fcnt up < %u\n", session.devAddr, session.uplinkCounter);
+#endif
+  return true;
+}
+
+void session_update()
+{
+  if (sessionValid && uplinkCounter() >= session.uplinkCounter)
+  {
+    session_save();
+  }
+}
+
+bool session_restore()
+{
+  sessionValid = false;
+  if (!read_session())
+  {
+#ifdef DEBUG
+    Serial.println("no stored session");
+#endif
+    return false;
+  }
+
+  LoRaWAN.joinABP(session.nwkSKey, session.appSKey, session.devAddr);
+
+  MibRequestConfirm_t mib;
+  mib.Type = MIB_UPLINK_COUNTER;
+  mib.Param.UpLinkCounter = session.uplinkCounter;
+  LoRaMacMibSetRequestConfirm(&mib);
+
+  mib.Type = MIB_DOWNLINK_COUNTER;
+  mib.Param.DownLinkCounter = session.downlinkCounter;
+  LoRaMacMibSetRequestConfirm(&mib);
+
+  mib.Type = MIB_ADR;
+  mib.Param.AdrEnable = session.adr;
+  LoRaMacMibSetRequestConfirm(&mib);
+
+  mib.Type = MIB_RECEIVE_DELAY_1;
+  mib.Param.ReceiveDelay1 = session.receiveDelay1;
+  LoRaMacMibSetRequestConfirm(&mib);
+
+  mib.Type = MIB_RECEIVE_DELAY_2;
+  mib.Param.ReceiveDelay2 = session.receiveDelay2;
+  LoRaMacMibSetRequestConfirm(&mib);
+
+  mib.Type = MIB_RX2_CHANNEL;
+  mib.Param.Rx2Channel.Frequency = session.rx2Frequency;
+  mib.Param.Rx2Channel.Datarate = session.rx2Datarate;
+  LoRaMacMibSetRequestConfirm(&mib);
+
+  for (uint8_t i = 0; i < SESSION_CHANNELS; i++)
+  {
+    if (session.channelFrequency[i] == 0)
+    {
+      continue;
+    }
+    ChannelParams_t channel = {};
+    channel.Frequency = session.channelFrequency[i];
+    channel.DrRange.Value = session.channelDrRange[i];
+    LoRaMacChannelAdd(SESSION_FIRST_CHANNEL + i, channel);
+  }
+
+  // after the channels, the mask may enable any of them
+  uint16_t mask[6] = {session.channelsMask};
+  mib.Type = MIB_CHANNELS_MASK;
+  mib.Param.ChannelsMask = mask;
+  LoRaMacMibSetRequestConfirm(&mib);
+
+  mib.Type = MIB_CHANNELS_DATARATE;
+  mib.Param.ChannelsDatarate = session.datarate;
+  LoRaMacMibSetRequestConfirm(&mib);
+
+  // reserve the next counter block before the first uplink
+  session_save();
+#ifdef DEBUG
+  printf("session restored, devaddr = %08X\n", session.devAddr);
+#endif
+  return true;
+}
+
+void session_clear()
+{
+  memset(&session, 0xFF, sizeof(session));
+  sessionValid = false;
+
+  EEPROM.begin(512);
+  EEPROM.write(SESSION_OFFSET, 0xFF); // magic
+  EEPROM.commit();
+  EEPROM.end();
+}
@@ -0,0 +1,87 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <LoRaWanMinimal_APP.h>
+#include <AppConfig.hpp>
+
+// LoRaWAN session record in EEPROM behind the config store. After a reset the
+// session is restored with joinABP() instead of a new OTAA join. Next to the
+// keys and counters it keeps what the join-accept set up: the receive
+// delays, the RX2 channel and the CFList channels, joinABP() alone would
+// fall back to the region defaults and listen in the wrong windows.
+//
+// The uplink counter is stored SESSION_COUNTER_GAP ahead of the MAC and
+// only rewritten when the MAC reaches it, a restored session therefore
+// never reuses a frame counter and the EEPROM is written once per
+// SESSION_COUNTER_GAP uplinks.
+
+#define SESSION_OFFSET 192
+#define SESSION_SIZE 96 // reserved up to the backlog
+#define SESSION_MAGIC 0x53
+#define SESSION_VERSION 2
+
+// EU868 channels 3 .. 7, the ones a CFList can add
+#define SESSION_FIRST_CHANNEL 3
+#define SESSION_CHANNELS 5
+
+#ifndef SESSION_COUNTER_GAP
+#define SESSION_COUNTER_GAP 32
+#endif
+
+// Confirmed uplinks without ack before a restored session is dropped
+#ifndef SESSION_CONFIRM_ATTEMPTS
+#define SESSION_CONFIRM_ATTEMPTS 3
+#endif
+
+typedef struct
+{
+  uint8_t magic;            // SESSION_MAGIC
+  uint8_t version;          // SESSION_VERSION
+  int8_t datarate;          // MIB_CHANNELS_DATARATE
+  uint8_t adr;              // MIB_ADR
+  uint8_t devEui[8];        // appConfig.devEui the session belongs to
+  uint8_t appKeyCrc;        // crc8 of appConfig.appKey
+  uint8_t rx2Datarate;      // MIB_RX2_CHANNEL
+  uint8_t reserved[2];
+  uint32_t devAddr;         // MIB_DEV_ADDR
+  uint8_t nwkSKey[16];      // MIB_NWK_SKEY
+  uint8_t appSKey[16];      // MIB_APP_SKEY
+  uint32_t uplinkCounter;   // next free uplink counter after a restore
+  uint32_t downlinkCounter; // MIB_DOWNLINK_COUNTER
+  uint16_t receiveDelay1;   // ms, MIB_RECEIVE_DELAY_1
+  uint16_t receiveDelay2;   // ms, MIB_RECEIVE_DELAY_2
+  uint32_t rx2Frequency;    // Hz, MIB_RX2_CHANNEL
+  uint32_t channelFrequency[SESSION_CHANNELS]; // Hz, 0 = unused
+  uint16_t channelsMask;                       // first word of MIB_CHANNELS_MASK
+  int8_t channelDrRange[SESSION_CHANNELS];     // DrRange_t.Value
+  uint8_t crc8;             // crc8 of all bytes above
+} LoRaSession;
+
+// Store the session of the MAC, call after a successful join.
+// False if the MAC does not expose the session keys.
+extern bool session_save();
+
+// Call after every uplink, stores the session when the reserved uplink
+// counter is used up
+extern void session_update();
+
+// Restore a stored session into the MAC, false if there is none or it
+// belongs to other credentials
+extern bool session_restore();
+
+// Invalidate the stored session, e.g. when the server rejects it
+extern void session_clear();
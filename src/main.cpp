@@ -16,149 +16,624 @@
 #include <LoRaWanMinimal_APP.h>
 #include <Arduino.h>
 #include <AppConfig.hpp>
-#include <AppConfig.hpp>
+#include <Payload.hpp>
+#include <Profiler.hpp>
+#include <Reporting.hpp>
+#include <Scheduler.hpp>
+#include <Session.hpp>
+#include <Command.hpp>
+#include <I2CTransport.hpp>
+#include <Join.hpp>
+#include <LinkQuality.hpp>
+#include <Backlog.hpp>
+#include <Battery.hpp>
+#include <Power.hpp>
+
+#include <Pipeline.hpp>
 
 #ifdef HAS_BME280
-#include <BME280.h>
-BME280 bme; // use I2C interface
+#include <BME280Sensor.hpp>
+typedef SensorPipeline<BME280Sensor> Sensors;
+#else
+typedef SensorPipeline<> Sensors; // battery only
 #endif
 
 uint16_t userChannelsMask[6] = {0x00FF, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000};
 TimerEvent_t sleepTimer;
 bool sleepTimerExpired;
 
+// Vext on until the sensors answer, Vext off until the battery reading settles
+#ifndef POWER_SETTLE_TIME
+#define POWER_SETTLE_TIME 10
+#endif
+#ifndef BATTERY_SETTLE_TIME
+#define BATTERY_SETTLE_TIME 50
+#endif
+
+typedef enum
+{
+  CYCLE_POWER_UP,        // Vext on, wait for the sensors
+  CYCLE_SENSOR_INIT,     // probe and configure the sensors
+  CYCLE_CONVERT,         // start a conversion, wait for its measurement time
+  CYCLE_READ,            // read it, next conversion or aggregate
+  CYCLE_BATTERY,         // Vext off, wait for the battery reading
+  CYCLE_MEASURE_BATTERY, // measure, wait appConfig.senddelay
+  CYCLE_SEND,            // batch and send
+  CYCLE_SLEEP,           // until the next interval
+} CycleState;
+
 // static ////////////////////////////////////////////////////////////////////
 
 static TxFrameData txFrame;
+static SampleBatch batch;
+static ReportState reportState;
+static SchedulerState schedulerState;
+static LinkState linkState;
+static Backlog backlog;
+static BatteryState batteryState;
+static bool linkUp = true; // the last uplink went out
+static uint32_t interval; // current sampling interval in milliseconds
 static uint32_t loopStart;
+static uint8_t sessionUnverified; // confirmed attempts left for a restored session
+static uint8_t extension[41];
+static SampleAggregator<Sensors::fields, SENSOR_READ_ITERATIONS> samples;
+static SensorSample batchSpread; // standard deviation behind the last sample of batch
+
+// a full batch, but never more than the largest LoRaWAN payload
+static const uint16_t compactFrameSize = compact_frame_size<Sensors>(MAX_BATCH_SIZE, sizeof(extension));
+static uint8_t compactFrame[compactFrameSize < COMPACT_MAX_SIZE ? compactFrameSize : COMPACT_MAX_SIZE];
+static CommandAck commandAck;
+static I2CCounters reportedCounters;   // i2cCounters of the last compact uplink
+static uint16_t reportedConfirmed;     // linkState.confirmed of the last compact uplink
+static uint8_t reportedPercent = 0xFF; // battery_percent() of the last compact uplink
+static uint16_t reportedDays;          // battery_days() of the last compact uplink
+static bool sensorFailed;
+static bool ackPending;        // commandAck goes into the next compact uplink
+static bool configChanged;     // a downlink changed the config
+static uint16_t joinAttempts;  // join requests of the current session
+static bool joinReportPending; // joinAttempts goes into the next compact uplink
 
 static void wakeUp()
 {
   sleepTimerExpired = true;
 }
 
-static void lowPowerSleep(uint32_t sleeptime)
+// Sleep in lowPowerHandler() until the timer wakes us up, pins of the
+// released power domains parked
+static void lowPowerWait(uint32_t ms)
 {
-  digitalWrite(Vext, HIGH);
+  power_park();
   sleepTimerExpired = false;
   TimerInit(&sleepTimer, &wakeUp);
-  TimerSetValue(&sleepTimer, sleeptime - (millis() - loopStart));
+  TimerSetValue(&sleepTimer, ms);
   TimerStart(&sleepTimer);
   while (!sleepTimerExpired)
     lowPowerHandler();
   TimerStop(&sleepTimer);
-  digitalWrite(Vext, LOW);
-  delay(100);
 }
 
-static uint8_t crc8(uint8_t *data, int length)
+// Join with backoff, the wait between attempts is spent with LED, Vext
+// and UART off. Returns with the LED off.
+static void join()
 {
-  uint8_t crc = 0x00;
-  while (length--)
+  JoinState state;
+  join_init(&state, millis(), appConfig.devEui[7]);
+  while (1)
   {
-    crc ^= *data++;
-    for (uint8_t i = 0; i < 8; i++)
+    JoinAttempt attempt = join_next(&state, millis());
+    if (attempt.wait > 0)
     {
-      if (crc & 0x80)
-      {
-        crc = (uint8_t)((crc << 1) ^ 0x07);
-      }
-      else
-      {
-        crc <<= 1;
-      }
+#ifdef DEBUG
+      printf("join: attempt %d in %lu ms\n", state.attempts + 1, (unsigned long)attempt.wait);
+#endif
+      clearBoardLED();
+      power_release(POWER_UART);
+      lowPowerWait(attempt.wait);
+      power_acquire(POWER_UART);
     }
-  }
-  return crc;
-}
-
-//////////////////////////////////////////////////////////////////////////////
-
-void setup()
-{
-  init_app_config();
-  LoRaWAN.begin(CLASS_A, LORAMAC_REGION_EU868);
-  LoRaWAN.setAdaptiveDR(true);
-
-  while (1)
-  {
     showBoardLED(0, 0, 50);
 
     Serial.print("Joining... ");
-    LoRaWAN.joinOTAA(appConfig.appEui, appConfig.appKey, appConfig.devEui);
+    join_apply(&attempt);
+    PROFILE_BEGIN(PROFILE_JOIN);
+    // the core sends the trials and picks their data rate
+    if (join_request(&attempt, appConfig.appEui, appConfig.appKey, appConfig.devEui) == LORAMAC_STATUS_OK)
+    {
+      uint32_t sent = millis();
+      while (!LoRaWAN.isJoined() && millis() - sent < attempt.timeout)
+        lowPowerHandler();
+    }
+    PROFILE_END(PROFILE_JOIN);
+    join_attempted(&state, &attempt, millis());
     if (!LoRaWAN.isJoined())
     {
-      Serial.println("JOIN FAILED! Sleeping for 30 seconds");
-      lowPowerSleep(30000);
+      Serial.println("JOIN FAILED!");
+      clearBoardLED();
     }
     else
     {
       Serial.println("JOINED");
+      join_restore();
+      session_save();
+      joinAttempts = state.attempts;
+      joinReportPending = true;
       showBoardLED(0, 50, 0);
       delay(2000);
+      clearBoardLED();
       break;
     }
   }
 }
 
-void loop()
+// With ADR off the link policy may lower TX power or the data rate
+static void applyRadioConfig()
+{
+  LoRaWAN.setAdaptiveDR(appConfig.adr);
+  if (!appConfig.adr)
+  {
+    uint8_t drop = linkState.datarateDrop;
+    LoRaWAN.setFixedDR(appConfig.datarate > drop ? appConfig.datarate - drop : 0);
+
+    MibRequestConfirm_t mib;
+    mib.Type = MIB_CHANNELS_TX_POWER;
+    mib.Param.ChannelsTxPower = linkState.txPower;
+    LoRaMacMibSetRequestConfirm(&mib);
+  }
+}
+
+// Every appConfig.confirmed-th uplink is confirmed, more often while the
+// link is degraded (LinkQuality.hpp). Uplinks of a restored session are
+// confirmed until the server acks one, without ack the session is dropped
+// and the device joins again.
+static bool sendUplink(uint8_t length, uint8_t *data, uint8_t port)
+{
+  bool confirmed = sessionUnverified > 0 || link_confirm(&linkState, appConfig.confirmed);
+  bool success = LoRaWAN.send(length, data, port, confirmed);
+  session_update();
+  linkUp = success;
+
+  link_sent(&linkState, confirmed, success);
+  if (!appConfig.adr && link_adjust(&linkState, appConfig.datarate))
+  {
+    applyRadioConfig();
+  }
+
+  if (confirmed && success)
+  {
+    sessionUnverified = 0;
+  }
+  else if (sessionUnverified > 0 && --sessionUnverified == 0)
+  {
+    Serial.println("Restored session rejected");
+    session_clear();
+    join();
+    applyRadioConfig();
+  }
+  return success;
+}
+
+// Largest application payload at the current data rate
+static uint8_t maxPayloadSize()
+{
+  LoRaMacTxInfo_t txInfo;
+  LoRaMacQueryTxPossible(0, &txInfo);
+  return txInfo.MaxPossiblePayload < sizeof(compactFrame) ? txInfo.MaxPossiblePayload : sizeof(compactFrame);
+}
+
+// COMPACT_EXT_SPREAD value of the last sample in batch, returns its length
+static uint8_t spreadValue(uint8_t *value)
+{
+  const int32_t deviations[] = {batchSpread.temperature, batchSpread.humidity, batchSpread.pressure};
+  const uint8_t flags[] = {COMPACT_TEMPERATURE, COMPACT_HUMIDITY, COMPACT_PRESSURE};
+  uint8_t length = 0;
+  value[length++] = Sensors::fields;
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    if (Sensors::fields & flags[i])
+    {
+      value[length++] = deviations[i] >> 8;
+      value[length++] = deviations[i];
+    }
+  }
+  return length;
+}
+
+// samples: the frame carries at least one sample
+static CompactHeader compactHeader(uint16_t voltage, bool samples)
+{
+  CompactHeader header = {};
+  header.fields = Sensors::fields | COMPACT_BATTERY;
+  header.status = COMPACT_STATUS_OK;
+  header.interval = interval / 1000;
+  header.voltage = voltage;
+  header.extension = extension;
+  header.extensionLength = 0;
+  if (ackPending)
+  {
+    uint8_t ack[] = {commandAck.status, commandAck.tag, commandAck.count};
+    header.extensionLength = put_extension(extension, header.extensionLength, sizeof(extension),
+                                           COMPACT_EXT_ACK, ack, sizeof(ack));
+  }
+  if (sensorFailed)
+  {
+    header.status |= COMPACT_STATUS_SENSOR;
+  }
+  if (memcmp(&i2cCounters, &reportedCounters, sizeof(I2CCounters)) != 0)
+  {
+    uint8_t bus[] = {(uint8_t)(i2cCounters.errors >> 8), (uint8_t)i2cCounters.errors,
+                     (uint8_t)(i2cCounters.retries >> 8), (uint8_t)i2cCounters.retries,
+                     (uint8_t)(i2cCounters.failures >> 8), (uint8_t)i2cCounters.failures};
+    header.status |= COMPACT_STATUS_BUS;
+    header.extensionLength = put_extension(extension, header.extensionLength, sizeof(extension),
+                                           COMPACT_EXT_BUS, bus, sizeof(bus));
+  }
+  if (joinReportPending)
+  {
+    uint8_t attempts[] = {(uint8_t)(joinAttempts >> 8), (uint8_t)joinAttempts};
+    header.extensionLength = put_extension(extension, header.extensionLength, sizeof(extension),
+                                           COMPACT_EXT_JOIN, attempts, sizeof(attempts));
+  }
+  if (linkState.confirmed != reportedConfirmed)
+  {
+    int16_t rssi = link_rssi(&linkState);
+    uint8_t quality[] = {(uint8_t)(linkState.confirmed >> 8), (uint8_t)linkState.confirmed,
+                         (uint8_t)(linkState.acked >> 8), (uint8_t)linkState.acked,
+                         (uint8_t)link_margin(&linkState),
+                         (uint8_t)(rssi >> 8), (uint8_t)rssi,
+                         linkState.txPower};
+    header.extensionLength = put_extension(extension, header.extensionLength, sizeof(extension),
+                                           COMPACT_EXT_LINK, quality, sizeof(quality));
+  }
+  uint8_t percent = battery_percent(&batteryState);
+  uint16_t days = battery_days(&batteryState);
+  if (percent != reportedPercent || days != reportedDays)
+  {
+    uint8_t gauge[] = {percent, (uint8_t)(days >> 8), (uint8_t)days};
+    header.extensionLength = put_extension(extension, header.extensionLength, sizeof(extension),
+                                           COMPACT_EXT_BATTERY, gauge, sizeof(gauge));
+  }
+#if REPORT_SPREAD
+  if (samples && Sensors::fields)
+  {
+    uint8_t spread[7];
+    uint8_t length = spreadValue(spread);
+    header.extensionLength = put_extension(extension, header.extensionLength, sizeof(extension),
+                                           COMPACT_EXT_SPREAD, spread, length);
+  }
+#endif
+  return header;
+}
+
+// True if the batch plus sample still fits into one uplink
+static bool batchFits(const SensorSample *sample, uint16_t voltage)
+{
+  SampleBatch next = batch;
+  CompactHeader header = compactHeader(voltage, true);
+  return batch_add(&next, sample) && encode_compact(&header, &next, NULL, maxPayloadSize()) > 0;
+}
+
+// Store samples of a failed uplink, the last one was taken just now
+static void keepBacklog(const SensorSample *samples, uint8_t count)
+{
+  if (!(Sensors::fields & BACKLOG_FIELDS))
+  {
+    return;
+  }
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < count; i++)
+  {
+    backlog_push(&backlog, &samples[i], now - (count - 1 - i) * interval);
+  }
+  backlog_save(&backlog, false);
+}
+
+// One backlog frame per cycle while uplinks go out
+static void drainBacklog()
+{
+  if (!linkUp || backlog.count == 0)
+  {
+    return;
+  }
+
+  uint8_t count;
+  uint8_t length = backlog_encode(&backlog, Sensors::fields, millis(), compactFrame, maxPayloadSize(), &count);
+#ifdef DEBUG
+  printf("backlog frame: %d of %d samples, %d bytes\n", count, backlog.count, length);
+#endif
+  if (length > 0 && sendUplink(length, compactFrame, FPORT_BACKLOG))
+  {
+    backlog_drop(&backlog, count);
+    backlog_save(&backlog, true);
+  }
+}
+
+static bool sendCompact(uint16_t voltage)
+{
+  CompactHeader header = compactHeader(voltage, batch.count > 0);
+  uint8_t maxPayload = maxPayloadSize();
+
+  // the data rate may have dropped since the samples were collected
+  while (batch.count > 1 && encode_compact(&header, &batch, NULL, maxPayload) == 0)
+  {
+    memmove(&batch.samples[0], &batch.samples[1], --batch.count * sizeof(SensorSample));
+  }
+
+  uint8_t length = encode_compact(&header, &batch, compactFrame, maxPayload);
+#ifdef DEBUG
+  printf("compact frame: %d samples, %d bytes\n", batch.count, length);
+#endif
+  uint8_t count = batch.count;
+  batch.count = 0;
+
+  if (length == 0)
+  {
+    return false;
+  }
+  if (!sendUplink(length, compactFrame, FPORT_COMPACT))
+  {
+    // the samples are still in batch.samples
+    keepBacklog(batch.samples, count);
+    return false;
+  }
+  ackPending = false;
+  joinReportPending = false;
+  reportedCounters = i2cCounters;
+  reportedConfirmed = linkState.confirmed;
+  reportedPercent = battery_percent(&batteryState);
+  reportedDays = battery_days(&batteryState);
+  return true;
+}
+
+// Send the batch unless all samples are inside the deadband
+static bool flushBatch(uint16_t voltage)
 {
+  if (batch.count == 0)
+  {
+    return true;
+  }
+
+  if (!ackPending && !report_due(&reportState, &batch, millis()))
+  {
+#ifdef DEBUG
+    Serial.println("Inside deadband, uplink skipped");
+#endif
+    batch.count = 0;
+    return true;
+  }
+
+  SensorSample last = batch.samples[batch.count - 1];
+  bool success = sendCompact(voltage);
+  if (success)
+  {
+    report_sent(&reportState, &last, millis());
+  }
+  return success;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void setup()
+{
+  init_app_config();
+  interval = appConfig.sleeptime;
+  LoRaWAN.begin(CLASS_A, LORAMAC_REGION_EU868);
+  link_init(&linkState);
+#ifndef LEGACY_FRAME
+  backlog_open(&backlog, millis());
+#endif
+  applyRadioConfig();
+
+  if (session_restore())
+  {
+    Serial.println("SESSION RESTORED");
+    sessionUnverified = SESSION_CONFIRM_ATTEMPTS;
+    showBoardLED(0, 50, 0);
+    delay(2000);
+  }
+  else
+  {
+    join();
+  }
+  applyRadioConfig();
+  clearBoardLED();
+  power_release(POWER_UART);
+}
+
+// Measurement cycle //////////////////////////////////////////////////////////
+//
+// loop() runs one step per call. A step returns how long to wait before
+// the next one, the wait is spent in lowPowerHandler() with a timer
+// wake-up instead of delay().
+
+static CycleState cycleState = CYCLE_POWER_UP;
+static uint8_t iteration;
+static SensorSample sample;
+static SensorSample spread; // standard deviation behind sample
+static bool hasSample;
+static uint16_t voltage;
+
+static uint32_t cyclePowerUp()
+{
+  PROFILE_END(PROFILE_SLEEP);
   loopStart = millis();
+  power_acquire(POWER_UART);
+
+  if (configChanged)
+  {
+    configChanged = false;
+    applyRadioConfig();
+  }
 
 #ifdef DEBUG
   Serial.printf("\n*** Sending packet ***\n");
 #endif
 
-  txFrame.preamble = 0x5A;
-  txFrame.status = 0x01;
+  init_frame(&txFrame, 0x01);
+  memset(&sample, 0, sizeof(sample));
+  hasSample = true;
 
-#ifdef HAS_BME280
-  if (!bme.init())
+  if (!Sensors::fields)
   {
-    Serial.println("Could not find a valid BME280 sensor, check wiring, "
-                   "address, sensor ID!");
+    cycleState = CYCLE_BATTERY;
+    return 0;
   }
 
-  for (int i = 0; i < SENSOR_READ_ITERATIONS; i++)
+  power_acquire(POWER_I2C);
+  cycleState = CYCLE_SENSOR_INIT;
+  return POWER_SETTLE_TIME;
+}
+
+static uint32_t cycleSensorInit()
+{
+  PROFILE_BEGIN(PROFILE_SENSOR_INIT);
+  bool ready = Sensors::begin();
+  PROFILE_END(PROFILE_SENSOR_INIT);
+
+  if (!ready)
   {
-    if (i > 0)
-    {
-      delay(SENSOR_READ_ITERATION_DELAY);
-    }
-    txFrame.temperature = (bme.getTemperature() / 10) & 0xFFFF;
-    txFrame.humidity = (bme.getHumidity() / 10) & 0xFFFF;
-    txFrame.pressure = (((bme.getPressure() / 10) - 80000) & 0xFFFF);
+    // no conversions, the uplink reports the failure
+    Serial.println("Sensor init failed");
+    Sensors::end();
+    hasSample = false;
+    sensorFailed = true;
+    cycleState = CYCLE_BATTERY;
+    return 0;
+  }
+
+  samples.reset();
+  iteration = 0;
+  cycleState = CYCLE_CONVERT;
+  return 0;
+}
+
+static uint32_t cycleConvert()
+{
+  PROFILE_BEGIN(PROFILE_SENSOR_READ);
+  Sensors::start();
+  cycleState = CYCLE_READ;
+  return Sensors::conversionTime();
+}
+
+static uint32_t cycleRead()
+{
+  SensorSample s = {};
+  if (Sensors::read(&s))
+  {
+    samples.add(&s);
+  }
+  PROFILE_END(PROFILE_SENSOR_READ);
 #ifdef DEBUG
-    Serial.print(".");
-    Serial.flush();
+  Serial.print(".");
 #endif
+
+  if (++iteration < SENSOR_READ_ITERATIONS)
+  {
+    cycleState = CYCLE_CONVERT;
+    return 0;
   }
 
-  Wire.end();
+  Sensors::end();
   Serial.println();
 
+  hasSample = samples.size() > 0;
+  sensorFailed = samples.size() < SENSOR_READ_ITERATIONS;
+  sample = samples.aggregate(appConfig.aggregation);
+  spread = samples.deviation();
+
 #ifdef DEBUG
-  printf("temperature = %.02f°C [%d]\n", txFrame.temperature / 100.0, txFrame.temperature);
-  printf("humidity = %.02f%% [%d]\n", txFrame.humidity / 100.0, txFrame.humidity);
-  printf("pressure = %.02fhPa [%d]\n", (txFrame.pressure + 80000) / 100.0, txFrame.pressure);
+  printf("aggregation = %d\n", appConfig.aggregation);
+  samples.print();
+  Sensors::print(&sample);
 #endif
+
+#ifdef HAS_BME280
+  if (hasSample)
+  {
+    pack_sensor_data(&txFrame, sample.temperature, sample.humidity, sample.pressure);
+  }
 #endif
 
-  digitalWrite(Vext, HIGH);
-  delay(50);
+  cycleState = CYCLE_BATTERY;
+  return 0;
+}
 
-  txFrame.battery = (getBatteryVoltage() - 2000) / 10;
-  txFrame.crc8 = crc8((uint8_t *)&txFrame, sizeof(TxFrameData) - 1);
+static uint32_t cycleBattery()
+{
+  PROFILE_BEGIN(PROFILE_BATTERY);
+  if (Sensors::fields)
+  {
+    power_release(POWER_I2C);
+  }
+  cycleState = CYCLE_MEASURE_BATTERY;
+  return BATTERY_SETTLE_TIME;
+}
+
+static uint32_t cycleMeasureBattery()
+{
+  power_acquire(POWER_ADC);
+  battery_update(&batteryState, battery_measure(), millis());
+  power_release(POWER_ADC);
+  voltage = battery_voltage(&batteryState);
+  pack_battery(&txFrame, voltage);
+  PROFILE_END(PROFILE_BATTERY);
+  seal_frame(&txFrame);
 
 #ifdef DEBUG
-  printf("battery = %0.2fV\n", (txFrame.battery + 200) / 100.0);
+  printf("battery = %0.2fV, %d%%, %d days\n", (txFrame.battery + 200) / 100.0,
+         battery_percent(&batteryState), battery_days(&batteryState));
   printf("crc8 = %d\n", txFrame.crc8);
   printf("TxFrameData size = %d\n", sizeof(TxFrameData));
 #endif
 
-  bool success = LoRaWAN.send(sizeof(TxFrameData), (uint8_t *)&txFrame, 1, false);
+  cycleState = CYCLE_SEND;
+  return appConfig.senddelay;
+}
+
+static uint32_t cycleSend()
+{
+  bool success = true;
 
-#ifdef DEBUG
+#ifdef LEGACY_FRAME
+  PROFILE_BEGIN(PROFILE_SEND);
+  success = sendUplink(sizeof(TxFrameData), (uint8_t *)&txFrame, FPORT_FRAME);
+  PROFILE_END(PROFILE_SEND);
+#else
+  PROFILE_BEGIN(PROFILE_SEND);
+  if (hasSample && !batchFits(&sample, voltage))
+  {
+    // next sample would not fit into one uplink, send what we have
+    success = flushBatch(voltage);
+  }
+  if (hasSample)
+  {
+    batch_add(&batch, &sample);
+    batchSpread = spread;
+  }
+  if (batch.count >= appConfig.batchsize)
+  {
+    success = flushBatch(voltage);
+  }
+  else if (!hasSample)
+  {
+    // all reads failed, report status and battery now, with the pending
+    // samples or as a header only frame
+    success = sendCompact(voltage);
+  }
+#endif
+
+  uint32_t next = schedule_next(&schedulerState, hasSample ? &sample : NULL, loopStart, voltage);
+#ifndef LEGACY_FRAME
+  if (next != interval && batch.count > 0)
+  {
+    // a batch carries one interval, send the samples taken with the old one
+    success = flushBatch(voltage);
+  }
+  drainBacklog();
+  PROFILE_END(PROFILE_SEND);
+#endif
+  interval = next;
+
+  // like the join result, before the UART is released
   if (success)
   {
     Serial.println("Send OK");
@@ -167,10 +642,60 @@ void loop()
   {
     Serial.println("Send FAILED");
   }
-  delay(50);
-#endif
+  Serial.flush();
+
+  cycleState = CYCLE_SLEEP;
+  return 0;
+}
+
+static uint32_t cycleSleep()
+{
+  PROFILE_DUMP();
+  power_dump();
+  power_release(POWER_UART);
+  PROFILE_BEGIN(PROFILE_SLEEP);
+
+  uint32_t elapsed = millis() - loopStart;
+  cycleState = CYCLE_POWER_UP;
+  return elapsed < interval ? interval - elapsed : 1;
+}
+
+void loop()
+{
+  uint32_t wait = 0;
+
+  switch (cycleState)
+  {
+  case CYCLE_POWER_UP:
+    wait = cyclePowerUp();
+    break;
+  case CYCLE_SENSOR_INIT:
+    wait = cycleSensorInit();
+    break;
+  case CYCLE_CONVERT:
+    wait = cycleConvert();
+    break;
+  case CYCLE_READ:
+    wait = cycleRead();
+    break;
+  case CYCLE_BATTERY:
+    wait = cycleBattery();
+    break;
+  case CYCLE_MEASURE_BATTERY:
+    wait = cycleMeasureBattery();
+    break;
+  case CYCLE_SEND:
+    wait = cycleSend();
+    break;
+  case CYCLE_SLEEP:
+    wait = cycleSleep();
+    break;
+  }
 
-  lowPowerSleep(appConfig.sleeptime);
+  if (wait > 0)
+  {
+    lowPowerWait(wait);
+  }
 }
 
 void downLinkDataHandle(McpsIndication_t *mcpsIndication)
@@ -184,20 +709,17 @@ void downLinkDataHandle(McpsIndication_t *mcpsIndication)
   Serial.println();
 #endif
 
-  uint8_t *msg = mcpsIndication->Buffer;
+  link_downlink(&linkState, mcpsIndication->Rssi, (int8_t)mcpsIndication->Snr,
+                mcpsIndication->RxSlot, mcpsIndication->RxDatarate);
 
-  if (mcpsIndication->BufferSize == 6 && msg[0] == 0xa5 && msg[1] == 0x01)
+  if (mcpsIndication->Port == FPORT_COMMAND)
   {
-    uint32_t setSleeptime =
-        ((msg[2] << 24) + (msg[3] << 16) + (msg[4] << 8) + msg[5]);
-#ifdef DEBUG
-    printf("set sleeptime = %d\n", setSleeptime);
-#endif
-
-    if (setSleeptime <= 86400000) // one day
-    {
-      appConfig.sleeptime = setSleeptime;
-      write_config();
-    }
+    commandAck = handle_command_downlink(mcpsIndication->Buffer, mcpsIndication->BufferSize);
+    ackPending = true;
+    configChanged = commandAck.status == COMMAND_OK;
+  }
+  else if (handle_config_downlink(mcpsIndication->Buffer, mcpsIndication->BufferSize))
+  {
+    configChanged = true;
   }
 }
@@ -0,0 +1,94 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Host replacement of the CubeCell Arduino core, only what this
+// project uses. State is controlled through ArduinoFakes.h.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define ANALOG 3 // input buffer off, lowest leakage
+
+// Pin numbers, values are arbitrary on the host
+#define GPIO7 7
+#define Vext 20
+#define RGB 21
+#define ADC 22
+#define SDA 23
+#define SCL 24
+#define UART_RX 25
+#define UART_TX 26
+
+extern uint32_t millis();
+extern uint32_t micros();
+extern void delay(uint32_t ms);
+extern void pinMode(uint8_t pin, uint8_t mode);
+extern void digitalWrite(uint8_t pin, uint8_t value);
+extern int digitalRead(uint8_t pin);
+
+extern uint64_t getID();
+extern uint32_t cubecell_random(uint32_t max);
+extern uint16_t getBatteryVoltage();
+extern void lowPowerHandler();
+
+typedef struct TimerEvent_s
+{
+  uint32_t timestamp; // deadline in fake milliseconds
+  uint32_t value;     // period in milliseconds
+  bool running;
+  void (*callback)();
+} TimerEvent_t;
+
+extern void TimerInit(TimerEvent_t *obj, void (*callback)());
+extern void TimerSetValue(TimerEvent_t *obj, uint32_t value);
+extern void TimerStart(TimerEvent_t *obj);
+extern void TimerStop(TimerEvent_t *obj);
+
+class HardwareSerial
+{
+public:
+  void begin(unsigned long baud) { this->baud = baud; }
+  void end() { baud = 0; }
+  void flush() {}
+  size_t print(const char *s) { return printf("%s", s); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t println(const char *s = "") { return printf("%s\n", s); }
+  size_t println(int v) { return printf("%d\n", v); }
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+  {
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n;
+  }
+
+  // test interface
+  unsigned long baud = 0; // 0 while ended
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,497 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ArduinoFakes.h"
+
+HardwareSerial Serial;
+TwoWire Wire;
+EEPROMClass EEPROM;
+LoRaWanMinimal LoRaWAN;
+// defined by the application on the device, see src/main.cpp
+uint16_t userChannelsMask[6] = {0x00FF, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000};
+
+namespace fake
+{
+  uint32_t clock = 0;
+  uint16_t batteryVoltage = 3700;
+  uint16_t batteryNoise = 0;
+  uint32_t batteryReads = 0;
+  uint64_t chipID = 0x0000123456789ABCULL;
+  uint8_t pins[32];
+  uint8_t inputs[32];
+  uint8_t modes[32];
+
+  static const int MAX_TIMERS = 8;
+  static TimerEvent_t *timers[MAX_TIMERS];
+  static uint32_t randomState = 1;
+
+  void reset()
+  {
+    clock = 0;
+    batteryVoltage = 3700;
+    batteryNoise = 0;
+    batteryReads = 0;
+    randomState = 1;
+    memset(pins, 0, sizeof(pins));
+    memset(inputs, HIGH, sizeof(inputs));
+    memset(modes, INPUT, sizeof(modes));
+    memset(timers, 0, sizeof(timers));
+    memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+    EEPROM.commits = 0;
+    EEPROM.writes = 0;
+    Wire.detachAll();
+    Wire.enabled = false;
+    Serial.baud = 0;
+    LoRaWAN = LoRaWanMinimal();
+    userChannelsMask[0] = 0x00FF;
+  }
+}
+
+// Arduino core ///////////////////////////////////////////////////////////////
+
+uint32_t millis()
+{
+  return fake::clock;
+}
+
+uint32_t micros()
+{
+  return fake::clock * 1000;
+}
+
+void delay(uint32_t ms)
+{
+  fake::clock += ms;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  fake::modes[pin & 31] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  fake::pins[pin & 31] = value;
+}
+
+int digitalRead(uint8_t pin)
+{
+  return fake::inputs[pin & 31];
+}
+
+uint64_t getID()
+{
+  return fake::chipID;
+}
+
+uint32_t cubecell_random(uint32_t max)
+{
+  // deterministic LCG, good enough for keys in tests
+  fake::randomState = fake::randomState * 1103515245 + 12345;
+  return max ? (fake::randomState >> 8) % max : 0;
+}
+
+uint16_t getBatteryVoltage()
+{
+  fake::batteryReads++;
+  return fake::batteryReads & 1 ? fake::batteryVoltage + fake::batteryNoise
+                                : fake::batteryVoltage - fake::batteryNoise;
+}
+
+// Jump to the earliest running timer and fire it
+void lowPowerHandler()
+{
+  TimerEvent_t *next = NULL;
+  for (int i = 0; i < fake::MAX_TIMERS; i++)
+  {
+    TimerEvent_t *t = fake::timers[i];
+    if (t && t->running && (!next || (int32_t)(t->timestamp - next->timestamp) < 0))
+    {
+      next = t;
+    }
+  }
+  if (!next)
+  {
+    return;
+  }
+  if ((int32_t)(next->timestamp - fake::clock) > 0)
+  {
+    fake::clock = next->timestamp;
+  }
+  next->running = false;
+  if (next->callback)
+  {
+    next->callback();
+  }
+}
+
+void TimerInit(TimerEvent_t *obj, void (*callback)())
+{
+  obj->timestamp = 0;
+  obj->value = 0;
+  obj->running = false;
+  obj->callback = callback;
+
+  for (int i = 0; i < fake::MAX_TIMERS; i++)
+  {
+    if (fake::timers[i] == obj)
+    {
+      return;
+    }
+  }
+  for (int i = 0; i < fake::MAX_TIMERS; i++)
+  {
+    if (!fake::timers[i])
+    {
+      fake::timers[i] = obj;
+      return;
+    }
+  }
+}
+
+void TimerSetValue(TimerEvent_t *obj, uint32_t value)
+{
+  obj->value = value;
+}
+
+void TimerStart(TimerEvent_t *obj)
+{
+  obj->timestamp = fake::clock + obj->value;
+  obj->running = true;
+}
+
+void TimerStop(TimerEvent_t *obj)
+{
+  obj->running = false;
+}
+
+// Wire ///////////////////////////////////////////////////////////////////////
+
+void TwoWire::attach(int address, FakeI2CDevice *device)
+{
+  for (int i = 0; i < MAX_DEVICES; i++)
+  {
+    if (!devices[i] || addresses[i] == address)
+    {
+      addresses[i] = address;
+      devices[i] = device;
+      return;
+    }
+  }
+}
+
+void TwoWire::detachAll()
+{
+  memset(devices, 0, sizeof(devices));
+  transactions = 0;
+  txLength = 0;
+  rxLength = 0;
+  rxIndex = 0;
+}
+
+FakeI2CDevice *TwoWire::find(int address)
+{
+  for (int i = 0; i < MAX_DEVICES; i++)
+  {
+    if (devices[i] && addresses[i] == address)
+    {
+      return devices[i];
+    }
+  }
+  return NULL;
+}
+
+void TwoWire::beginTransmission(int address)
+{
+  txAddress = address;
+  txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+  if (txLength >= BUFFER_SIZE)
+  {
+    return 0;
+  }
+  txBuffer[txLength++] = value;
+  return 1;
+}
+
+// 0 = success, 2 = NACK on address, 3 = NACK on data
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+  transactions++;
+  FakeI2CDevice *device = find(txAddress);
+  if (!device)
+  {
+    return 2;
+  }
+  return device->receive(txBuffer, txLength) ? 0 : 3;
+}
+
+uint8_t TwoWire::requestFrom(int address, int quantity)
+{
+  transactions++;
+  rxIndex = 0;
+  rxLength = 0;
+  FakeI2CDevice *device = find(address);
+  if (!device || quantity <= 0)
+  {
+    return 0;
+  }
+  if (quantity > BUFFER_SIZE)
+  {
+    quantity = BUFFER_SIZE;
+  }
+  rxLength = device->transmit(rxBuffer, quantity);
+  return rxLength;
+}
+
+int TwoWire::available()
+{
+  return rxLength - rxIndex;
+}
+
+int TwoWire::read()
+{
+  return rxIndex < rxLength ? rxBuffer[rxIndex++] : -1;
+}
+
+// LoRaWAN ////////////////////////////////////////////////////////////////////
+
+// RegionEU868AlternateDr
+static int8_t alternateDr(uint8_t trial)
+{
+  if (trial % 48 == 0)
+  {
+    return 0;
+  }
+  if (trial % 32 == 0)
+  {
+    return 1;
+  }
+  if (trial % 24 == 0)
+  {
+    return 2;
+  }
+  if (trial % 16 == 0)
+  {
+    return 3;
+  }
+  return trial % 8 == 0 ? 4 : 5;
+}
+
+LoRaMacStatus_t LoRaMacMlmeRequest(MlmeReq_t *mlmeRequest)
+{
+  if (mlmeRequest->Type != MLME_JOIN || mlmeRequest->Req.Join.NbTrials == 0)
+  {
+    return LORAMAC_STATUS_PARAMETER_INVALID;
+  }
+  LoRaWanMinimal &mac = LoRaWAN;
+  mac.joinAttempts++;
+  mac.joinNbTrials = mlmeRequest->Req.Join.NbTrials;
+  mac.joinChannelsMask = mac.channelsMask;
+  mac.joined = false;
+  for (uint8_t trial = 1; trial <= mlmeRequest->Req.Join.NbTrials && !mac.joined; trial++)
+  {
+    mac.joinTrials++;
+    mac.datarate = alternateDr(trial);
+    mac.joinDatarate = mac.datarate;
+    mac.joined = mac.joinResult && trial > mac.joinLostTrials;
+  }
+  if (mac.joined)
+  {
+    // new session, keys derived from the attempt number
+    mac.devAddr = 0x26010000 + mac.joinAttempts;
+    memset(mac.nwkSKey, 0x10 + mac.joinAttempts, sizeof(mac.nwkSKey));
+    memset(mac.appSKey, 0x20 + mac.joinAttempts, sizeof(mac.appSKey));
+    mac.uplinkCounter = 0;
+    mac.downlinkCounter = 0;
+    mac.receiveDelay1 = 5000;
+    mac.receiveDelay2 = 6000;
+    mac.rx2Channel.Datarate = 3;
+    for (uint8_t i = 0; i < 5; i++)
+    {
+      mac.channels[3 + i] = {(uint32_t)(867100000 + i * 200000), 0, {0x50}, 0};
+    }
+  }
+  return LORAMAC_STATUS_OK;
+}
+
+bool LoRaWanMinimal::joinOTAA(uint8_t *appEui, uint8_t *appKey, uint8_t *devEui)
+{
+  MlmeReq_t mlme;
+  mlme.Type = MLME_JOIN;
+  mlme.Req.Join.DevEui = devEui;
+  mlme.Req.Join.AppEui = appEui;
+  mlme.Req.Join.AppKey = appKey;
+  mlme.Req.Join.NbTrials = 1;
+  LoRaMacMlmeRequest(&mlme);
+  return joined;
+}
+
+bool LoRaWanMinimal::joinABP(uint8_t *nwkSKey, uint8_t *appSKey, uint32_t devAddr)
+{
+  abpJoins++;
+  this->devAddr = devAddr;
+  memcpy(this->nwkSKey, nwkSKey, sizeof(this->nwkSKey));
+  memcpy(this->appSKey, appSKey, sizeof(this->appSKey));
+  uplinkCounter = 0;
+  downlinkCounter = 0;
+  joined = true;
+  return true;
+}
+
+LoRaMacStatus_t LoRaMacMibGetRequestConfirm(MibRequestConfirm_t *mibGet)
+{
+  switch (mibGet->Type)
+  {
+  case MIB_ADR:
+    mibGet->Param.AdrEnable = LoRaWAN.adaptiveDR;
+    break;
+  case MIB_DEV_ADDR:
+    mibGet->Param.DevAddr = LoRaWAN.devAddr;
+    break;
+  case MIB_NWK_SKEY:
+    if (!LoRaWAN.keysReadable)
+    {
+      return LORAMAC_STATUS_SERVICE_UNKNOWN;
+    }
+    mibGet->Param.NwkSKey = LoRaWAN.nwkSKey;
+    break;
+  case MIB_APP_SKEY:
+    if (!LoRaWAN.keysReadable)
+    {
+      return LORAMAC_STATUS_SERVICE_UNKNOWN;
+    }
+    mibGet->Param.AppSKey = LoRaWAN.appSKey;
+    break;
+  case MIB_CHANNELS:
+    mibGet->Param.ChannelList = LoRaWAN.channels;
+    break;
+  case MIB_CHANNELS_DATARATE:
+    mibGet->Param.ChannelsDatarate = LoRaWAN.datarate;
+    break;
+  case MIB_CHANNELS_MASK:
+    mibGet->Param.ChannelsMask = &LoRaWAN.channelsMask;
+    break;
+  case MIB_UPLINK_COUNTER:
+    mibGet->Param.UpLinkCounter = LoRaWAN.uplinkCounter;
+    break;
+  case MIB_DOWNLINK_COUNTER:
+    mibGet->Param.DownLinkCounter = LoRaWAN.downlinkCounter;
+    break;
+  case MIB_RECEIVE_DELAY_1:
+    mibGet->Param.ReceiveDelay1 = LoRaWAN.receiveDelay1;
+    break;
+  case MIB_RECEIVE_DELAY_2:
+    mibGet->Param.ReceiveDelay2 = LoRaWAN.receiveDelay2;
+    break;
+  case MIB_RX2_CHANNEL:
+    mibGet->Param.Rx2Channel = LoRaWAN.rx2Channel;
+    break;
+  default:
+    return LORAMAC_STATUS_SERVICE_UNKNOWN;
+  }
+  return LORAMAC_STATUS_OK;
+}
+
+LoRaMacStatus_t LoRaMacMibSetRequestConfirm(MibRequestConfirm_t *mibSet)
+{
+  switch (mibSet->Type)
+  {
+  case MIB_ADR:
+    LoRaWAN.adaptiveDR = mibSet->Param.AdrEnable;
+    break;
+  case MIB_DEV_ADDR:
+    LoRaWAN.devAddr = mibSet->Param.DevAddr;
+    break;
+  case MIB_NWK_SKEY:
+    memcpy(LoRaWAN.nwkSKey, mibSet->Param.NwkSKey, sizeof(LoRaWAN.nwkSKey));
+    break;
+  case MIB_APP_SKEY:
+    memcpy(LoRaWAN.appSKey, mibSet->Param.AppSKey, sizeof(LoRaWAN.appSKey));
+    break;
+  case MIB_CHANNELS_DATARATE:
+    if (mibSet->Param.ChannelsDatarate < 0 || mibSet->Param.ChannelsDatarate > 5)
+    {
+      return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    LoRaWAN.datarate = mibSet->Param.ChannelsDatarate;
+    break;
+  case MIB_CHANNELS_MASK:
+    if (mibSet->Param.ChannelsMask[0] == 0)
+    {
+      return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    LoRaWAN.channelsMask = mibSet->Param.ChannelsMask[0];
+    break;
+  case MIB_CHANNELS_TX_POWER:
+    if (mibSet->Param.ChannelsTxPower < 0 || mibSet->Param.ChannelsTxPower > 7)
+    {
+      return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    LoRaWAN.txPower = mibSet->Param.ChannelsTxPower;
+    break;
+  case MIB_UPLINK_COUNTER:
+    LoRaWAN.uplinkCounter = mibSet->Param.UpLinkCounter;
+    break;
+  case MIB_DOWNLINK_COUNTER:
+    LoRaWAN.downlinkCounter = mibSet->Param.DownLinkCounter;
+    break;
+  case MIB_RECEIVE_DELAY_1:
+    LoRaWAN.receiveDelay1 = mibSet->Param.ReceiveDelay1;
+    break;
+  case MIB_RECEIVE_DELAY_2:
+    LoRaWAN.receiveDelay2 = mibSet->Param.ReceiveDelay2;
+    break;
+  case MIB_RX2_CHANNEL:
+    LoRaWAN.rx2Channel = mibSet->Param.Rx2Channel;
+    break;
+  default:
+    return LORAMAC_STATUS_SERVICE_UNKNOWN;
+  }
+  return LORAMAC_STATUS_OK;
+}
+
+// Channels 0 .. 2 are the EU868 default channels and cannot be changed
+LoRaMacStatus_t LoRaMacChannelAdd(uint8_t id, ChannelParams_t params)
+{
+  if (id < 3 || id >= LORA_MAX_NB_CHANNELS || params.Frequency == 0)
+  {
+    return LORAMAC_STATUS_PARAMETER_INVALID;
+  }
+  LoRaWAN.channels[id] = params;
+  return LORAMAC_STATUS_OK;
+}
+
+LoRaMacStatus_t LoRaMacQueryTxPossible(uint8_t size, LoRaMacTxInfo_t *txInfo)
+{
+  txInfo->MaxPossiblePayload = LoRaWAN.maxPayload;
+  txInfo->CurrentPayloadSize = LoRaWAN.maxPayload;
+  return size <= LoRaWAN.maxPayload ? LORAMAC_STATUS_OK : LORAMAC_STATUS_LENGTH_ERROR;
+}
+
+bool LoRaWanMinimal::send(uint8_t datalen, uint8_t *datapointer, uint8_t fport, bool confirmed)
+{
+  sendCount++;
+  lastPort = fport;
+  lastConfirmed = confirmed;
+  lastLength = datalen;
+  memcpy(lastFrame, datapointer, datalen);
+  uplinkCounter++;
+  return sendResult;
+}
@@ -0,0 +1,36 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <Wire.h>
+#include <EEPROM.h>
+#include <LoRaWanMinimal_APP.h>
+
+// Control surface of the host fakes for unit tests
+namespace fake
+{
+  extern uint32_t clock;          // milliseconds since start
+  extern uint16_t batteryVoltage; // returned by getBatteryVoltage()
+  extern uint16_t batteryNoise;   // added to and subtracted from every other reading
+  extern uint32_t batteryReads;   // getBatteryVoltage() calls
+  extern uint64_t chipID;         // returned by getID()
+  extern uint8_t pins[32];        // last digitalWrite() value per pin
+  extern uint8_t inputs[32];      // digitalRead() value per pin
+  extern uint8_t modes[32];       // last pinMode() per pin
+
+  // Restore clock, pins, EEPROM (0xFF), bus, serial and radio to power-on state
+  extern void reset();
+}
@@ -0,0 +1,38 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class CubeCell_NeoPixel
+{
+public:
+  CubeCell_NeoPixel(uint16_t n, uint8_t pin, uint16_t type) {}
+  void begin() {}
+  void clear() { color = 0; }
+  void show() { shown = color; }
+  void setPixelColor(uint16_t n, uint32_t c) { color = c; }
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b)
+  {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+
+  // test interface
+  uint32_t color = 0;
+  uint32_t shown = 0; // color at the last show()
+};
@@ -0,0 +1,44 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+#define FAKE_EEPROM_SIZE 512
+
+class EEPROMClass
+{
+public:
+  void begin(size_t size) {}
+  void end() {}
+  uint8_t read(int address) { return data[address]; }
+  void write(int address, uint8_t value)
+  {
+    writes++;
+    data[address] = value;
+  }
+  bool commit()
+  {
+    commits++;
+    return true;
+  }
+
+  // test interface
+  uint8_t data[FAKE_EEPROM_SIZE];
+  uint32_t commits = 0;
+  uint32_t writes = 0; // bytes written
+};
+
+extern EEPROMClass EEPROM;
@@ -0,0 +1,318 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <ArduinoFakes.h>
+#include "FakeBME280.h"
+
+#define REG_CHIPID 0xD0
+#define REG_RESET 0xE0
+#define REG_CTRL_HUM 0xF2
+#define REG_STATUS 0xF3
+#define REG_CTRL_MEAS 0xF4
+#define REG_DATA 0xF7
+
+const uint8_t FakeBME280::DATASHEET_CALIBRATION[FAKE_BME280_CALIBRATION_LENGTH] = {
+    // dig_T1..T3
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC,
+    // dig_P1..P9
+    0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B, 0x27, 0x0B, 0x8C, 0x00,
+    0xF9, 0xFF, 0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17,
+    // 0xA0, dig_H1
+    0x00, 0x4B,
+    // dig_H2, dig_H3, dig_H4/H5, dig_H6
+    0x6A, 0x01, 0x00, 0x13, 0x29, 0x03, 0x1E};
+
+FakeBME280::FakeBME280(const uint8_t *calibration)
+{
+  memset(registers, 0, sizeof(registers));
+  memset(result, 0, sizeof(result));
+  registers[REG_CHIPID] = 0x60;
+  setCalibration(calibration);
+  set(25.0, 50.0, 101325.0);
+  // the chip powers up with all ADC outputs at 0x80000 / 0x8000
+  registers[REG_DATA] = 0x80;
+  registers[REG_DATA + 3] = 0x80;
+  registers[REG_DATA + 6] = 0x80;
+}
+
+void FakeBME280::setCalibration(const uint8_t *calibration)
+{
+  memcpy(registers + 0x88, calibration, 26);
+  memcpy(registers + 0xE1, calibration + 26, 7);
+}
+
+void FakeBME280::set(double temperature, double humidity, double pressure)
+{
+  FakeBME280Point p = {0, temperature, humidity, pressure};
+  setTrace(&p, 1);
+}
+
+void FakeBME280::setTrace(const FakeBME280Point *points, int count)
+{
+  traceLength = count > MAX_POINTS ? MAX_POINTS : count;
+  memcpy(trace, points, traceLength * sizeof(FakeBME280Point));
+}
+
+void FakeBME280::resetCounters()
+{
+  transactions = 0;
+  bytesWritten = 0;
+  bytesRead = 0;
+  conversions = 0;
+  nacks = 0;
+}
+
+bool FakeBME280::fault()
+{
+  transactions++;
+  if (nackNext > 0)
+  {
+    nackNext--;
+    nacks++;
+    return true;
+  }
+  if (nackEvery > 0 && transactions % nackEvery == 0)
+  {
+    nacks++;
+    return true;
+  }
+  return false;
+}
+
+bool FakeBME280::receive(const uint8_t *data, size_t length)
+{
+  if (fault())
+  {
+    return false;
+  }
+  bytesWritten += length;
+  update();
+
+  if (length > 0)
+  {
+    pointer = data[0];
+  }
+  for (size_t i = 1; i < length; i++)
+  {
+    uint8_t reg = pointer++;
+    if (reg == REG_RESET && data[i] == 0xB6)
+    {
+      converting = false;
+      registers[REG_CTRL_HUM] = 0;
+      registers[REG_CTRL_MEAS] = 0;
+    }
+    else if (reg == REG_CTRL_HUM || reg == REG_CTRL_MEAS || reg == 0xF5)
+    {
+      registers[reg] = data[i];
+    }
+    // forced mode (01 or 10) starts one conversion
+    if (reg == REG_CTRL_MEAS && (data[i] & 0x03) && (data[i] & 0x03) != 0x03)
+    {
+      FakeBME280Point p = sample();
+      int32_t adc_T = rawTemperature(p.temperature);
+      int32_t adc_P = rawPressure(p.pressure, p.temperature);
+      int32_t adc_H = rawHumidity(p.humidity, p.temperature);
+      result[0] = adc_P >> 12;
+      result[1] = (adc_P >> 4) & 0xFF;
+      result[2] = (adc_P & 0x0F) << 4;
+      result[3] = adc_T >> 12;
+      result[4] = (adc_T >> 4) & 0xFF;
+      result[5] = (adc_T & 0x0F) << 4;
+      result[6] = adc_H >> 8;
+      result[7] = adc_H & 0xFF;
+      converting = true;
+      conversionEnd = fake::clock + measurementTime();
+      conversions++;
+    }
+  }
+  return true;
+}
+
+size_t FakeBME280::transmit(uint8_t *data, size_t length)
+{
+  if (fault())
+  {
+    return 0;
+  }
+  update();
+
+  if (shortReadNext > 0 && length > 0)
+  {
+    shortReadNext--;
+    length--;
+  }
+  for (size_t i = 0; i < length; i++)
+  {
+    data[i] = registers[pointer++];
+  }
+  bytesRead += length;
+  return length;
+}
+
+// Publish the result and fall back to sleep mode once the conversion is done
+void FakeBME280::update()
+{
+  if (converting && (int32_t)(fake::clock - conversionEnd) >= 0)
+  {
+    converting = false;
+    memcpy(registers + REG_DATA, result, sizeof(result));
+    registers[REG_CTRL_MEAS] &= ~0x03;
+  }
+  registers[REG_STATUS] = converting ? 0x08 : 0x00;
+}
+
+FakeBME280Point FakeBME280::sample() const
+{
+  uint32_t now = fake::clock;
+  if (traceLength == 0)
+  {
+    FakeBME280Point p = {now, 25.0, 50.0, 101325.0};
+    return p;
+  }
+  if (now <= trace[0].time)
+  {
+    return trace[0];
+  }
+  for (int i = 1; i < traceLength; i++)
+  {
+    if (now < trace[i].time)
+    {
+      const FakeBME280Point &a = trace[i - 1];
+      const FakeBME280Point &b = trace[i];
+      double f = (double)(now - a.time) / (double)(b.time - a.time);
+      FakeBME280Point p = {now,
+                           a.temperature + f * (b.temperature - a.temperature),
+                           a.humidity + f * (b.humidity - a.humidity),
+                           a.pressure + f * (b.pressure - a.pressure)};
+      return p;
+    }
+  }
+  return trace[traceLength - 1];
+}
+
+// Typical measurement time of the datasheet, chapter 9.1, in ms
+uint32_t FakeBME280::measurementTime() const
+{
+  uint8_t osrs_t = registers[REG_CTRL_MEAS] >> 5;
+  uint8_t osrs_p = (registers[REG_CTRL_MEAS] >> 2) & 0x07;
+  uint8_t osrs_h = registers[REG_CTRL_HUM] & 0x07;
+  double t = 1.0;
+  t += osrs_t ? 2.0 * (1 << ((osrs_t > 5 ? 5 : osrs_t) - 1)) : 0;
+  t += osrs_p ? 2.0 * (1 << ((osrs_p > 5 ? 5 : osrs_p) - 1)) + 0.5 : 0;
+  t += osrs_h ? 2.0 * (1 << ((osrs_h > 5 ? 5 : osrs_h) - 1)) + 0.5 : 0;
+  return (uint32_t)(t + 0.999);
+}
+
+// The compensation is monotonic in each raw value, find the raw value by
+// bisection: temperature and humidity rise with it, pressure falls.
+
+int32_t FakeBME280::rawTemperature(double temperature) const
+{
+  int32_t lo = 0, hi = 0xFFFFF;
+  while (lo < hi)
+  {
+    int32_t mid = (lo + hi) / 2;
+    if (tFine(mid) / 5120.0 < temperature)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+int32_t FakeBME280::rawPressure(double p, double temperature) const
+{
+  double t_fine = tFine(rawTemperature(temperature));
+  int32_t lo = 0, hi = 0xFFFFF;
+  while (lo < hi)
+  {
+    int32_t mid = (lo + hi) / 2;
+    if (pressure(mid, t_fine) > p)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+int32_t FakeBME280::rawHumidity(double h, double temperature) const
+{
+  double t_fine = tFine(rawTemperature(temperature));
+  int32_t lo = 0, hi = 0xFFFF;
+  while (lo < hi)
+  {
+    int32_t mid = (lo + hi) / 2;
+    if (humidity(mid, t_fine) < h)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static uint16_t u16(const uint8_t *r, uint8_t reg)
+{
+  return r[reg] | (r[reg + 1] << 8);
+}
+
+static int16_t s16(const uint8_t *r, uint8_t reg)
+{
+  return (int16_t)u16(r, reg);
+}
+
+double FakeBME280::tFine(int32_t adc_T) const
+{
+  double T1 = u16(registers, 0x88), T2 = s16(registers, 0x8A), T3 = s16(registers, 0x8C);
+  double var1 = (adc_T / 16384.0 - T1 / 1024.0) * T2;
+  double var2 = (adc_T / 131072.0 - T1 / 8192.0) * (adc_T / 131072.0 - T1 / 8192.0) * T3;
+  return var1 + var2;
+}
+
+double FakeBME280::pressure(int32_t adc_P, double t_fine) const
+{
+  double P1 = u16(registers, 0x8E), P2 = s16(registers, 0x90), P3 = s16(registers, 0x92);
+  double P4 = s16(registers, 0x94), P5 = s16(registers, 0x96), P6 = s16(registers, 0x98);
+  double P7 = s16(registers, 0x9A), P8 = s16(registers, 0x9C), P9 = s16(registers, 0x9E);
+
+  double var1 = t_fine / 2.0 - 64000.0;
+  double var2 = var1 * var1 * P6 / 32768.0;
+  var2 = var2 + var1 * P5 * 2.0;
+  var2 = var2 / 4.0 + P4 * 65536.0;
+  var1 = (P3 * var1 * var1 / 524288.0 + P2 * var1) / 524288.0;
+  var1 = (1.0 + var1 / 32768.0) * P1;
+  if (var1 == 0.0)
+  {
+    return 0;
+  }
+  double p = 1048576.0 - adc_P;
+  p = (p - var2 / 4096.0) * 6250.0 / var1;
+  var1 = P9 * p * p / 2147483648.0;
+  var2 = p * P8 / 32768.0;
+  return p + (var1 + var2 + P7) / 16.0;
+}
+
+double FakeBME280::humidity(int32_t adc_H, double t_fine) const
+{
+  double H1 = registers[0xA1], H2 = s16(registers, 0xE1), H3 = registers[0xE3];
+  double H4 = (int16_t)((int8_t)registers[0xE4] * 16) | (registers[0xE5] & 0x0F);
+  double H5 = (int16_t)((int8_t)registers[0xE6] * 16) | (registers[0xE5] >> 4);
+  double H6 = (int8_t)registers[0xE7];
+
+  double h = t_fine - 76800.0;
+  h = (adc_H - (H4 * 64.0 + H5 / 16384.0 * h)) *
+      (H2 / 65536.0 * (1.0 + H6 / 67108864.0 * h * (1.0 + H3 / 67108864.0 * h)));
+  h = h * (1.0 - H1 * h / 524288.0);
+  return h < 0.0 ? 0.0 : (h > 100.0 ? 100.0 : h);
+}
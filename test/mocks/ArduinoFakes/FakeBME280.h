@@ -0,0 +1,95 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Wire.h>
+
+// Register level BME280 model behind the fake TwoWire.
+//
+// The physical values come from a trace of points, linearly interpolated
+// over fake::clock. A forced conversion samples the trace, converts it
+// back to raw ADC values with the datasheet floating point formulas and
+// the configured calibration, and publishes them when the conversion
+// time has passed. NACKs and short reads can be injected per
+// transaction, every transaction and byte is counted.
+
+typedef struct
+{
+  uint32_t time;      // fake::clock in ms
+  double temperature; // C
+  double humidity;    // %
+  double pressure;    // Pa
+} FakeBME280Point;
+
+// 0x88..0xA1 followed by 0xE1..0xE7, the layout the chip has
+#define FAKE_BME280_CALIBRATION_LENGTH 33
+
+class FakeBME280 : public FakeI2CDevice
+{
+public:
+  // Bosch datasheet example, humidity coefficients of a typical part
+  static const uint8_t DATASHEET_CALIBRATION[FAKE_BME280_CALIBRATION_LENGTH];
+
+  static const int MAX_POINTS = 16;
+
+  uint8_t registers[256];
+  uint8_t pointer = 0;
+
+  // counters, reset with resetCounters()
+  uint32_t transactions = 0; // addressed writes and reads, NACKed ones included
+  uint32_t bytesWritten = 0; // including the register address
+  uint32_t bytesRead = 0;
+  uint32_t conversions = 0;
+  uint32_t nacks = 0;
+
+  // fault injection, counted down per transaction
+  uint32_t nackNext = 0;       // NACK the next n transactions
+  uint32_t shortReadNext = 0;  // deliver one byte less on the next n reads
+  uint32_t nackEvery = 0;      // NACK every n-th transaction, 0 = never
+
+  FakeBME280(const uint8_t *calibration = DATASHEET_CALIBRATION);
+
+  void setCalibration(const uint8_t *calibration);
+  // constant environment
+  void set(double temperature, double humidity, double pressure);
+  // time series, points sorted by time
+  void setTrace(const FakeBME280Point *points, int count);
+  void resetCounters();
+
+  // raw ADC values for the given physical values
+  int32_t rawTemperature(double temperature) const;
+  int32_t rawPressure(double pressure, double temperature) const;
+  int32_t rawHumidity(double humidity, double temperature) const;
+
+  bool receive(const uint8_t *data, size_t length) override;
+  size_t transmit(uint8_t *data, size_t length) override;
+
+private:
+  FakeBME280Point trace[MAX_POINTS];
+  int traceLength = 0;
+  uint32_t conversionEnd = 0;
+  bool converting = false;
+  uint8_t result[8];
+
+  bool fault();
+  void update();
+  FakeBME280Point sample() const;
+  uint32_t measurementTime() const;
+
+  // datasheet chapter 8.1, floating point compensation
+  double tFine(int32_t adc_T) const;
+  double pressure(int32_t adc_P, double t_fine) const;
+  double humidity(int32_t adc_H, double t_fine) const;
+};
@@ -0,0 +1,221 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+#include <CubeCell_NeoPixel.h>
+
+typedef enum
+{
+  CLASS_A,
+  CLASS_B,
+  CLASS_C,
+} DeviceClass_t;
+
+typedef enum
+{
+  LORAMAC_REGION_EU868 = 5,
+} LoRaMacRegion_t;
+
+// Subset of the LoRaMac downlink indication
+typedef struct
+{
+  uint8_t Port;
+  uint8_t RxDatarate;
+  uint8_t FramePending;
+  uint8_t *Buffer;
+  uint8_t BufferSize;
+  bool RxData;
+  int16_t Rssi;
+  uint8_t Snr;
+  uint8_t RxSlot;
+  bool AckReceived;
+  uint32_t DownLinkCounter;
+} McpsIndication_t;
+
+typedef enum
+{
+  LORAMAC_STATUS_OK = 0,
+  LORAMAC_STATUS_BUSY = 1,
+  LORAMAC_STATUS_SERVICE_UNKNOWN = 2,
+  LORAMAC_STATUS_PARAMETER_INVALID = 3,
+  LORAMAC_STATUS_LENGTH_ERROR = 8,
+} LoRaMacStatus_t;
+
+typedef struct
+{
+  uint8_t MaxPossiblePayload;
+  uint8_t CurrentPayloadSize;
+} LoRaMacTxInfo_t;
+
+extern LoRaMacStatus_t LoRaMacQueryTxPossible(uint8_t size, LoRaMacTxInfo_t *txInfo);
+
+typedef union
+{
+  int8_t Value;
+  struct
+  {
+    int8_t Min : 4;
+    int8_t Max : 4;
+  } Fields;
+} DrRange_t;
+
+typedef struct
+{
+  uint32_t Frequency;    // Hz, 0 = unused
+  uint32_t Rx1Frequency; // Hz, 0 = same as Frequency
+  DrRange_t DrRange;
+  uint8_t Band;
+} ChannelParams_t;
+
+typedef struct
+{
+  uint32_t Frequency;
+  uint8_t Datarate;
+} Rx2ChannelParams_t;
+
+#define LORA_MAX_NB_CHANNELS 16
+
+extern LoRaMacStatus_t LoRaMacChannelAdd(uint8_t id, ChannelParams_t params);
+
+// Subset of the LoRaMac information base
+typedef enum
+{
+  MIB_ADR,
+  MIB_DEV_ADDR,
+  MIB_NWK_SKEY,
+  MIB_APP_SKEY,
+  MIB_CHANNELS,
+  MIB_CHANNELS_DATARATE,
+  MIB_CHANNELS_MASK,
+  MIB_CHANNELS_TX_POWER,
+  MIB_UPLINK_COUNTER,
+  MIB_DOWNLINK_COUNTER,
+  MIB_RECEIVE_DELAY_1,
+  MIB_RECEIVE_DELAY_2,
+  MIB_RX2_CHANNEL,
+} Mib_t;
+
+typedef union
+{
+  bool AdrEnable;
+  uint32_t DevAddr;
+  uint8_t *NwkSKey;
+  uint8_t *AppSKey;
+  ChannelParams_t *ChannelList;
+  int8_t ChannelsDatarate;
+  uint16_t *ChannelsMask;
+  int8_t ChannelsTxPower;
+  uint32_t UpLinkCounter;
+  uint32_t DownLinkCounter;
+  uint32_t ReceiveDelay1;
+  uint32_t ReceiveDelay2;
+  Rx2ChannelParams_t Rx2Channel;
+} MibParam_t;
+
+typedef struct
+{
+  Mib_t Type;
+  MibParam_t Param;
+} MibRequestConfirm_t;
+
+extern LoRaMacStatus_t LoRaMacMibGetRequestConfirm(MibRequestConfirm_t *mibGet);
+extern LoRaMacStatus_t LoRaMacMibSetRequestConfirm(MibRequestConfirm_t *mibSet);
+
+// Subset of the LoRaMac management requests
+typedef enum
+{
+  MLME_JOIN,
+} Mlme_t;
+
+typedef struct
+{
+  uint8_t *DevEui;
+  uint8_t *AppEui;
+  uint8_t *AppKey;
+  uint8_t NbTrials;
+} MlmeReqJoin_t;
+
+typedef struct
+{
+  Mlme_t Type;
+  union
+  {
+    MlmeReqJoin_t Join;
+  } Req;
+} MlmeReq_t;
+
+// A join request sends up to NbTrials join requests, each at the data
+// rate RegionAlternateDr picks for its trial number, whatever
+// MIB_CHANNELS_DATARATE was set to
+extern LoRaMacStatus_t LoRaMacMlmeRequest(MlmeReq_t *mlmeRequest);
+
+class LoRaWanMinimal
+{
+public:
+  void begin(DeviceClass_t lorawanClass, LoRaMacRegion_t region) {}
+  void setAdaptiveDR(bool enabled) { adaptiveDR = enabled; }
+  void setFixedDR(int8_t dr) { datarate = dr; }
+  bool joinOTAA(uint8_t *appEui, uint8_t *appKey, uint8_t *devEui = NULL); // MLME join, NbTrials 1
+  bool joinABP(uint8_t *nwkSKey, uint8_t *appSKey, uint32_t devAddr);
+  bool isJoined() { return joined; }
+  bool send(uint8_t datalen, uint8_t *datapointer, uint8_t fport, bool confirmed);
+
+  // test interface
+  bool adaptiveDR = false;
+  bool joined = false;
+  bool joinResult = true;
+  bool sendResult = true;
+  uint8_t maxPayload = 51; // EU868 DR0
+  uint32_t joinAttempts = 0;   // MLME join requests
+  uint32_t joinTrials = 0;     // join requests on air
+  uint8_t joinLostTrials = 0;  // trials of a request without an accept
+  uint8_t joinNbTrials = 0;    // NbTrials of the last MLME join request
+  uint32_t abpJoins = 0;
+  bool keysReadable = true; // MIB_NWK_SKEY/MIB_APP_SKEY get supported
+  uint32_t sendCount = 0;
+  uint8_t lastPort = 0;
+  bool lastConfirmed = false;
+  uint8_t lastFrame[242];
+  uint8_t lastLength = 0;
+
+  // MAC session, set up by a join, read and written through the MIB
+  uint32_t devAddr = 0;
+  uint8_t nwkSKey[16] = {};
+  uint8_t appSKey[16] = {};
+  uint32_t uplinkCounter = 0;
+  uint32_t downlinkCounter = 0;
+  int8_t datarate = 0;
+  uint16_t channelsMask = 0x00FF; // first word of MIB_CHANNELS_MASK
+  int8_t txPower = 0;             // MIB_CHANNELS_TX_POWER
+  int8_t joinDatarate = -1;       // datarate of the last join request on air
+  uint16_t joinChannelsMask = 0;  // channelsMask at the last join request
+
+  // EU868 defaults, a successful joinOTAA() applies the join-accept of
+  // TTN: RX1 after 5 s, RX2 with DR3 and channels 3 .. 7 from the CFList
+  uint32_t receiveDelay1 = 1000;
+  uint32_t receiveDelay2 = 2000;
+  Rx2ChannelParams_t rx2Channel = {869525000, 0};
+  ChannelParams_t channels[LORA_MAX_NB_CHANNELS] = {
+      {868100000, 0, {0x50}, 1},
+      {868300000, 0, {0x50}, 1},
+      {868500000, 0, {0x50}, 1},
+  };
+};
+
+extern LoRaWanMinimal LoRaWAN;
+extern uint16_t userChannelsMask[6];
+
+extern void downLinkDataHandle(McpsIndication_t *mcpsIndication);
@@ -0,0 +1,94 @@
+#pragma once
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <Arduino.h>
+
+// I2C slave behind the fake bus
+class FakeI2CDevice
+{
+public:
+  virtual ~FakeI2CDevice() {}
+  // bytes written by the master in one transaction, false = NACK
+  virtual bool receive(const uint8_t *data, size_t length) = 0;
+  // bytes requested by the master, returns the number delivered
+  virtual size_t transmit(uint8_t *data, size_t length) = 0;
+};
+
+// Device with 256 byte registers and auto-incrementing register pointer
+class FakeRegisterDevice : public FakeI2CDevice
+{
+public:
+  uint8_t registers[256];
+  uint8_t pointer = 0;
+
+  FakeRegisterDevice() { memset(registers, 0, sizeof(registers)); }
+
+  bool receive(const uint8_t *data, size_t length) override
+  {
+    if (length > 0)
+    {
+      pointer = data[0];
+    }
+    for (size_t i = 1; i < length; i++)
+    {
+      registers[pointer++] = data[i];
+    }
+    return true;
+  }
+
+  size_t transmit(uint8_t *data, size_t length) override
+  {
+    for (size_t i = 0; i < length; i++)
+    {
+      data[i] = registers[pointer++];
+    }
+    return length;
+  }
+};
+
+class TwoWire
+{
+public:
+  void begin() { enabled = true; }
+  void end() { enabled = false; }
+  void beginTransmission(int address);
+  size_t write(uint8_t value);
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(int address, int quantity);
+  int available();
+  int read();
+
+  // test interface
+  void attach(int address, FakeI2CDevice *device);
+  void detachAll();
+  uint32_t transactions = 0;
+  bool enabled = false; // between begin() and end()
+
+private:
+  static const int MAX_DEVICES = 4;
+  static const int BUFFER_SIZE = 32;
+  int addresses[MAX_DEVICES];
+  FakeI2CDevice *devices[MAX_DEVICES] = {};
+  int txAddress = 0;
+  uint8_t txBuffer[BUFFER_SIZE];
+  size_t txLength = 0;
+  uint8_t rxBuffer[BUFFER_SIZE];
+  size_t rxLength = 0;
+  size_t rxIndex = 0;
+  FakeI2CDevice *find(int address);
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <Aggregator.hpp>
+
+static Aggregator<int32_t, 8> window;
+
+static void fill(const int32_t *values, uint8_t n)
+{
+  for (uint8_t i = 0; i < n; i++)
+  {
+    window.add(values[i]);
+  }
+}
+
+void setUp(void)
+{
+  window.reset();
+}
+
+void tearDown(void)
+{
+}
+
+void test_empty_window(void)
+{
+  TEST_ASSERT_EQUAL(0, window.size());
+  TEST_ASSERT_EQUAL(0, window.mean());
+  TEST_ASSERT_EQUAL(0, window.median());
+  TEST_ASSERT_EQUAL_UINT32(0, window.variance());
+}
+
+void test_window_is_bounded(void)
+{
+  for (int i = 0; i < 8; i++)
+  {
+    TEST_ASSERT_TRUE(window.add(i));
+  }
+  TEST_ASSERT_FALSE(window.add(8));
+  TEST_ASSERT_EQUAL(8, window.size());
+  TEST_ASSERT_EQUAL(7, window.last());
+}
+
+void test_statistics(void)
+{
+  const int32_t values[] = {2150, 2148, 2152, 9999, 2149};
+  fill(values, 5);
+
+  TEST_ASSERT_EQUAL(2148, window.min());
+  TEST_ASSERT_EQUAL(9999, window.max());
+  TEST_ASSERT_EQUAL(3720, window.mean());
+  TEST_ASSERT_EQUAL(2150, window.median());
+  TEST_ASSERT_EQUAL(2150, window.trimmedMean()); // 2149, 2150, 2152
+  TEST_ASSERT_EQUAL(2149, window.last());
+}
+
+void test_median_even_count_rounds(void)
+{
+  const int32_t values[] = {-3, 10, -4, 8};
+  fill(values, 4);
+
+  TEST_ASSERT_EQUAL(3, window.median()); // (-3 + 8) / 2 = 2.5
+}
+
+void test_variance(void)
+{
+  const int32_t values[] = {2, 4, 4, 4, 5, 5, 7, 9};
+  fill(values, 8);
+
+  TEST_ASSERT_EQUAL_UINT32(4, window.variance());
+  TEST_ASSERT_EQUAL_UINT16(2, window.deviation());
+}
+
+void test_deviation(void)
+{
+  const int32_t values[] = {0, 0, 30, 30};
+  fill(values, 4);
+  TEST_ASSERT_EQUAL_UINT16(15, window.deviation());
+
+  window.reset();
+  const int32_t rounded[] = {0, 7};
+  fill(rounded, 2); // variance 12
+  TEST_ASSERT_EQUAL_UINT16(3, window.deviation());
+
+  window.reset();
+  const int32_t spread[] = {-1000000, 1000000};
+  fill(spread, 2);
+  TEST_ASSERT_EQUAL_UINT16(0xFFFF, window.deviation());
+}
+
+void test_aggregate_modes(void)
+{
+  const int32_t values[] = {1, 2, 30};
+  fill(values, 3);
+
+  TEST_ASSERT_EQUAL(30, window.aggregate(AGGREGATION_LAST));
+  TEST_ASSERT_EQUAL(11, window.aggregate(AGGREGATION_MEAN));
+  TEST_ASSERT_EQUAL(2, window.aggregate(AGGREGATION_MEDIAN));
+  TEST_ASSERT_EQUAL(1, window.aggregate(AGGREGATION_MIN));
+  TEST_ASSERT_EQUAL(30, window.aggregate(AGGREGATION_MAX));
+  TEST_ASSERT_EQUAL(30, window.aggregate(0x42));
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_window);
+  RUN_TEST(test_window_is_bounded);
+  RUN_TEST(test_statistics);
+  RUN_TEST(test_median_even_count_rounds);
+  RUN_TEST(test_variance);
+  RUN_TEST(test_deviation);
+  RUN_TEST(test_aggregate_modes);
+  return UNITY_END();
+}
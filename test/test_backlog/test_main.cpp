@@ -0,0 +1,231 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Backlog.hpp>
+#include <Decoder.hpp>
+
+#define MINUTE 60000UL
+
+static Backlog backlog;
+
+void setUp(void)
+{
+  fake::reset();
+  backlog_open(&backlog, 0);
+}
+
+void tearDown(void)
+{
+}
+
+static SensorSample sampleOf(int32_t n)
+{
+  SensorSample s = {2000 + n, 5000 + n, 101325 + n};
+  return s;
+}
+
+// Push n samples one interval apart, starting at the fake clock
+static void push(uint8_t n, uint32_t interval)
+{
+  for (uint8_t i = 0; i < n; i++)
+  {
+    SensorSample s = sampleOf(backlog.count);
+    backlog_push(&backlog, &s, fake::clock);
+    fake::clock += interval;
+  }
+}
+
+static uint8_t decode(uint8_t *frame, uint8_t length, SampleBatch *batch, uint16_t *ages, bool *rebased)
+{
+  uint8_t fields;
+  TEST_ASSERT_TRUE(decode_backlog(frame, length, &fields, rebased, batch, ages));
+  return fields;
+}
+
+void test_empty_eeprom_is_empty(void)
+{
+  TEST_ASSERT_EQUAL(0, backlog.count);
+  uint8_t frame[64], count;
+  TEST_ASSERT_EQUAL(0, backlog_encode(&backlog, BACKLOG_FIELDS, 0, frame, sizeof(frame), &count));
+  TEST_ASSERT_EQUAL(0, count);
+}
+
+void test_encode_ages_oldest_first(void)
+{
+  push(3, 20 * MINUTE);
+  uint8_t frame[64], count;
+  uint8_t length = backlog_encode(&backlog, BACKLOG_FIELDS, fake::clock, frame, sizeof(frame), &count);
+  TEST_ASSERT_EQUAL(3, count);
+  TEST_ASSERT_EQUAL(3 + 3 * 8, length);
+
+  SampleBatch batch;
+  uint16_t ages[MAX_BATCH_SIZE];
+  bool rebased;
+  TEST_ASSERT_EQUAL(BACKLOG_FIELDS, decode(frame, length, &batch, ages, &rebased));
+  TEST_ASSERT_FALSE(rebased);
+  TEST_ASSERT_EQUAL(3, batch.count);
+  TEST_ASSERT_INT_WITHIN(2, 60, ages[0]);
+  TEST_ASSERT_INT_WITHIN(2, 40, ages[1]);
+  TEST_ASSERT_INT_WITHIN(2, 20, ages[2]);
+  TEST_ASSERT_EQUAL(2000, batch.samples[0].temperature);
+  TEST_ASSERT_EQUAL(5002, batch.samples[2].humidity);
+  TEST_ASSERT_EQUAL(101327, batch.samples[2].pressure);
+}
+
+void test_encode_only_present_fields(void)
+{
+  push(2, MINUTE);
+  uint8_t frame[64], count;
+  uint8_t length = backlog_encode(&backlog, COMPACT_TEMPERATURE | COMPACT_BATTERY, fake::clock,
+                                  frame, sizeof(frame), &count);
+  TEST_ASSERT_EQUAL(3 + 2 * 4, length);
+}
+
+void test_encode_splits_to_fit(void)
+{
+  push(BACKLOG_CAPACITY, MINUTE);
+  uint8_t frame[64], count;
+  TEST_ASSERT_EQUAL(3 + 2 * 8, backlog_encode(&backlog, BACKLOG_FIELDS, fake::clock, frame, 20, &count));
+  TEST_ASSERT_EQUAL(2, count);
+
+  backlog_drop(&backlog, count);
+  TEST_ASSERT_EQUAL(BACKLOG_CAPACITY - 2, backlog.count);
+  backlog_encode(&backlog, BACKLOG_FIELDS, fake::clock, frame, sizeof(frame), &count);
+  TEST_ASSERT_EQUAL((sizeof(frame) - 3) / 8, count);
+  TEST_ASSERT_EQUAL(2002, backlog.records[backlog.first].sample.temperature);
+}
+
+void test_full_backlog_decodes_in_frames(void)
+{
+  push(BACKLOG_CAPACITY, MINUTE);
+  uint8_t frame[COMPACT_MAX_SIZE], count;
+  uint8_t sent = 0;
+  Uplink uplink;
+
+  while (backlog.count > 0)
+  {
+    uint8_t length = backlog_encode(&backlog, BACKLOG_FIELDS, fake::clock, frame, sizeof(frame), &count);
+    TEST_ASSERT_TRUE(count <= MAX_BATCH_SIZE);
+    TEST_ASSERT_EQUAL(DECODE_OK, decode_uplink(FPORT_BACKLOG, frame, length, &uplink));
+    TEST_ASSERT_EQUAL(count, uplink.batch.count);
+    TEST_ASSERT_EQUAL(2000 + sent, uplink.batch.samples[0].temperature);
+    TEST_ASSERT_EQUAL(2000 + sent + count - 1, uplink.batch.samples[count - 1].temperature);
+    backlog_drop(&backlog, count);
+    sent += count;
+  }
+  TEST_ASSERT_EQUAL(BACKLOG_CAPACITY, sent);
+}
+
+void test_full_ring_drops_oldest(void)
+{
+  push(BACKLOG_CAPACITY + 2, MINUTE);
+  TEST_ASSERT_EQUAL(BACKLOG_CAPACITY, backlog.count);
+  TEST_ASSERT_EQUAL(2, backlog.first);
+}
+
+void test_values_saturate(void)
+{
+  SensorSample s = {-40000, 70000, 20000};
+  backlog_push(&backlog, &s, 0);
+  BacklogRecord *r = &backlog.records[backlog.first];
+  TEST_ASSERT_EQUAL(-32768, r->sample.temperature);
+  TEST_ASSERT_EQUAL(65535, r->sample.humidity);
+  TEST_ASSERT_EQUAL(BACKLOG_REF_PRESSURE, r->sample.pressure);
+}
+
+void test_writes_are_batched_in_blocks(void)
+{
+  push(1, MINUTE);
+  TEST_ASSERT_FALSE(backlog_save(&backlog, false));
+  TEST_ASSERT_EQUAL(0, EEPROM.commits);
+
+  push(1, MINUTE);
+  TEST_ASSERT_TRUE(backlog_save(&backlog, false));
+  TEST_ASSERT_EQUAL(1, EEPROM.commits);
+  // the first record block and the header block
+  TEST_ASSERT_EQUAL(2 * BACKLOG_BLOCK, EEPROM.writes);
+
+  // nothing changed, nothing written
+  TEST_ASSERT_FALSE(backlog_save(&backlog, true));
+  TEST_ASSERT_EQUAL(1, EEPROM.commits);
+
+  // a drop only rewrites the header
+  backlog_drop(&backlog, 1);
+  TEST_ASSERT_TRUE(backlog_save(&backlog, true));
+  TEST_ASSERT_EQUAL(3 * BACKLOG_BLOCK, EEPROM.writes);
+  for (uint16_t i = 0; i < BACKLOG_OFFSET; i++)
+  {
+    TEST_ASSERT_EQUAL_HEX8(0xFF, EEPROM.data[i]);
+  }
+}
+
+void test_restore_after_reset_is_rebased(void)
+{
+  fake::clock = 10 * 24 * 60 * MINUTE;
+  push(3, 20 * MINUTE);
+  backlog_save(&backlog, true);
+
+  // reset, millis() starts again
+  fake::clock = 5 * MINUTE;
+  backlog_open(&backlog, fake::clock);
+  TEST_ASSERT_EQUAL(3, backlog.count);
+  TEST_ASSERT_EQUAL(3, backlog.rebased);
+  push(1, 0);
+
+  uint8_t frame[64], count;
+  uint8_t length = backlog_encode(&backlog, BACKLOG_FIELDS, fake::clock + 10 * MINUTE, frame, sizeof(frame), &count);
+  SampleBatch batch;
+  uint16_t ages[MAX_BATCH_SIZE];
+  bool rebased;
+  decode(frame, length, &batch, ages, &rebased);
+  TEST_ASSERT_TRUE(rebased);
+  TEST_ASSERT_EQUAL(4, batch.count);
+  // the newest stored sample counts as taken at boot
+  TEST_ASSERT_INT_WITHIN(2, 50, ages[0]);
+  TEST_ASSERT_INT_WITHIN(2, 10, ages[2]);
+  TEST_ASSERT_INT_WITHIN(2, 10, ages[3]);
+  TEST_ASSERT_EQUAL(2001, batch.samples[1].temperature);
+
+  // sent, the rest is no longer rebased
+  backlog_drop(&backlog, 3);
+  TEST_ASSERT_EQUAL(0, backlog.rebased);
+}
+
+void test_corrupt_eeprom_is_empty(void)
+{
+  push(2, MINUTE);
+  backlog_save(&backlog, true);
+  EEPROM.data[BACKLOG_OFFSET + 3] ^= 0x01;
+  backlog_open(&backlog, 0);
+  TEST_ASSERT_EQUAL(0, backlog.count);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_eeprom_is_empty);
+  RUN_TEST(test_encode_ages_oldest_first);
+  RUN_TEST(test_encode_only_present_fields);
+  RUN_TEST(test_encode_splits_to_fit);
+  RUN_TEST(test_full_backlog_decodes_in_frames);
+  RUN_TEST(test_full_ring_drops_oldest);
+  RUN_TEST(test_values_saturate);
+  RUN_TEST(test_writes_are_batched_in_blocks);
+  RUN_TEST(test_restore_after_reset_is_rebased);
+  RUN_TEST(test_corrupt_eeprom_is_empty);
+  return UNITY_END();
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Battery.hpp>
+
+#define HOUR 3600000UL
+#define DAY (24 * HOUR)
+
+static BatteryState battery;
+
+void setUp(void)
+{
+  fake::reset();
+  memset(&battery, 0, sizeof(battery));
+}
+
+void tearDown(void)
+{
+}
+
+void test_curve(void)
+{
+  TEST_ASSERT_EQUAL(10000, battery_level(4250));
+  TEST_ASSERT_EQUAL(10000, battery_level(4200));
+  TEST_ASSERT_EQUAL(5000, battery_level(3840));
+  TEST_ASSERT_EQUAL(4750, battery_level(3830));
+  TEST_ASSERT_EQUAL(500, battery_level(3610));
+  TEST_ASSERT_EQUAL(0, battery_level(3300));
+  TEST_ASSERT_EQUAL(0, battery_level(2900));
+
+  // monotonic
+  for (uint16_t mV = 3000; mV < 4300; mV++)
+  {
+    TEST_ASSERT_TRUE(battery_level(mV) <= battery_level(mV + 1));
+  }
+}
+
+void test_measure_averages_conversions(void)
+{
+  fake::batteryVoltage = 3800;
+  fake::batteryNoise = 40;
+  TEST_ASSERT_EQUAL(3800, battery_measure());
+  TEST_ASSERT_EQUAL(BATTERY_SAMPLES, fake::batteryReads);
+}
+
+void test_first_update_sets_state(void)
+{
+  battery_update(&battery, 3840, 0);
+  TEST_ASSERT_EQUAL(3840, battery_voltage(&battery));
+  TEST_ASSERT_EQUAL(50, battery_percent(&battery));
+  TEST_ASSERT_EQUAL(BATTERY_DAYS_UNKNOWN, battery_days(&battery));
+}
+
+void test_smoothing(void)
+{
+  battery_update(&battery, 3800, 0);
+  battery_update(&battery, 3880, HOUR);
+  TEST_ASSERT_EQUAL(3820, battery_voltage(&battery));
+
+  // a single outlier moves the average by a quarter only
+  battery_update(&battery, 3700, 2 * HOUR);
+  TEST_ASSERT_EQUAL(3790, battery_voltage(&battery));
+}
+
+void test_jump_restarts_average(void)
+{
+  battery_update(&battery, 3650, 0);
+  battery_update(&battery, 4180, HOUR);
+  TEST_ASSERT_EQUAL(4180, battery_voltage(&battery));
+}
+
+void test_days_from_discharge_rate(void)
+{
+  // 4 % in 10 days, 0.4 % per day
+  uint32_t now = 0;
+  battery_update(&battery, 3840, now); // 50 %
+  for (uint8_t day = 1; day <= 10; day++)
+  {
+    now += DAY;
+    battery_update(&battery, 3840 - 2 * day, now);
+  }
+  for (uint8_t i = 0; i < 20; i++)
+  {
+    now += HOUR;
+    battery_update(&battery, 3820, now); // settle the average
+  }
+  TEST_ASSERT_EQUAL(45, battery_percent(&battery));
+  TEST_ASSERT_TRUE(battery.rate > 0);
+  TEST_ASSERT_INT_WITHIN(20, 112, battery_days(&battery));
+}
+
+void test_elapsed_survives_millis_wrap(void)
+{
+  uint32_t now = 0xFFFFFFFFUL - HOUR;
+  battery_update(&battery, 3840, now);
+  now += 2 * HOUR;
+  battery_update(&battery, 3840, now);
+  TEST_ASSERT_EQUAL(7200, battery.elapsed);
+}
+
+void test_charging_resets_reference(void)
+{
+  battery_update(&battery, 3750, 0);
+  for (uint8_t i = 1; i <= 8; i++)
+  {
+    battery_update(&battery, 3750 + 20 * i, i * HOUR);
+  }
+  TEST_ASSERT_EQUAL(0, battery.rate);
+  TEST_ASSERT_EQUAL(battery.level, battery.reference);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_curve);
+  RUN_TEST(test_measure_averages_conversions);
+  RUN_TEST(test_first_update_sets_state);
+  RUN_TEST(test_smoothing);
+  RUN_TEST(test_jump_restarts_average);
+  RUN_TEST(test_days_from_discharge_rate);
+  RUN_TEST(test_elapsed_survives_millis_wrap);
+  RUN_TEST(test_charging_resets_reference);
+  return UNITY_END();
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <BME280.h>
+
+// Calibration and raw values from the Bosch datasheet example, humidity
+// coefficients of a typical part. Expected values are computed with the
+// floating point formulas of the datasheet.
+static FakeRegisterDevice sensor;
+static BME280 bme;
+
+static void put16LE(uint8_t reg, uint16_t value)
+{
+  sensor.registers[reg] = value & 0xFF;
+  sensor.registers[reg + 1] = value >> 8;
+}
+
+static void putRaw(int32_t adc_T, int32_t adc_P, int32_t adc_H)
+{
+  sensor.registers[0xF7] = adc_P >> 12;
+  sensor.registers[0xF8] = (adc_P >> 4) & 0xFF;
+  sensor.registers[0xF9] = (adc_P & 0x0F) << 4;
+  sensor.registers[0xFA] = adc_T >> 12;
+  sensor.registers[0xFB] = (adc_T >> 4) & 0xFF;
+  sensor.registers[0xFC] = (adc_T & 0x0F) << 4;
+  sensor.registers[0xFD] = adc_H >> 8;
+  sensor.registers[0xFE] = adc_H & 0xFF;
+}
+
+void setUp(void)
+{
+  fake::reset();
+  sensor = FakeRegisterDevice();
+  sensor.registers[BME280_REG_CHIPID] = 0x60;
+
+  put16LE(BME280_REG_DIG_T1, 27504);
+  put16LE(BME280_REG_DIG_T2, 26435);
+  put16LE(BME280_REG_DIG_T3, (uint16_t)-1000);
+  put16LE(BME280_REG_DIG_P1, 36477);
+  put16LE(BME280_REG_DIG_P2, (uint16_t)-10685);
+  put16LE(BME280_REG_DIG_P3, 3024);
+  put16LE(BME280_REG_DIG_P4, 2855);
+  put16LE(BME280_REG_DIG_P5, 140);
+  put16LE(BME280_REG_DIG_P6, (uint16_t)-7);
+  put16LE(BME280_REG_DIG_P7, 15500);
+  put16LE(BME280_REG_DIG_P8, (uint16_t)-14600);
+  put16LE(BME280_REG_DIG_P9, 6000);
+
+  // dig_H4 = 313, dig_H5 = 50, 12 bit values sharing 0xE5
+  sensor.registers[BME280_REG_DIG_H1] = 75;
+  put16LE(BME280_REG_DIG_H2, 362);
+  sensor.registers[BME280_REG_DIG_H3] = 0;
+  sensor.registers[0xE4] = 313 >> 4;
+  sensor.registers[0xE5] = (313 & 0x0F) | ((50 & 0x0F) << 4);
+  sensor.registers[0xE6] = 50 >> 4;
+  sensor.registers[BME280_REG_DIG_H6] = 30;
+
+  putRaw(519888, 415148, 30000);
+  Wire.attach(BME280_ADDRESS, &sensor);
+  bme.clearCalibration();
+}
+
+void tearDown(void)
+{
+}
+
+void test_init_reads_chip_id(void)
+{
+  TEST_ASSERT_TRUE(bme.init());
+  TEST_ASSERT_EQUAL_HEX8(BME280_MODE_SLEEP, sensor.registers[BME280_REG_CONTROL] & 0x03);
+}
+
+void test_init_fails_without_sensor(void)
+{
+  Wire.detachAll();
+  TEST_ASSERT_FALSE(bme.init());
+}
+
+void test_read_all_compensation(void)
+{
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.init());
+  TEST_ASSERT_TRUE(bme.readAll(data));
+
+  TEST_ASSERT_INT_WITHIN(10, 25082, data.temperature);   // 25.082 C
+  TEST_ASSERT_UINT32_WITHIN(30, 1006533, data.pressure); // 100653.3 Pa, 32 bit path 100656 Pa
+  TEST_ASSERT_UINT32_WITHIN(10, 55001, data.humidity);   // 55.001 %
+}
+
+void test_read_all_is_one_burst(void)
+{
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.init());
+  uint32_t before = Wire.transactions;
+  TEST_ASSERT_TRUE(bme.readAll(data));
+  // register pointer write + one 8 byte read
+  TEST_ASSERT_EQUAL(2, Wire.transactions - before);
+}
+
+void test_read_forced_triggers_conversion(void)
+{
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.init());
+  bme.setOversampling(BME280_OVERSAMPLING_X1, BME280_OVERSAMPLING_X1, BME280_OVERSAMPLING_X1);
+  TEST_ASSERT_TRUE(bme.readForced(data));
+  TEST_ASSERT_EQUAL_HEX8((1 << 5) | (1 << 2) | BME280_MODE_FORCED, sensor.registers[BME280_REG_CONTROL]);
+  TEST_ASSERT_EQUAL_HEX8(BME280_OVERSAMPLING_X1, sensor.registers[BME280_REG_CONTROLHUMID]);
+  TEST_ASSERT_INT_WITHIN(10, 25082, data.temperature);
+}
+
+void test_init_reads_calibration_once(void)
+{
+  TEST_ASSERT_TRUE(bme.init());
+  uint32_t before = Wire.transactions;
+  TEST_ASSERT_TRUE(bme.init());
+  // chip ID read + ctrl_hum and ctrl_meas writes
+  TEST_ASSERT_EQUAL(4, Wire.transactions - before);
+
+  // a changed calibration is not seen, the cached one is used
+  put16LE(BME280_REG_DIG_T1, 0);
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.readAll(data));
+  TEST_ASSERT_INT_WITHIN(10, 25082, data.temperature);
+}
+
+void test_clear_calibration_reads_again(void)
+{
+  TEST_ASSERT_TRUE(bme.init());
+  bme.clearCalibration();
+  uint32_t before = Wire.transactions;
+  TEST_ASSERT_TRUE(bme.init());
+  // chip ID, two calibration bursts, control registers
+  TEST_ASSERT_EQUAL(8, Wire.transactions - before);
+}
+
+void test_init_checks_chip_id_with_cached_calibration(void)
+{
+  TEST_ASSERT_TRUE(bme.init());
+  sensor.registers[BME280_REG_CHIPID] = 0x58; // BMP280
+  TEST_ASSERT_FALSE(bme.init());
+}
+
+void test_measurement_time(void)
+{
+  bme.setOversampling(BME280_OVERSAMPLING_X1, BME280_OVERSAMPLING_X1, BME280_OVERSAMPLING_X1);
+  TEST_ASSERT_EQUAL_UINT32(9300, bme.getMeasurementTime());
+  bme.setOversampling(BME280_OVERSAMPLING_X16, BME280_OVERSAMPLING_X16, BME280_OVERSAMPLING_X16);
+  TEST_ASSERT_EQUAL_UINT32(112800, bme.getMeasurementTime());
+  bme.setOversampling(BME280_OVERSAMPLING_X1, BME280_OVERSAMPLING_SKIP, BME280_OVERSAMPLING_SKIP);
+  TEST_ASSERT_EQUAL_UINT32(3550, bme.getMeasurementTime());
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_init_reads_chip_id);
+  RUN_TEST(test_init_fails_without_sensor);
+  RUN_TEST(test_read_all_compensation);
+  RUN_TEST(test_read_all_is_one_burst);
+  RUN_TEST(test_read_forced_triggers_conversion);
+  RUN_TEST(test_init_reads_calibration_once);
+  RUN_TEST(test_clear_calibration_reads_again);
+  RUN_TEST(test_init_checks_chip_id_with_cached_calibration);
+  RUN_TEST(test_measurement_time);
+  return UNITY_END();
+}
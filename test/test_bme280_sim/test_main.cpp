@@ -0,0 +1,175 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <FakeBME280.h>
+#include <BME280.h>
+
+// Drives the BME280 driver against the register level model. The model
+// computes raw values with the floating point formulas of the datasheet,
+// so the driver is checked against an independent implementation.
+static FakeBME280 sensor;
+static BME280 bme;
+
+void setUp(void)
+{
+  fake::reset();
+  sensor = FakeBME280();
+  Wire.attach(BME280_ADDRESS, &sensor);
+  bme.clearCalibration();
+  i2c_clear_counters();
+}
+
+void tearDown(void)
+{
+}
+
+void test_read_forced_follows_environment(void)
+{
+  BME280Data data;
+  sensor.set(21.5, 48.0, 98765.0);
+  TEST_ASSERT_TRUE(bme.init());
+  TEST_ASSERT_TRUE(bme.readForced(data));
+  TEST_ASSERT_INT_WITHIN(10, 21500, data.temperature);
+  TEST_ASSERT_UINT32_WITHIN(50, 987650, data.pressure);
+  TEST_ASSERT_UINT32_WITHIN(50, 48000, data.humidity);
+  TEST_ASSERT_EQUAL(1, sensor.conversions);
+}
+
+void test_read_forced_follows_trace(void)
+{
+  const FakeBME280Point trace[] = {
+      {0, -10.0, 90.0, 102000.0},
+      {60000, 30.0, 30.0, 99000.0},
+  };
+  sensor.setTrace(trace, 2);
+  TEST_ASSERT_TRUE(bme.init());
+
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.readForced(data));
+  TEST_ASSERT_INT_WITHIN(20, -10000, data.temperature);
+
+  fake::clock = 30000;
+  TEST_ASSERT_TRUE(bme.readForced(data));
+  TEST_ASSERT_INT_WITHIN(20, 10000, data.temperature);
+  TEST_ASSERT_UINT32_WITHIN(100, 60000, data.humidity);
+  TEST_ASSERT_UINT32_WITHIN(50, 1005000, data.pressure);
+
+  fake::clock = 120000;
+  TEST_ASSERT_TRUE(bme.readForced(data));
+  TEST_ASSERT_INT_WITHIN(20, 30000, data.temperature);
+}
+
+void test_result_only_after_conversion_time(void)
+{
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.init());
+  bme.setOversampling(BME280_OVERSAMPLING_X1, BME280_OVERSAMPLING_X1, BME280_OVERSAMPLING_X1);
+  TEST_ASSERT_TRUE(bme.startForced());
+  // 8 ms typical, the status poll has to wait for the rest
+  delay(5);
+  uint32_t start = fake::clock;
+  TEST_ASSERT_TRUE(bme.readForcedResult(data));
+  TEST_ASSERT_EQUAL(3, fake::clock - start);
+  TEST_ASSERT_INT_WITHIN(10, 25000, data.temperature);
+}
+
+void test_bus_traffic_per_measurement(void)
+{
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.init());
+  printf("cold init: %u transactions, %u bytes written, %u bytes read\n",
+         sensor.transactions, sensor.bytesWritten, sensor.bytesRead);
+
+  sensor.resetCounters();
+  TEST_ASSERT_TRUE(bme.init());
+  printf("warm init: %u transactions, %u bytes written, %u bytes read\n",
+         sensor.transactions, sensor.bytesWritten, sensor.bytesRead);
+  TEST_ASSERT_EQUAL(4, sensor.transactions);
+
+  sensor.resetCounters();
+  TEST_ASSERT_TRUE(bme.readForced(data));
+  printf("forced read: %u transactions, %u bytes written, %u bytes read\n",
+         sensor.transactions, sensor.bytesWritten, sensor.bytesRead);
+  // ctrl_hum, ctrl_meas, status poll, burst read
+  TEST_ASSERT_EQUAL(6, sensor.transactions);
+  TEST_ASSERT_EQUAL(8 + 1, sensor.bytesRead);
+}
+
+void test_nack_is_retried(void)
+{
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.init());
+  TEST_ASSERT_TRUE(bme.startForced());
+  delay(bme.getMeasurementTime() / 1000 + 1);
+  // the status register pointer write fails twice, the third attempt works
+  sensor.nackNext = 2;
+  TEST_ASSERT_TRUE(bme.readForcedResult(data));
+  TEST_ASSERT_EQUAL(2, sensor.nacks);
+  TEST_ASSERT_EQUAL(2, i2cCounters.errors);
+  TEST_ASSERT_EQUAL(2, i2cCounters.retries);
+  TEST_ASSERT_EQUAL(0, i2cCounters.failures);
+  TEST_ASSERT_INT_WITHIN(10, 25000, data.temperature);
+}
+
+void test_short_read_is_retried(void)
+{
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.init());
+  TEST_ASSERT_TRUE(bme.startForced());
+  delay(bme.getMeasurementTime() / 1000 + 1);
+  sensor.shortReadNext = 2; // status twice
+  TEST_ASSERT_TRUE(bme.readForcedResult(data));
+  TEST_ASSERT_EQUAL(2, i2cCounters.errors);
+  TEST_ASSERT_INT_WITHIN(10, 25000, data.temperature);
+}
+
+void test_dead_bus_fails_in_bounded_time(void)
+{
+  BME280Data data;
+  TEST_ASSERT_TRUE(bme.init());
+  sensor.nackEvery = 1;
+  uint32_t start = fake::clock;
+  TEST_ASSERT_FALSE(bme.startForced());
+  TEST_ASSERT_TRUE(fake::clock - start <= I2C_TIMEOUT);
+  TEST_ASSERT_EQUAL(I2C_ATTEMPTS, sensor.nacks);
+  TEST_ASSERT_EQUAL(1, i2cCounters.failures);
+  // the bus is fine again, so is the next read
+  sensor.nackEvery = 0;
+  TEST_ASSERT_TRUE(bme.readForced(data));
+}
+
+void test_init_fails_on_nack(void)
+{
+  sensor.nackEvery = 1;
+  TEST_ASSERT_FALSE(bme.init());
+  sensor.nackEvery = 0;
+  TEST_ASSERT_TRUE(bme.init());
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_read_forced_follows_environment);
+  RUN_TEST(test_read_forced_follows_trace);
+  RUN_TEST(test_result_only_after_conversion_time);
+  RUN_TEST(test_bus_traffic_per_measurement);
+  RUN_TEST(test_nack_is_retried);
+  RUN_TEST(test_short_read_is_retried);
+  RUN_TEST(test_dead_bus_fails_in_bounded_time);
+  RUN_TEST(test_init_fails_on_nack);
+  return UNITY_END();
+}
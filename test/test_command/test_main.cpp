@@ -0,0 +1,198 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Command.hpp>
+
+void setUp(void)
+{
+  fake::reset();
+  init_app_config();
+}
+
+void tearDown(void)
+{
+}
+
+void test_batched_commands_single_write(void)
+{
+  const uint8_t msg[] = {
+      COMMAND_SLEEPTIME, 4, 0x00, 0x0D, 0xBB, 0xA0, // 900000 ms
+      COMMAND_OVERSAMPLING, 1, 3,
+      COMMAND_BATCHSIZE, 1, 4,
+      COMMAND_DEADBAND, 6, 0x00, 0x0A, 0x00, 0x32, 0x00, 0x0A,
+      COMMAND_DATARATE, 1, 2,
+      COMMAND_CONFIRMED, 1, 10,
+  };
+  uint32_t commits = EEPROM.commits;
+
+  CommandAck ack = handle_command_downlink(msg, sizeof(msg));
+
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_OK, ack.status);
+  TEST_ASSERT_EQUAL_UINT8(0, ack.tag);
+  TEST_ASSERT_EQUAL_UINT8(6, ack.count);
+  TEST_ASSERT_EQUAL_UINT32(commits + 1, EEPROM.commits);
+  TEST_ASSERT_EQUAL_UINT32(900000, appConfig.sleeptime);
+  TEST_ASSERT_EQUAL_UINT8(3, appConfig.oversampling);
+  TEST_ASSERT_EQUAL_UINT8(4, appConfig.batchsize);
+  TEST_ASSERT_EQUAL_UINT16(10, appConfig.deadbandTemperature);
+  TEST_ASSERT_EQUAL_UINT16(50, appConfig.deadbandHumidity);
+  TEST_ASSERT_EQUAL_UINT16(10, appConfig.deadbandPressure);
+  TEST_ASSERT_EQUAL_UINT8(0, appConfig.adr);
+  TEST_ASSERT_EQUAL_UINT8(2, appConfig.datarate);
+  TEST_ASSERT_EQUAL_UINT8(10, appConfig.confirmed);
+}
+
+void test_invalid_command_rejects_all(void)
+{
+  const uint8_t msg[] = {
+      COMMAND_BATCHSIZE, 1, 4,
+      COMMAND_OVERSAMPLING, 1, 9,
+  };
+  uint32_t commits = EEPROM.commits;
+
+  CommandAck ack = handle_command_downlink(msg, sizeof(msg));
+
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_INVALID, ack.status);
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_OVERSAMPLING, ack.tag);
+  TEST_ASSERT_EQUAL_UINT8(2, ack.count);
+  TEST_ASSERT_EQUAL_UINT8(BATCH_SIZE, appConfig.batchsize);
+  TEST_ASSERT_EQUAL_UINT32(commits, EEPROM.commits);
+}
+
+void test_battery_low_below_critical_rejects_all(void)
+{
+  const uint8_t msg[] = {
+      COMMAND_BATCHSIZE, 1, 4,
+      COMMAND_BATTERY, 4, 0x0D, 0xAC, 0x0E, 0x10, // low 3500 mV, critical 3600 mV
+  };
+  uint32_t commits = EEPROM.commits;
+
+  CommandAck ack = handle_command_downlink(msg, sizeof(msg));
+
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_INVALID, ack.status);
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_BATTERY, ack.tag);
+  TEST_ASSERT_EQUAL_UINT8(2, ack.count);
+  TEST_ASSERT_EQUAL_UINT8(BATCH_SIZE, appConfig.batchsize);
+  TEST_ASSERT_EQUAL_UINT16(BATTERY_LOW, appConfig.batteryLow);
+  TEST_ASSERT_EQUAL_UINT32(commits, EEPROM.commits);
+
+  // a disabled threshold is never inconsistent
+  const uint8_t critical[] = {COMMAND_BATTERY, 4, 0x00, 0x00, 0x0E, 0x10};
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_OK, handle_command_downlink(critical, sizeof(critical)).status);
+  TEST_ASSERT_EQUAL_UINT16(3600, appConfig.batteryCritical);
+
+  const uint8_t legacy[] = {0xA5, COMMAND_BATTERY, 0x0D, 0xAC, 0x0E, 0x10};
+  TEST_ASSERT_FALSE(handle_config_downlink(legacy, sizeof(legacy)));
+}
+
+void test_interval_min_above_max_rejects_all(void)
+{
+  const uint8_t msg[] = {
+      COMMAND_SLEEPTIME, 4, 0x00, 0x0D, 0xBB, 0xA0,                         // 900000 ms
+      COMMAND_INTERVAL, 8, 0x00, 0x0D, 0xBB, 0xA0, 0x00, 0x09, 0x27, 0xC0, // 900000 - 600000 ms
+  };
+  uint32_t commits = EEPROM.commits;
+
+  CommandAck ack = handle_command_downlink(msg, sizeof(msg));
+
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_INVALID, ack.status);
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_INTERVAL, ack.tag);
+  TEST_ASSERT_EQUAL_UINT32(MIN_SLEEPTIME, appConfig.minsleeptime);
+  TEST_ASSERT_EQUAL_UINT32(MAX_SLEEPTIME, appConfig.maxsleeptime);
+  TEST_ASSERT_NOT_EQUAL(900000, appConfig.sleeptime);
+  TEST_ASSERT_EQUAL_UINT32(commits, EEPROM.commits);
+}
+
+void test_unknown_tag(void)
+{
+  const uint8_t msg[] = {0x7E, 1, 0};
+  CommandAck ack = handle_command_downlink(msg, sizeof(msg));
+
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_UNKNOWN, ack.status);
+  TEST_ASSERT_EQUAL_UINT8(0x7E, ack.tag);
+}
+
+void test_wrong_length(void)
+{
+  const uint8_t msg[] = {COMMAND_SLEEPTIME, 2, 0x00, 0x01};
+  CommandAck ack = handle_command_downlink(msg, sizeof(msg));
+
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_UNKNOWN, ack.status);
+}
+
+void test_truncated_stream(void)
+{
+  const uint8_t msg[] = {COMMAND_BATCHSIZE, 1, 4, COMMAND_SLEEPTIME, 4, 0x00};
+  CommandAck ack = handle_command_downlink(msg, sizeof(msg));
+
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_MALFORMED, ack.status);
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_SLEEPTIME, ack.tag);
+  TEST_ASSERT_EQUAL_UINT8(BATCH_SIZE, appConfig.batchsize);
+}
+
+void test_datarate_adr(void)
+{
+  const uint8_t fixed[] = {COMMAND_DATARATE, 1, 5};
+  const uint8_t adr[] = {COMMAND_DATARATE, 1, 0xFF};
+  const uint8_t invalid[] = {COMMAND_DATARATE, 1, 6};
+
+  handle_command_downlink(fixed, sizeof(fixed));
+  TEST_ASSERT_EQUAL_UINT8(0, appConfig.adr);
+  TEST_ASSERT_EQUAL_UINT8(5, appConfig.datarate);
+
+  handle_command_downlink(adr, sizeof(adr));
+  TEST_ASSERT_EQUAL_UINT8(1, appConfig.adr);
+  TEST_ASSERT_EQUAL_UINT8(5, appConfig.datarate);
+
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_INVALID, handle_command_downlink(invalid, sizeof(invalid)).status);
+}
+
+void test_unchanged_config_not_written(void)
+{
+  const uint8_t msg[] = {COMMAND_AGGREGATION, 1, AGGREGATION_MODE};
+  uint32_t commits = EEPROM.commits;
+
+  TEST_ASSERT_EQUAL_UINT8(COMMAND_OK, handle_command_downlink(msg, sizeof(msg)).status);
+  TEST_ASSERT_EQUAL_UINT32(commits, EEPROM.commits);
+}
+
+void test_legacy_downlink_uses_same_handlers(void)
+{
+  const uint8_t sleeptime[] = {0xA5, 0x01, 0x00, 0x00, 0xEA, 0x60};
+  const uint8_t senddelay[] = {0xA5, COMMAND_SENDDELAY, 0x00, 0x00, 0x03, 0xE8};
+
+  TEST_ASSERT_TRUE(handle_config_downlink(sleeptime, sizeof(sleeptime)));
+  TEST_ASSERT_EQUAL_UINT32(60000, appConfig.sleeptime);
+  // TLV only commands have no A5 form
+  TEST_ASSERT_FALSE(handle_config_downlink(senddelay, sizeof(senddelay)));
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_batched_commands_single_write);
+  RUN_TEST(test_invalid_command_rejects_all);
+  RUN_TEST(test_battery_low_below_critical_rejects_all);
+  RUN_TEST(test_interval_min_above_max_rejects_all);
+  RUN_TEST(test_unknown_tag);
+  RUN_TEST(test_wrong_length);
+  RUN_TEST(test_truncated_stream);
+  RUN_TEST(test_datarate_adr);
+  RUN_TEST(test_unchanged_config_not_written);
+  RUN_TEST(test_legacy_downlink_uses_same_handlers);
+  return UNITY_END();
+}
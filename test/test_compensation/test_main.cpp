@@ -0,0 +1,143 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <FakeBME280.h>
+#include <BME280.h>
+#include <chrono>
+
+// Compares the 32 bit compensation with the 64 bit reference over the
+// whole operating range and prints the time per call of each back-end.
+// Calibration of the Bosch datasheet example (FakeBME280).
+static FakeBME280 sensor;
+static BME280 bme;
+
+void setUp(void)
+{
+  fake::reset();
+  sensor = FakeBME280();
+  Wire.attach(BME280_ADDRESS, &sensor);
+  bme.clearCalibration();
+  TEST_ASSERT_TRUE(bme.init());
+}
+
+void tearDown(void)
+{
+}
+
+// adc_T 400000..640000 covers about -20..60 C with this calibration,
+// adc_P 250000..560000 about 1100..300 hPa
+static void sweep(uint32_t *maxPressureError, uint32_t *maxHumidityError)
+{
+  *maxPressureError = 0;
+  *maxHumidityError = 0;
+
+  for (int32_t adc_T = 400000; adc_T <= 640000; adc_T += 16000)
+  {
+    for (int32_t adc_P = 250000; adc_P <= 560000; adc_P += 10000)
+    {
+      for (int32_t adc_H = 20000; adc_H <= 45000; adc_H += 2500)
+      {
+        BME280RawData raw = {adc_P, adc_T, adc_H};
+        BME280Data reference, fast;
+        bme.compensate(raw, reference, BME280_COMPENSATION_64BIT);
+        bme.compensate(raw, fast, BME280_COMPENSATION_32BIT);
+
+        TEST_ASSERT_EQUAL_INT32(reference.temperature, fast.temperature);
+
+        uint32_t dp = reference.pressure > fast.pressure ? reference.pressure - fast.pressure
+                                                         : fast.pressure - reference.pressure;
+        uint32_t dh = reference.humidity > fast.humidity ? reference.humidity - fast.humidity
+                                                         : fast.humidity - reference.humidity;
+        if (dp > *maxPressureError)
+        {
+          *maxPressureError = dp;
+        }
+        if (dh > *maxHumidityError)
+        {
+          *maxHumidityError = dh;
+        }
+      }
+    }
+  }
+}
+
+void test_32bit_pressure_within_bound(void)
+{
+  uint32_t dp, dh;
+  sweep(&dp, &dh);
+  printf("max pressure error %u.%u Pa\n", dp / 10, dp % 10);
+  // about 5 Pa at the ends of the range, below the 12 Pa relative
+  // accuracy of the sensor
+  TEST_ASSERT_TRUE(dp <= 80);
+}
+
+void test_fixed_point_humidity_within_bound(void)
+{
+  uint32_t dp, dh;
+  sweep(&dp, &dh);
+  printf("max humidity error %u.%03u %%\n", dh / 1000, dh % 1000);
+  // one LSB of 0.001 %, the uplink carries 0.01 %
+  TEST_ASSERT_TRUE(dh <= 1);
+}
+
+void test_disabled_pressure(void)
+{
+  BME280RawData raw = {0x80000, 519888, 30000};
+  BME280Data data;
+  bme.compensate(raw, data, BME280_COMPENSATION_64BIT);
+  TEST_ASSERT_EQUAL_UINT32(0, data.pressure);
+  bme.compensate(raw, data, BME280_COMPENSATION_32BIT);
+  TEST_ASSERT_EQUAL_UINT32(0, data.pressure);
+}
+
+static double nanosPerCall(uint8_t mode)
+{
+  const int calls = 200000;
+  volatile uint32_t sink = 0;
+  BME280Data data;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < calls; i++)
+  {
+    BME280RawData raw = {415148 + (i & 0xFFF), 519888 + (i & 0x3FF), 30000 + (i & 0x7FF)};
+    bme.compensate(raw, data, mode);
+    sink += data.pressure + data.humidity;
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+}
+
+// The host has 64 bit hardware, the numbers only show the relative cost.
+// On the Cortex-M0+ every 64 bit division is a library call.
+void test_timing(void)
+{
+  double reference = nanosPerCall(BME280_COMPENSATION_64BIT);
+  double fast = nanosPerCall(BME280_COMPENSATION_32BIT);
+  printf("64 bit: %.1f ns/call, 32 bit: %.1f ns/call\n", reference, fast);
+  TEST_ASSERT_TRUE(reference > 0 && fast > 0);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_32bit_pressure_within_bound);
+  RUN_TEST(test_fixed_point_humidity_within_bound);
+  RUN_TEST(test_disabled_pressure);
+  RUN_TEST(test_timing);
+  return UNITY_END();
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <AppConfig.hpp>
+#include <ConfigStore.hpp>
+#include <Command.hpp>
+
+void setUp(void)
+{
+  fake::reset();
+  memset(&appConfig, 0, sizeof(AppConfig));
+}
+
+void tearDown(void)
+{
+}
+
+void test_first_boot_writes_config(void)
+{
+  init_app_config();
+
+  TEST_ASSERT_EQUAL_HEX32(EEPROM_MAGIC, appConfig.magic);
+  TEST_ASSERT_EQUAL_UINT32(DEFAULT_SLEEPTIME, appConfig.sleeptime);
+  TEST_ASSERT_EQUAL_UINT8(AGGREGATION_MODE, appConfig.aggregation);
+  // locally administered, unicast
+  TEST_ASSERT_EQUAL_HEX8(0x02, appConfig.devEui[0] & 0x03);
+  AppConfig stored;
+  TEST_ASSERT_EQUAL_UINT8(sizeof(AppConfig), config_store_read(&stored, sizeof(AppConfig)));
+  TEST_ASSERT_EQUAL_MEMORY(&appConfig, &stored, sizeof(AppConfig));
+}
+
+void test_config_survives_reboot(void)
+{
+  init_app_config();
+  AppConfig stored = appConfig;
+
+  memset(&appConfig, 0, sizeof(AppConfig));
+  init_app_config();
+
+  TEST_ASSERT_EQUAL_MEMORY(&stored, &appConfig, sizeof(AppConfig));
+  TEST_ASSERT_EQUAL_UINT32(1, EEPROM.commits);
+}
+
+void test_gpio7_low_forces_new_config(void)
+{
+  init_app_config();
+  AppConfig stored = appConfig;
+
+  fake::inputs[GPIO7] = LOW;
+  init_app_config();
+
+  TEST_ASSERT_EQUAL_UINT32(2, EEPROM.commits);
+  TEST_ASSERT_TRUE(memcmp(stored.appKey, appConfig.appKey, 16) != 0);
+}
+
+// Config of the first firmware at EEPROM offset 0, appended fields erased
+static void writeLegacyConfig()
+{
+  AppConfig legacy;
+  memset(&legacy, 0xFF, sizeof(legacy));
+  legacy.magic = EEPROM_MAGIC;
+  memset(legacy.appEui, 0x11, 8);
+  memset(legacy.devEui, 0x22, 8);
+  memset(legacy.appKey, 0x33, 16);
+  legacy.sleeptime = 60000;
+  legacy.senddelay = 0;
+  memcpy(EEPROM.data, &legacy, offsetof(AppConfig, aggregation));
+}
+
+void test_invalid_appended_field_is_sanitized(void)
+{
+  writeLegacyConfig();
+
+  init_app_config();
+
+  TEST_ASSERT_EQUAL_UINT32(60000, appConfig.sleeptime);
+  TEST_ASSERT_EQUAL_UINT8(AGGREGATION_MODE, appConfig.aggregation);
+  TEST_ASSERT_EQUAL_UINT8(BATCH_SIZE, appConfig.batchsize);
+  TEST_ASSERT_EQUAL_UINT32(MAX_SILENCE, appConfig.maxsilence);
+}
+
+void test_legacy_config_is_migrated(void)
+{
+  writeLegacyConfig();
+  init_app_config();
+
+  // keys are kept, the legacy bytes stay intact until slot 0 is reused
+  TEST_ASSERT_EQUAL_HEX8(0x33, appConfig.appKey[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x33, appConfig.appKey[15]);
+  TEST_ASSERT_EQUAL_HEX32(EEPROM_MAGIC, ((AppConfig *)EEPROM.data)->magic);
+
+  AppConfig stored;
+  TEST_ASSERT_EQUAL_UINT8(sizeof(AppConfig), config_store_read(&stored, sizeof(AppConfig)));
+  TEST_ASSERT_EQUAL_MEMORY(&appConfig, &stored, sizeof(AppConfig));
+
+  init_app_config();
+  TEST_ASSERT_EQUAL_UINT32(1, EEPROM.commits);
+}
+
+void test_downlink_sleeptime(void)
+{
+  init_app_config();
+  const uint8_t msg[] = {0xA5, 0x01, 0x00, 0x00, 0xEA, 0x60};
+
+  TEST_ASSERT_TRUE(handle_config_downlink(msg, sizeof(msg)));
+  TEST_ASSERT_EQUAL_UINT32(60000, appConfig.sleeptime);
+
+  AppConfig stored;
+  config_store_read(&stored, sizeof(AppConfig));
+  TEST_ASSERT_EQUAL_UINT32(60000, stored.sleeptime);
+}
+
+void test_downlink_sleeptime_out_of_range(void)
+{
+  init_app_config();
+  const uint8_t msg[] = {0xA5, 0x01, 0x05, 0x26, 0x5C, 0x01}; // one day + 1ms
+
+  TEST_ASSERT_FALSE(handle_config_downlink(msg, sizeof(msg)));
+  TEST_ASSERT_EQUAL_UINT32(DEFAULT_SLEEPTIME, appConfig.sleeptime);
+}
+
+void test_downlink_aggregation(void)
+{
+  init_app_config();
+  const uint8_t valid[] = {0xA5, 0x02, AGGREGATION_TRIMMED_MEAN};
+  const uint8_t invalid[] = {0xA5, 0x02, 0x42};
+
+  TEST_ASSERT_TRUE(handle_config_downlink(valid, sizeof(valid)));
+  TEST_ASSERT_EQUAL_UINT8(AGGREGATION_TRIMMED_MEAN, appConfig.aggregation);
+  TEST_ASSERT_FALSE(handle_config_downlink(invalid, sizeof(invalid)));
+  TEST_ASSERT_EQUAL_UINT8(AGGREGATION_TRIMMED_MEAN, appConfig.aggregation);
+}
+
+void test_downlink_batchsize(void)
+{
+  init_app_config();
+  const uint8_t valid[] = {0xA5, 0x03, 6};
+  const uint8_t zero[] = {0xA5, 0x03, 0};
+  const uint8_t large[] = {0xA5, 0x03, MAX_BATCH_SIZE + 1};
+
+  TEST_ASSERT_EQUAL_UINT8(BATCH_SIZE, appConfig.batchsize);
+  TEST_ASSERT_TRUE(handle_config_downlink(valid, sizeof(valid)));
+  TEST_ASSERT_EQUAL_UINT8(6, appConfig.batchsize);
+  TEST_ASSERT_FALSE(handle_config_downlink(zero, sizeof(zero)));
+  TEST_ASSERT_FALSE(handle_config_downlink(large, sizeof(large)));
+  TEST_ASSERT_EQUAL_UINT8(6, appConfig.batchsize);
+}
+
+void test_downlink_deadband_and_silence(void)
+{
+  init_app_config();
+  const uint8_t deadband[] = {0xA5, 0x04, 0x00, 0x14, 0x00, 0x64, 0x00, 0x00};
+  const uint8_t silence[] = {0xA5, 0x05, 0x00, 0x36, 0xEE, 0x80};
+  const uint8_t noSilence[] = {0xA5, 0x05, 0x00, 0x00, 0x00, 0x00};
+
+  TEST_ASSERT_TRUE(handle_config_downlink(deadband, sizeof(deadband)));
+  TEST_ASSERT_EQUAL_UINT16(20, appConfig.deadbandTemperature);
+  TEST_ASSERT_EQUAL_UINT16(100, appConfig.deadbandHumidity);
+  TEST_ASSERT_EQUAL_UINT16(0, appConfig.deadbandPressure);
+
+  TEST_ASSERT_TRUE(handle_config_downlink(silence, sizeof(silence)));
+  TEST_ASSERT_EQUAL_UINT32(3600000, appConfig.maxsilence);
+  TEST_ASSERT_FALSE(handle_config_downlink(noSilence, sizeof(noSilence)));
+  TEST_ASSERT_EQUAL_UINT32(3600000, appConfig.maxsilence);
+}
+
+void test_downlink_interval_bounds(void)
+{
+  init_app_config();
+  TEST_ASSERT_EQUAL_UINT32(MIN_SLEEPTIME, appConfig.minsleeptime);
+  TEST_ASSERT_EQUAL_UINT32(MAX_SLEEPTIME, appConfig.maxsleeptime);
+
+  // 1 minute .. 2 hours
+  const uint8_t bounds[] = {0xA5, 0x06, 0x00, 0x00, 0xEA, 0x60, 0x00, 0x6D, 0xDD, 0x00};
+  // min > max
+  const uint8_t swapped[] = {0xA5, 0x06, 0x00, 0x6D, 0xDD, 0x00, 0x00, 0x00, 0xEA, 0x60};
+
+  TEST_ASSERT_TRUE(handle_config_downlink(bounds, sizeof(bounds)));
+  TEST_ASSERT_EQUAL_UINT32(60000, appConfig.minsleeptime);
+  TEST_ASSERT_EQUAL_UINT32(7200000, appConfig.maxsleeptime);
+  TEST_ASSERT_FALSE(handle_config_downlink(swapped, sizeof(swapped)));
+  TEST_ASSERT_EQUAL_UINT32(60000, appConfig.minsleeptime);
+}
+
+void test_downlink_unknown_ignored(void)
+{
+  init_app_config();
+  const uint8_t msg[] = {0xA5, 0x01, 0x00};
+
+  TEST_ASSERT_FALSE(handle_config_downlink(msg, sizeof(msg)));
+  TEST_ASSERT_EQUAL_UINT32(1, EEPROM.commits);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_first_boot_writes_config);
+  RUN_TEST(test_config_survives_reboot);
+  RUN_TEST(test_gpio7_low_forces_new_config);
+  RUN_TEST(test_invalid_appended_field_is_sanitized);
+  RUN_TEST(test_legacy_config_is_migrated);
+  RUN_TEST(test_downlink_sleeptime);
+  RUN_TEST(test_downlink_sleeptime_out_of_range);
+  RUN_TEST(test_downlink_aggregation);
+  RUN_TEST(test_downlink_batchsize);
+  RUN_TEST(test_downlink_deadband_and_silence);
+  RUN_TEST(test_downlink_interval_bounds);
+  RUN_TEST(test_downlink_unknown_ignored);
+  return UNITY_END();
+}
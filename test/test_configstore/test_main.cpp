@@ -0,0 +1,225 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <ConfigStore.hpp>
+#include <CRC8.hpp>
+
+typedef struct
+{
+  uint32_t value;
+  uint8_t text[40];
+} Record;
+
+static Record record;
+
+static int slotAddress(uint8_t slot)
+{
+  return CONFIG_STORE_OFFSET + slot * CONFIG_SLOT_SIZE;
+}
+
+// Valid looking record at any EEPROM address
+static void writeRaw(int address, uint32_t sequence, uint32_t value)
+{
+  uint8_t *raw = &EEPROM.data[address];
+  ConfigRecordHeader *header = (ConfigRecordHeader *)raw;
+  header->magic = CONFIG_RECORD_MAGIC;
+  header->length = sizeof(Record);
+  header->crc8 = 0;
+  header->sequence = sequence;
+  Record r;
+  memset(&r, 0x5A, sizeof(r));
+  r.value = value;
+  memcpy(raw + sizeof(ConfigRecordHeader), &r, sizeof(r));
+  header->crc8 = crc8(raw, sizeof(ConfigRecordHeader) + sizeof(r));
+}
+
+static uint32_t sequenceOf(uint8_t slot)
+{
+  return ((ConfigRecordHeader *)&EEPROM.data[slotAddress(slot)])->sequence;
+}
+
+void setUp(void)
+{
+  fake::reset();
+  memset(&record, 0x5A, sizeof(record));
+}
+
+void tearDown(void)
+{
+}
+
+void test_empty_store(void)
+{
+  TEST_ASSERT_EQUAL_UINT8(0, config_store_read(&record, sizeof(record)));
+  TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, record.value);
+}
+
+void test_write_read(void)
+{
+  record.value = 42;
+  TEST_ASSERT_TRUE(config_store_write(&record, sizeof(record)));
+
+  Record read;
+  TEST_ASSERT_EQUAL_UINT8(sizeof(record), config_store_read(&read, sizeof(read)));
+  TEST_ASSERT_EQUAL_MEMORY(&record, &read, sizeof(record));
+}
+
+void test_first_record_skips_slot_0(void)
+{
+  record.value = 1;
+  config_store_write(&record, sizeof(record));
+
+  TEST_ASSERT_EQUAL_HEX8(0xFF, EEPROM.data[slotAddress(0)]);
+  TEST_ASSERT_EQUAL_UINT32(1, sequenceOf(1));
+}
+
+void test_round_robin(void)
+{
+  for (uint32_t i = 1; i <= 2 * CONFIG_SLOTS; i++)
+  {
+    record.value = i;
+    config_store_write(&record, sizeof(record));
+  }
+
+  // slots 1, 0, 1, 0
+  TEST_ASSERT_EQUAL_UINT32(4, sequenceOf(0));
+  TEST_ASSERT_EQUAL_UINT32(3, sequenceOf(1));
+
+  Record read;
+  config_store_read(&read, sizeof(read));
+  TEST_ASSERT_EQUAL_UINT32(2 * CONFIG_SLOTS, read.value);
+}
+
+void test_torn_write_falls_back(void)
+{
+  record.value = 1;
+  config_store_write(&record, sizeof(record));
+  record.value = 2;
+  config_store_write(&record, sizeof(record));
+
+  // brownout in the middle of the newest record (slot 0)
+  EEPROM.data[slotAddress(0) + sizeof(ConfigRecordHeader) + 10] ^= 0x40;
+
+  Record read;
+  config_store_read(&read, sizeof(read));
+  TEST_ASSERT_EQUAL_UINT32(1, read.value);
+
+  // the next write goes after the valid record and wins
+  record.value = 3;
+  config_store_write(&record, sizeof(record));
+  config_store_read(&read, sizeof(read));
+  TEST_ASSERT_EQUAL_UINT32(3, read.value);
+}
+
+void test_unchanged_is_not_written(void)
+{
+  record.value = 1;
+  config_store_write(&record, sizeof(record));
+  uint32_t commits = EEPROM.commits;
+  uint32_t writes = EEPROM.writes;
+
+  TEST_ASSERT_TRUE(config_store_write(&record, sizeof(record)));
+  TEST_ASSERT_EQUAL_UINT32(commits, EEPROM.commits);
+  TEST_ASSERT_EQUAL_UINT32(writes, EEPROM.writes);
+}
+
+void test_only_changed_bytes_written(void)
+{
+  for (uint32_t i = 1; i <= CONFIG_SLOTS; i++)
+  {
+    record.value = i;
+    config_store_write(&record, sizeof(record));
+  }
+  uint32_t writes = EEPROM.writes;
+
+  // slot 1 again, only header and value differ from its old content
+  record.value = CONFIG_SLOTS + 1;
+  config_store_write(&record, sizeof(record));
+  TEST_ASSERT_TRUE(EEPROM.writes - writes <= sizeof(ConfigRecordHeader) + sizeof(record.value));
+}
+
+void test_sequence_wraps(void)
+{
+  record.value = 1;
+  config_store_write(&record, sizeof(record));
+
+  // move the newest record to the end of the sequence range
+  ConfigRecordHeader *header = (ConfigRecordHeader *)&EEPROM.data[slotAddress(1)];
+  header->sequence = 0xFFFFFFFF;
+  header->crc8 = 0;
+  header->crc8 = crc8(&EEPROM.data[slotAddress(1)], sizeof(ConfigRecordHeader) + header->length);
+
+  record.value = 2;
+  config_store_write(&record, sizeof(record));
+  TEST_ASSERT_EQUAL_UINT32(0, sequenceOf(0));
+
+  Record read;
+  config_store_read(&read, sizeof(read));
+  TEST_ASSERT_EQUAL_UINT32(2, read.value);
+}
+
+void test_shorter_record_pads_erased(void)
+{
+  record.value = 7;
+  config_store_write(&record, sizeof(record.value));
+
+  Record read;
+  TEST_ASSERT_EQUAL_UINT8(sizeof(record.value), config_store_read(&read, sizeof(read)));
+  TEST_ASSERT_EQUAL_UINT32(7, read.value);
+  TEST_ASSERT_EQUAL_HEX8(0xFF, read.text[0]);
+}
+
+void test_records_outside_store_ignored(void)
+{
+  record.value = 1;
+  config_store_write(&record, sizeof(record));
+  // leftovers in the session and backlog area are never config records
+  writeRaw(CONFIG_STORE_OFFSET + CONFIG_SLOTS * CONFIG_SLOT_SIZE, 5, 5);
+  writeRaw(256, 6, 6);
+
+  Record read;
+  TEST_ASSERT_EQUAL_UINT8(sizeof(Record), config_store_read(&read, sizeof(read)));
+  TEST_ASSERT_EQUAL_UINT32(1, read.value);
+
+  record.value = 2;
+  config_store_write(&record, sizeof(record));
+  TEST_ASSERT_EQUAL_UINT32(2, sequenceOf(0));
+}
+
+void test_too_large_rejected(void)
+{
+  uint8_t large[CONFIG_RECORD_MAX_DATA + 1] = {};
+  TEST_ASSERT_FALSE(config_store_write(large, sizeof(large)));
+  TEST_ASSERT_EQUAL_UINT32(0, EEPROM.writes);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_store);
+  RUN_TEST(test_write_read);
+  RUN_TEST(test_first_record_skips_slot_0);
+  RUN_TEST(test_round_robin);
+  RUN_TEST(test_torn_write_falls_back);
+  RUN_TEST(test_unchanged_is_not_written);
+  RUN_TEST(test_only_changed_bytes_written);
+  RUN_TEST(test_sequence_wraps);
+  RUN_TEST(test_shorter_record_pads_erased);
+  RUN_TEST(test_records_outside_store_ignored);
+  RUN_TEST(test_too_large_rejected);
+  return UNITY_END();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <chrono>
+#include <CRC8.hpp>
+
+// Correctness of the three CRC8 variants plus a host microbenchmark.
+// Timings are printed only, the host CPU says little about the
+// Cortex-M0+ but the ranking is the same.
+
+typedef uint8_t (*Crc8Function)(const uint8_t *, int);
+
+static uint8_t buffer[4096];
+
+void setUp(void)
+{
+  uint32_t seed = 0x12345678;
+  for (size_t i = 0; i < sizeof(buffer); i++)
+  {
+    seed = seed * 1664525 + 1013904223;
+    buffer[i] = seed >> 24;
+  }
+}
+
+void tearDown(void)
+{
+}
+
+void test_check_value(void)
+{
+  const uint8_t data[] = "123456789";
+  TEST_ASSERT_EQUAL_HEX8(0xF4, crc8_bitwise(data, 9));
+  TEST_ASSERT_EQUAL_HEX8(0xF4, crc8_nibble(data, 9));
+  TEST_ASSERT_EQUAL_HEX8(0xF4, crc8_table(data, 9));
+  TEST_ASSERT_EQUAL_HEX8(0xF4, crc8(data, 9));
+}
+
+void test_table_matches_bitwise(void)
+{
+  for (int i = 0; i < 256; i++)
+  {
+    uint8_t b = i;
+    TEST_ASSERT_EQUAL_HEX8(crc8_bitwise(&b, 1), crc8_detail::Tables::byte[i]);
+  }
+}
+
+void test_variants_agree(void)
+{
+  for (int length = 0; length < 64; length++)
+  {
+    uint8_t expected = crc8_bitwise(buffer + length, length);
+    TEST_ASSERT_EQUAL_HEX8(expected, crc8_nibble(buffer + length, length));
+    TEST_ASSERT_EQUAL_HEX8(expected, crc8_table(buffer + length, length));
+  }
+}
+
+static double benchmark(Crc8Function f, int length)
+{
+  const int rounds = 2000;
+  volatile uint8_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++)
+  {
+    sink ^= f(buffer, length);
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  return ns / ((double)rounds * length);
+}
+
+void test_benchmark(void)
+{
+  char line[128];
+  const int lengths[] = {10, 222, 4096};
+  for (int length : lengths)
+  {
+    snprintf(line, sizeof(line), "crc8 %4d bytes: bitwise %.2f ns/B, nibble %.2f ns/B, table %.2f ns/B",
+             length, benchmark(crc8_bitwise, length), benchmark(crc8_nibble, length),
+             benchmark(crc8_table, length));
+    TEST_MESSAGE(line);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_check_value);
+  RUN_TEST(test_table_matches_bitwise);
+  RUN_TEST(test_variants_agree);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Decoder.hpp>
+
+static Uplink uplink;
+static char lines[512];
+
+void setUp(void)
+{
+  memset(lines, 0, sizeof(lines));
+}
+
+void tearDown(void)
+{
+}
+
+void test_decode_legacy_frame(void)
+{
+  TxFrameData frame;
+  init_frame(&frame, 0x01);
+  pack_sensor_data(&frame, -1234, 4567, 98765);
+  pack_battery(&frame, 3700);
+  seal_frame(&frame);
+
+  TEST_ASSERT_EQUAL(DECODE_OK, decode_uplink(FPORT_FRAME, (uint8_t *)&frame, sizeof(frame), &uplink));
+  TEST_ASSERT_EQUAL(1, uplink.batch.count);
+  TEST_ASSERT_EQUAL(-1234, uplink.batch.samples[0].temperature);
+  TEST_ASSERT_EQUAL(4567, uplink.batch.samples[0].humidity);
+  TEST_ASSERT_EQUAL(98765, uplink.batch.samples[0].pressure);
+  TEST_ASSERT_EQUAL(3700, uplink.voltage);
+  TEST_ASSERT_EQUAL_HEX8(0x0F, uplink.fields);
+}
+
+void test_decode_compact_batch(void)
+{
+  SampleBatch batch = {};
+  SensorSample a = {2150, 4800, 98765};
+  SensorSample b = {2175, 4790, 98770};
+  batch_add(&batch, &a);
+  batch_add(&batch, &b);
+  CompactHeader header = {};
+  header.fields = COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE | COMPACT_BATTERY;
+  header.status = COMPACT_STATUS_OK;
+  header.interval = 600;
+  header.voltage = 3700;
+  uint8_t buffer[64];
+  uint8_t length = encode_compact(&header, &batch, buffer, sizeof(buffer));
+
+  TEST_ASSERT_EQUAL(DECODE_OK, decode_uplink(FPORT_COMPACT, buffer, length, &uplink));
+  TEST_ASSERT_EQUAL(2, uplink.batch.count);
+  TEST_ASSERT_EQUAL(600, uplink.interval);
+  TEST_ASSERT_EQUAL(2175, uplink.batch.samples[1].temperature);
+
+  buffer[2] ^= 0x01;
+  TEST_ASSERT_EQUAL(DECODE_CRC, decode_uplink(FPORT_COMPACT, buffer, length, &uplink));
+}
+
+void test_decode_battery_gauge(void)
+{
+  SampleBatch batch = {};
+  SensorSample a = {2150, 4800, 98765};
+  batch_add(&batch, &a);
+  uint8_t extension[16];
+  uint8_t ack[] = {0, 0, 1};
+  uint8_t gauge[] = {63, 0x01, 0x2C};
+  CompactHeader header = {};
+  header.fields = COMPACT_TEMPERATURE | COMPACT_BATTERY | COMPACT_EXTENSION;
+  header.status = COMPACT_STATUS_OK;
+  header.voltage = 3700;
+  header.extension = extension;
+  header.extensionLength = put_extension(extension, 0, sizeof(extension), COMPACT_EXT_ACK, ack, sizeof(ack));
+  header.extensionLength = put_extension(extension, header.extensionLength, sizeof(extension),
+                                         COMPACT_EXT_BATTERY, gauge, sizeof(gauge));
+  uint8_t buffer[64];
+  uint8_t length = encode_compact(&header, &batch, buffer, sizeof(buffer));
+
+  TEST_ASSERT_EQUAL(DECODE_OK, decode_uplink(FPORT_COMPACT, buffer, length, &uplink));
+  TEST_ASSERT_TRUE(uplink.gauge);
+  TEST_ASSERT_EQUAL(63, uplink.percent);
+  TEST_ASSERT_EQUAL(300, uplink.days);
+
+  format_line_protocol("node", &uplink, 5, 1000, lines, sizeof(lines));
+  TEST_ASSERT_EQUAL_STRING(
+      "node temperature=21.5,batteryVoltage=3.7,batteryPercentage=63,batteryDays=300,f_cnt=5 1000\n",
+      lines);
+}
+
+void test_decode_header_only(void)
+{
+  SampleBatch batch = {};
+  CompactHeader header = {};
+  header.fields = COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_BATTERY;
+  header.status = COMPACT_STATUS_OK | COMPACT_STATUS_SENSOR;
+  header.interval = 600;
+  header.voltage = 3700;
+  uint8_t buffer[64];
+  uint8_t length = encode_compact(&header, &batch, buffer, sizeof(buffer));
+
+  TEST_ASSERT_EQUAL(DECODE_OK, decode_uplink(FPORT_COMPACT, buffer, length, &uplink));
+  TEST_ASSERT_EQUAL(0, uplink.batch.count);
+  TEST_ASSERT_EQUAL_HEX8(COMPACT_STATUS_OK | COMPACT_STATUS_SENSOR, uplink.status);
+
+  // one point with the battery, no sensor values
+  format_line_protocol("node", &uplink, 5, 1000, lines, sizeof(lines));
+  TEST_ASSERT_EQUAL_STRING("node batteryVoltage=3.7,batteryPercentage=75,f_cnt=5 1000\n", lines);
+}
+
+void test_decode_spread(void)
+{
+  SampleBatch batch = {};
+  SensorSample a = {2150, 4800, 98765};
+  SensorSample b = {2160, 4790, 98770};
+  batch_add(&batch, &a);
+  batch_add(&batch, &b);
+  uint8_t extension[16];
+  uint8_t spread[] = {COMPACT_TEMPERATURE | COMPACT_PRESSURE, 0x00, 0x0C, 0x01, 0x2C};
+  CompactHeader header = {};
+  header.fields = COMPACT_TEMPERATURE | COMPACT_PRESSURE | COMPACT_EXTENSION;
+  header.status = COMPACT_STATUS_OK;
+  header.interval = 60;
+  header.extension = extension;
+  header.extensionLength = put_extension(extension, 0, sizeof(extension), COMPACT_EXT_SPREAD, spread, sizeof(spread));
+  uint8_t buffer[64];
+  uint8_t length = encode_compact(&header, &batch, buffer, sizeof(buffer));
+
+  TEST_ASSERT_EQUAL(DECODE_OK, decode_uplink(FPORT_COMPACT, buffer, length, &uplink));
+  TEST_ASSERT_TRUE(uplink.spread);
+  TEST_ASSERT_EQUAL(12, uplink.deviation.temperature);
+  TEST_ASSERT_EQUAL(300, uplink.deviation.pressure);
+
+  // only the last sample carries it
+  format_line_protocol("node", &uplink, 5, 60000000000ULL, lines, sizeof(lines));
+  TEST_ASSERT_EQUAL_STRING(
+      "node temperature=21.5,pressure=987.65,f_cnt=5 0\n"
+      "node temperature=21.6,pressure=987.7,temperatureSpread=0.12,pressureSpread=3,f_cnt=5 60000000000\n",
+      lines);
+
+  // a value that does not match its flags is ignored
+  spread[0] |= COMPACT_HUMIDITY;
+  header.extensionLength = put_extension(extension, 0, sizeof(extension), COMPACT_EXT_SPREAD, spread, sizeof(spread));
+  length = encode_compact(&header, &batch, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL(DECODE_OK, decode_uplink(FPORT_COMPACT, buffer, length, &uplink));
+  TEST_ASSERT_FALSE(uplink.spread);
+}
+
+void test_decode_backlog(void)
+{
+  SensorSample samples[] = {{-505, 4800, 98765}, {2175, 4790, 98770}};
+  uint16_t ages[] = {90, 30};
+  uint8_t buffer[64];
+  uint8_t length = encode_backlog(COMPACT_TEMPERATURE | COMPACT_PRESSURE, true, samples, ages, 2,
+                                  buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL(3 + 2 * 6, length);
+
+  TEST_ASSERT_EQUAL(DECODE_OK, decode_uplink(FPORT_BACKLOG, buffer, length, &uplink));
+  TEST_ASSERT_TRUE(uplink.rebased);
+  TEST_ASSERT_EQUAL(2, uplink.batch.count);
+  TEST_ASSERT_EQUAL(30, uplink.ages[1]);
+
+  format_line_protocol("node", &uplink, 9, 1700000000000000000ULL, lines, sizeof(lines));
+  TEST_ASSERT_EQUAL_STRING(
+      "node temperature=-5.05,pressure=987.65,f_cnt=9 1699994600000000000\n"
+      "node temperature=21.75,pressure=987.7,f_cnt=9 1699998200000000000\n",
+      lines);
+
+  buffer[3] ^= 0x01;
+  TEST_ASSERT_EQUAL(DECODE_CRC, decode_uplink(FPORT_BACKLOG, buffer, length, &uplink));
+}
+
+void test_decode_errors(void)
+{
+  uint8_t buffer[] = {0x5A, 0x01, 0x00};
+  TEST_ASSERT_EQUAL(DECODE_PORT, decode_uplink(10, buffer, sizeof(buffer), &uplink));
+  TEST_ASSERT_EQUAL(DECODE_LENGTH, decode_uplink(FPORT_FRAME, buffer, sizeof(buffer), &uplink));
+  TEST_ASSERT_EQUAL(DECODE_LENGTH, decode_uplink(FPORT_COMPACT, buffer, 2, &uplink));
+
+  // version 2
+  uint8_t compact[] = {0x80, 0x01, 0x00};
+  compact[2] = crc8(compact, 2);
+  TEST_ASSERT_EQUAL(DECODE_FORMAT, decode_uplink(FPORT_COMPACT, compact, sizeof(compact), &uplink));
+}
+
+void test_battery_percentage(void)
+{
+  TEST_ASSERT_EQUAL(0, battery_percentage(2000));
+  TEST_ASSERT_EQUAL(75, battery_percentage(3700));
+  TEST_ASSERT_EQUAL(100, battery_percentage(4550));
+}
+
+void test_line_protocol(void)
+{
+  memset(&uplink, 0, sizeof(uplink));
+  uplink.fields = COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE | COMPACT_BATTERY;
+  uplink.interval = 600;
+  uplink.voltage = 3700;
+  uplink.batch.count = 2;
+  uplink.batch.samples[0] = {-505, 4800, 98765};
+  uplink.batch.samples[1] = {2175, 4790, 98770};
+
+  size_t n = format_line_protocol("node 1", &uplink, 42, 1700000000000000000ULL, lines, sizeof(lines));
+  TEST_ASSERT_EQUAL_STRING(
+      "node\\ 1 temperature=-5.05,humidity=48,pressure=987.65,batteryVoltage=3.7,batteryPercentage=75,f_cnt=42 1699999400000000000\n"
+      "node\\ 1 temperature=21.75,humidity=47.9,pressure=987.7,batteryVoltage=3.7,batteryPercentage=75,f_cnt=42 1700000000000000000\n",
+      lines);
+  TEST_ASSERT_EQUAL(strlen(lines), n);
+}
+
+void test_line_protocol_battery_only(void)
+{
+  memset(&uplink, 0, sizeof(uplink));
+  uplink.fields = COMPACT_BATTERY;
+  uplink.voltage = 3300;
+  uplink.batch.count = 1;
+  format_line_protocol("node", &uplink, 7, 1000, lines, sizeof(lines));
+  TEST_ASSERT_EQUAL_STRING("node batteryVoltage=3.3,batteryPercentage=50,f_cnt=7 1000\n", lines);
+}
+
+void test_line_protocol_too_small(void)
+{
+  memset(&uplink, 0, sizeof(uplink));
+  uplink.fields = COMPACT_BATTERY;
+  uplink.voltage = 3300;
+  uplink.batch.count = 1;
+  TEST_ASSERT_EQUAL(0, format_line_protocol("node", &uplink, 7, 1000, lines, 16));
+  TEST_ASSERT_EQUAL_STRING("", lines);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_decode_legacy_frame);
+  RUN_TEST(test_decode_compact_batch);
+  RUN_TEST(test_decode_battery_gauge);
+  RUN_TEST(test_decode_header_only);
+  RUN_TEST(test_decode_spread);
+  RUN_TEST(test_decode_backlog);
+  RUN_TEST(test_decode_errors);
+  RUN_TEST(test_battery_percentage);
+  RUN_TEST(test_line_protocol);
+  RUN_TEST(test_line_protocol_battery_only);
+  RUN_TEST(test_line_protocol_too_small);
+  return UNITY_END();
+}
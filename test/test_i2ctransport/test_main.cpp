@@ -0,0 +1,123 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <FakeBME280.h>
+#include <I2CTransport.hpp>
+
+#define ADDRESS 0x76
+
+static FakeBME280 device;
+static I2CTransport bus;
+
+void setUp(void)
+{
+  fake::reset();
+  device = FakeBME280();
+  Wire.attach(ADDRESS, &device);
+  bus.begin(ADDRESS);
+  i2c_clear_counters();
+}
+
+void tearDown(void)
+{
+}
+
+void test_burst_read(void)
+{
+  uint8_t data[3];
+  TEST_ASSERT_TRUE(bus.read(0x88, data, sizeof(data)));
+  TEST_ASSERT_EQUAL_HEX8(0x70, data[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x6B, data[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x43, data[2]);
+  TEST_ASSERT_EQUAL(2, device.transactions);
+}
+
+void test_burst_write(void)
+{
+  const uint8_t data[] = {0x01, 0x24};
+  TEST_ASSERT_TRUE(bus.write(0xF2, data, sizeof(data)));
+  TEST_ASSERT_EQUAL_HEX8(0x01, device.registers[0xF2]);
+  TEST_ASSERT_EQUAL(1, device.transactions);
+  TEST_ASSERT_EQUAL(3, device.bytesWritten);
+}
+
+void test_retry_with_backoff(void)
+{
+  uint8_t value;
+  device.nackNext = 2;
+  TEST_ASSERT_TRUE(bus.read8(0xD0, &value));
+  TEST_ASSERT_EQUAL_HEX8(0x60, value);
+  // 1 ms and 2 ms backoff
+  TEST_ASSERT_EQUAL(3 * I2C_BACKOFF, fake::clock);
+  TEST_ASSERT_EQUAL(2, i2cCounters.errors);
+  TEST_ASSERT_EQUAL(2, i2cCounters.retries);
+  TEST_ASSERT_EQUAL(0, i2cCounters.failures);
+}
+
+void test_give_up_after_attempts(void)
+{
+  uint8_t value = 0x55;
+  device.nackEvery = 1;
+  TEST_ASSERT_FALSE(bus.read8(0xD0, &value));
+  TEST_ASSERT_EQUAL_HEX8(0x55, value);
+  TEST_ASSERT_EQUAL(I2C_ATTEMPTS, device.nacks);
+  TEST_ASSERT_EQUAL(I2C_ATTEMPTS, i2cCounters.errors);
+  TEST_ASSERT_EQUAL(I2C_ATTEMPTS - 1, i2cCounters.retries);
+  TEST_ASSERT_EQUAL(1, i2cCounters.failures);
+}
+
+void test_short_read_is_drained(void)
+{
+  uint8_t data[2];
+  device.shortReadNext = 1;
+  TEST_ASSERT_TRUE(bus.read(0x88, data, sizeof(data)));
+  TEST_ASSERT_EQUAL_HEX8(0x70, data[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x6B, data[1]);
+  TEST_ASSERT_EQUAL(1, i2cCounters.errors);
+}
+
+void test_missing_device(void)
+{
+  uint8_t value;
+  Wire.detachAll();
+  TEST_ASSERT_FALSE(bus.read8(0xD0, &value));
+  TEST_ASSERT_FALSE(bus.write8(0xF4, 0));
+  TEST_ASSERT_EQUAL(2, i2cCounters.failures);
+}
+
+void test_counters_saturate(void)
+{
+  uint8_t value;
+  i2cCounters.errors = 0xFFFF;
+  device.nackNext = 1;
+  TEST_ASSERT_TRUE(bus.read8(0xD0, &value));
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, i2cCounters.errors);
+  TEST_ASSERT_EQUAL(1, i2cCounters.retries);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_burst_read);
+  RUN_TEST(test_burst_write);
+  RUN_TEST(test_retry_with_backoff);
+  RUN_TEST(test_give_up_after_attempts);
+  RUN_TEST(test_short_read_is_drained);
+  RUN_TEST(test_missing_device);
+  RUN_TEST(test_counters_saturate);
+  return UNITY_END();
+}
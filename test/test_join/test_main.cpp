@@ -0,0 +1,231 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Join.hpp>
+
+#define HOUR 3600000UL
+
+static JoinState state;
+
+void setUp(void)
+{
+  fake::reset();
+  join_init(&state, 0, 0);
+}
+
+void tearDown(void)
+{
+}
+
+void test_airtime(void)
+{
+  TEST_ASSERT_EQUAL(1483, join_airtime(0));
+  TEST_ASSERT_EQUAL(62, join_airtime(5));
+  TEST_ASSERT_EQUAL(1483, join_airtime(7));
+}
+
+void test_trials(void)
+{
+  int8_t expected[] = {5, 5, 5, 5, 5, 5, 5, 4};
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    TEST_ASSERT_EQUAL(expected[i], join_trial_datarate(i + 1));
+  }
+  TEST_ASSERT_EQUAL(3, join_trial_datarate(16));
+  TEST_ASSERT_EQUAL(2, join_trial_datarate(24));
+  TEST_ASSERT_EQUAL(1, join_trial_datarate(32));
+  TEST_ASSERT_EQUAL(0, join_trial_datarate(48));
+  for (int8_t dr = 0; dr <= 5; dr++)
+  {
+    TEST_ASSERT_EQUAL(dr, join_trial_datarate(join_trials(dr)));
+  }
+}
+
+void test_first_attempt_jitter(void)
+{
+  JoinAttempt a = join_next(&state, 0);
+  TEST_ASSERT_TRUE(a.wait < JOIN_FIRST_JITTER);
+  TEST_ASSERT_EQUAL(JOIN_DR_MAX, a.datarate);
+}
+
+void test_backoff_doubles_with_jitter(void)
+{
+  uint32_t now = 0;
+  uint32_t backoff = JOIN_BACKOFF_MIN;
+  JoinAttempt a = join_next(&state, now);
+  now += a.wait;
+  join_attempted(&state, &a, now);
+
+  for (int i = 0; i < 5; i++)
+  {
+    a = join_next(&state, now);
+    TEST_ASSERT_TRUE(a.wait >= backoff / 2);
+    TEST_ASSERT_TRUE(a.wait <= backoff);
+    now += a.wait;
+    join_attempted(&state, &a, now);
+    backoff *= 2;
+  }
+  TEST_ASSERT_EQUAL(6, state.attempts);
+}
+
+void test_backoff_is_capped(void)
+{
+  uint32_t now = 0;
+  for (int i = 0; i < 20; i++)
+  {
+    JoinAttempt a = join_next(&state, now);
+    TEST_ASSERT_TRUE(a.wait <= JOIN_BACKOFF_MAX + JOIN_BACKOFF_MIN || a.wait <= 24 * HOUR);
+    now += a.wait;
+    join_attempted(&state, &a, now);
+  }
+  TEST_ASSERT_EQUAL(JOIN_BACKOFF_MAX, state.backoff);
+}
+
+void test_datarate_rotation(void)
+{
+  int8_t expected[] = {5, 4, 3, 2, 1, 0, 5};
+  uint8_t trials[] = {1, 8, 16, 24, 32, 48, 1};
+  for (int i = 0; i < 7; i++)
+  {
+    JoinAttempt a = join_next(&state, 0);
+    TEST_ASSERT_EQUAL(expected[i], a.datarate);
+    TEST_ASSERT_EQUAL(trials[i], a.trials);
+    join_attempted(&state, &a, 0);
+  }
+
+  // all trials are on air: 7 x DR5 and DR4
+  state.attempts = 1;
+  JoinAttempt a = join_next(&state, 0);
+  TEST_ASSERT_EQUAL(7 * 62 + 114, a.airtime);
+  TEST_ASSERT_EQUAL(a.airtime * 100 + 8 * JOIN_RX_WINDOWS, a.timeout);
+}
+
+void test_channel_rotation(void)
+{
+  uint16_t expected[] = {0x0001, 0x0002, 0x0004, 0x0001};
+  for (int i = 0; i < 4; i++)
+  {
+    JoinAttempt a = join_next(&state, 0);
+    TEST_ASSERT_EQUAL_HEX16(expected[i], a.channelsMask);
+    join_attempted(&state, &a, 0);
+  }
+
+  // only enabled default channels, the rotation starts at the seed
+  userChannelsMask[0] = 0x00FA; // channels 1, 3..7
+  join_init(&state, 0, 1);
+  TEST_ASSERT_EQUAL_HEX16(0x0002, join_next(&state, 0).channelsMask);
+}
+
+void test_duty_cycle_budget(void)
+{
+  // 36 s in the first hour: DR0 requests of 1483 ms, 24 fit
+  uint32_t now = 0;
+  uint32_t airtime = 0;
+  JoinAttempt a;
+  a.datarate = 0;
+  a.airtime = join_airtime(0);
+  for (int i = 0; i < 24; i++)
+  {
+    join_attempted(&state, &a, now);
+    airtime += a.airtime;
+  }
+  TEST_ASSERT_EQUAL(airtime, state.periodAirtime);
+
+  // the next attempt reaching DR0 would exceed the budget and moves to the next period
+  state.attempts = 5; // DR0
+  a = join_next(&state, 60000);
+  TEST_ASSERT_EQUAL(0, a.datarate);
+  TEST_ASSERT_TRUE(60000 + a.wait >= HOUR);
+  TEST_ASSERT_TRUE(60000 + a.wait < HOUR + JOIN_BACKOFF_MIN);
+}
+
+void test_daily_budget_after_11_hours(void)
+{
+  JoinAttempt a;
+  a.datarate = 0;
+  a.airtime = join_airtime(0);
+  // 5 attempts at DR0 fit into 8.7 s
+  uint32_t now = 12 * HOUR;
+  for (int i = 0; i < 5; i++)
+  {
+    join_attempted(&state, &a, now);
+  }
+  TEST_ASSERT_EQUAL(11 * HOUR, state.periodStart);
+  state.attempts = 5;
+  a = join_next(&state, now);
+  TEST_ASSERT_TRUE(now + a.wait >= 35 * HOUR);
+}
+
+void test_apply_and_restore(void)
+{
+  JoinAttempt a = join_next(&state, 0);
+  join_apply(&a);
+  TEST_ASSERT_EQUAL_HEX16(a.channelsMask, LoRaWAN.channelsMask);
+
+  join_restore();
+  TEST_ASSERT_EQUAL_HEX16(0x00FF, LoRaWAN.channelsMask);
+}
+
+void test_request_drives_datarate(void)
+{
+  uint8_t eui[8] = {};
+  uint8_t key[16] = {};
+
+  // the core ignores MIB_CHANNELS_DATARATE, a single trial is DR5
+  MibRequestConfirm_t mib;
+  mib.Type = MIB_CHANNELS_DATARATE;
+  mib.Param.ChannelsDatarate = 0;
+  LoRaMacMibSetRequestConfirm(&mib);
+  LoRaWAN.joinOTAA(eui, key, eui);
+  TEST_ASSERT_EQUAL(5, LoRaWAN.joinDatarate);
+
+  // the second attempt reaches DR4 with its 8th trial
+  LoRaWAN.joinLostTrials = 7;
+  state.attempts = 1;
+  JoinAttempt a = join_next(&state, 0);
+  TEST_ASSERT_EQUAL(LORAMAC_STATUS_OK, join_request(&a, eui, key, eui));
+  TEST_ASSERT_TRUE(LoRaWAN.isJoined());
+  TEST_ASSERT_EQUAL(8, LoRaWAN.joinNbTrials);
+  TEST_ASSERT_EQUAL(4, LoRaWAN.joinDatarate);
+  TEST_ASSERT_EQUAL(9, LoRaWAN.joinTrials);
+
+  // without an accept all trials are sent
+  LoRaWAN.joinResult = false;
+  state.attempts = 5;
+  a = join_next(&state, 0);
+  join_request(&a, eui, key, eui);
+  TEST_ASSERT_FALSE(LoRaWAN.isJoined());
+  TEST_ASSERT_EQUAL(0, LoRaWAN.joinDatarate);
+  TEST_ASSERT_EQUAL(9 + 48, LoRaWAN.joinTrials);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_airtime);
+  RUN_TEST(test_trials);
+  RUN_TEST(test_first_attempt_jitter);
+  RUN_TEST(test_backoff_doubles_with_jitter);
+  RUN_TEST(test_backoff_is_capped);
+  RUN_TEST(test_datarate_rotation);
+  RUN_TEST(test_channel_rotation);
+  RUN_TEST(test_duty_cycle_budget);
+  RUN_TEST(test_daily_budget_after_11_hours);
+  RUN_TEST(test_apply_and_restore);
+  RUN_TEST(test_request_drives_datarate);
+  return UNITY_END();
+}
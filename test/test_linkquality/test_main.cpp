@@ -0,0 +1,195 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <LinkQuality.hpp>
+
+static LinkState linkState;
+
+void setUp(void)
+{
+  fake::reset();
+  link_init(&linkState);
+}
+
+void tearDown(void)
+{
+}
+
+// n downlinks at DR5 (floor -7 dB) with the given SNR
+static void downlinks(uint8_t n, int8_t snr)
+{
+  for (uint8_t i = 0; i < n; i++)
+  {
+    link_downlink(&linkState, -90, snr, 0, 5);
+  }
+}
+
+static void uplinks(uint8_t n, uint8_t every)
+{
+  for (uint8_t i = 0; i < n; i++)
+  {
+    bool confirmed = link_confirm(&linkState, every);
+    link_sent(&linkState, confirmed, true);
+  }
+}
+
+void test_margin_and_window(void)
+{
+  TEST_ASSERT_EQUAL(LINK_MARGIN_UNKNOWN, link_margin(&linkState));
+  TEST_ASSERT_EQUAL(0, link_rssi(&linkState));
+
+  link_downlink(&linkState, -100, 3, 0, 5);   // 10 dB
+  link_downlink(&linkState, -110, -10, 0, 0); // 10 dB at SF12
+  TEST_ASSERT_EQUAL(10, link_margin(&linkState));
+  TEST_ASSERT_EQUAL(-105, link_rssi(&linkState));
+
+  // the oldest samples leave the window
+  downlinks(LINK_WINDOW, 13);
+  TEST_ASSERT_EQUAL(LINK_WINDOW, linkState.count);
+  TEST_ASSERT_EQUAL(20, link_margin(&linkState));
+  TEST_ASSERT_EQUAL(-90, link_rssi(&linkState));
+}
+
+void test_rx2_offset(void)
+{
+  link_downlink(&linkState, -80, 10, 1, 0);
+  TEST_ASSERT_EQUAL(30 - LINK_RX2_OFFSET, link_margin(&linkState));
+  TEST_ASSERT_EQUAL(1, linkState.samples[0].rxSlot);
+}
+
+void test_confirm_every_nth(void)
+{
+  uint8_t confirmed = 0;
+  for (uint8_t i = 0; i < 12; i++)
+  {
+    bool c = link_confirm(&linkState, 3);
+    confirmed += c;
+    link_sent(&linkState, c, true);
+  }
+  TEST_ASSERT_EQUAL(4, confirmed);
+  TEST_ASSERT_EQUAL(4, linkState.confirmed);
+  TEST_ASSERT_EQUAL(4, linkState.acked);
+}
+
+void test_no_confirm_on_good_link(void)
+{
+  downlinks(LINK_WINDOW, 5);
+  for (uint8_t i = 0; i < 20; i++)
+  {
+    TEST_ASSERT_FALSE(link_confirm(&linkState, 0));
+    link_sent(&linkState, false, true);
+  }
+}
+
+void test_low_margin_confirms(void)
+{
+  downlinks(2, -5); // 2 dB
+  TEST_ASSERT_TRUE(link_degraded(&linkState));
+  uplinks(LINK_CONFIRM_DEGRADED - 1, 0);
+  TEST_ASSERT_EQUAL(0, linkState.confirmed);
+  TEST_ASSERT_TRUE(link_confirm(&linkState, 0));
+  TEST_ASSERT_TRUE(link_confirm(&linkState, 100));
+}
+
+void test_margin_drop_degrades(void)
+{
+  downlinks(LINK_WINDOW - 1, 13); // 20 dB
+  TEST_ASSERT_FALSE(link_degraded(&linkState));
+  link_downlink(&linkState, -120, 3, 0, 5); // 10 dB
+  TEST_ASSERT_TRUE(link_degraded(&linkState));
+}
+
+void test_missed_ack_degrades(void)
+{
+  downlinks(LINK_WINDOW, 13);
+  link_sent(&linkState, true, false);
+  TEST_ASSERT_EQUAL(1, linkState.missedAcks);
+  TEST_ASSERT_TRUE(link_degraded(&linkState));
+  link_sent(&linkState, true, true);
+  TEST_ASSERT_EQUAL(0, linkState.missedAcks);
+  TEST_ASSERT_FALSE(link_degraded(&linkState));
+  TEST_ASSERT_EQUAL(2, linkState.confirmed);
+  TEST_ASSERT_EQUAL(1, linkState.acked);
+}
+
+void test_adjust_reduces_power_on_good_link(void)
+{
+  downlinks(LINK_WINDOW, 13);
+  TEST_ASSERT_TRUE(link_adjust(&linkState, 5));
+  TEST_ASSERT_EQUAL(1, linkState.txPower);
+
+  // held for LINK_HOLD uplinks
+  TEST_ASSERT_FALSE(link_adjust(&linkState, 5));
+  for (uint8_t i = 0; i < LINK_TX_POWER_MIN * LINK_HOLD; i++)
+  {
+    link_sent(&linkState, false, false);
+    link_adjust(&linkState, 5);
+  }
+  TEST_ASSERT_EQUAL(LINK_TX_POWER_MIN, linkState.txPower);
+  TEST_ASSERT_EQUAL(0, linkState.datarateDrop);
+}
+
+void test_adjust_on_degraded_link(void)
+{
+  linkState.txPower = 4;
+  downlinks(LINK_WINDOW, -5);
+
+  // full power first
+  TEST_ASSERT_TRUE(link_adjust(&linkState, 2));
+  TEST_ASSERT_EQUAL(LINK_TX_POWER_MAX, linkState.txPower);
+
+  // then down to DR0
+  for (uint8_t i = 0; i < 20; i++)
+  {
+    link_sent(&linkState, false, false);
+    link_adjust(&linkState, 2);
+  }
+  TEST_ASSERT_EQUAL(2, linkState.datarateDrop);
+
+  // and back once the margin recovered
+  downlinks(LINK_WINDOW, 13);
+  for (uint8_t i = 0; i < LINK_HOLD; i++)
+  {
+    link_sent(&linkState, false, false);
+  }
+  TEST_ASSERT_TRUE(link_adjust(&linkState, 2));
+  TEST_ASSERT_EQUAL(1, linkState.datarateDrop);
+  TEST_ASSERT_EQUAL(LINK_TX_POWER_MAX, linkState.txPower);
+}
+
+void test_adjust_keeps_medium_link(void)
+{
+  downlinks(LINK_WINDOW, 3); // 10 dB
+  TEST_ASSERT_FALSE(link_adjust(&linkState, 5));
+  TEST_ASSERT_EQUAL(LINK_TX_POWER_MAX, linkState.txPower);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_margin_and_window);
+  RUN_TEST(test_rx2_offset);
+  RUN_TEST(test_confirm_every_nth);
+  RUN_TEST(test_no_confirm_on_good_link);
+  RUN_TEST(test_low_margin_confirms);
+  RUN_TEST(test_margin_drop_degrades);
+  RUN_TEST(test_missed_ack_degrades);
+  RUN_TEST(test_adjust_reduces_power_on_good_link);
+  RUN_TEST(test_adjust_on_degraded_link);
+  RUN_TEST(test_adjust_keeps_medium_link);
+  return UNITY_END();
+}
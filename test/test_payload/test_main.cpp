@@ -0,0 +1,277 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Payload.hpp>
+
+#define COMPACT_FIELDS (COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE | COMPACT_BATTERY)
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_crc8_check_value(void)
+{
+  // CRC-8/SMBUS check value
+  const uint8_t data[] = "123456789";
+  TEST_ASSERT_EQUAL_HEX8(0xF4, crc8(data, 9));
+}
+
+void test_crc8_empty(void)
+{
+  TEST_ASSERT_EQUAL_HEX8(0x00, crc8(NULL, 0));
+}
+
+void test_frame_layout(void)
+{
+  TEST_ASSERT_EQUAL(10, sizeof(TxFrameData));
+
+  TxFrameData frame;
+  init_frame(&frame, 0x01);
+  pack_sensor_data(&frame, -1234, 5678, 101325);
+  pack_battery(&frame, 3700);
+  seal_frame(&frame);
+
+  const uint8_t *bytes = (const uint8_t *)&frame;
+  const uint8_t expected[] = {
+      0x5A, 0x01,
+      0x2E, 0xFB, // -1234 LE
+      0x2E, 0x16, // 5678 LE
+      0x4D, 0x53, // 101325 - 80000 = 21325 LE
+      170,        // (3700 - 2000) / 10
+  };
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, bytes, sizeof(expected));
+  TEST_ASSERT_EQUAL_HEX8(crc8(bytes, 9), bytes[9]);
+}
+
+void test_battery_clamped(void)
+{
+  TxFrameData frame;
+  pack_battery(&frame, 1500);
+  TEST_ASSERT_EQUAL_UINT8(0, frame.battery);
+  pack_battery(&frame, 5000);
+  TEST_ASSERT_EQUAL_UINT8(255, frame.battery);
+}
+
+static SensorSample sample(int32_t temperature, int32_t humidity, int32_t pressure)
+{
+  SensorSample s = {temperature, humidity, pressure};
+  return s;
+}
+
+static CompactHeader header(uint8_t fields)
+{
+  CompactHeader h = {};
+  h.fields = fields;
+  h.status = 0x01;
+  h.interval = 1200;
+  h.voltage = 3700;
+  return h;
+}
+
+void test_compact_single_sample_layout(void)
+{
+  SampleBatch batch = {};
+  SensorSample s = sample(2150, 4500, 101300);
+  batch_add(&batch, &s);
+
+  CompactHeader h = header(COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE | COMPACT_BATTERY);
+  uint8_t buffer[COMPACT_MAX_SIZE];
+  uint8_t length = encode_compact(&h, &batch, buffer, sizeof(buffer));
+
+  const uint8_t expected[] = {
+      0x4F,       // version 1, T H P B
+      0x01,       // status
+      170,        // battery
+      0xCC, 0x21, // zig-zag(2150) = 4300
+      0xA8, 0x46, // zig-zag(4500) = 9000
+      0x31,       // zig-zag(101300 - 101325) = 49
+  };
+  TEST_ASSERT_EQUAL(sizeof(expected) + 1, length);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, sizeof(expected));
+  TEST_ASSERT_EQUAL_HEX8(crc8(buffer, sizeof(expected)), buffer[sizeof(expected)]);
+  TEST_ASSERT_EQUAL(length, encode_compact(&h, &batch, NULL, sizeof(buffer)));
+}
+
+void test_compact_battery_only(void)
+{
+  SampleBatch batch = {};
+  SensorSample s = {};
+  batch_add(&batch, &s);
+
+  CompactHeader h = header(COMPACT_BATTERY);
+  uint8_t buffer[COMPACT_MAX_SIZE];
+  TEST_ASSERT_EQUAL(4, encode_compact(&h, &batch, buffer, sizeof(buffer)));
+  TEST_ASSERT_EQUAL_HEX8(0x48, buffer[0]);
+}
+
+void test_compact_header_only(void)
+{
+  SampleBatch batch = {};
+  const uint8_t extension[] = {COMPACT_EXT_BATTERY, 3, 63, 0x01, 0x2C};
+  CompactHeader h = header(COMPACT_FIELDS | COMPACT_EXTENSION);
+  h.status |= COMPACT_STATUS_SENSOR;
+  h.extension = extension;
+  h.extensionLength = sizeof(extension);
+
+  uint8_t buffer[COMPACT_MAX_SIZE];
+  uint8_t length = encode_compact(&h, &batch, buffer, sizeof(buffer));
+  // header, status, count, interval (2), battery, extension, crc8
+  TEST_ASSERT_EQUAL(6 + sizeof(extension) + 1, length);
+  TEST_ASSERT_EQUAL_HEX8(0x40 | COMPACT_BATCH | COMPACT_FIELDS | COMPACT_EXTENSION, buffer[0]);
+  TEST_ASSERT_EQUAL(0, buffer[2]);
+
+  CompactHeader decoded;
+  SampleBatch out;
+  TEST_ASSERT_TRUE(decode_compact(buffer, length, &decoded, &out));
+  TEST_ASSERT_EQUAL(0, out.count);
+  TEST_ASSERT_EQUAL_HEX8(COMPACT_STATUS_OK | COMPACT_STATUS_SENSOR, decoded.status);
+  TEST_ASSERT_EQUAL_UINT16(3700, decoded.voltage);
+  TEST_ASSERT_EQUAL(sizeof(extension), decoded.extensionLength);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(extension, decoded.extension, sizeof(extension));
+}
+
+void test_compact_batch_roundtrip(void)
+{
+  SampleBatch batch = {};
+  const SensorSample samples[] = {
+      sample(2150, 4500, 101325),
+      sample(2160, 4490, 101300),
+      sample(-520, 9950, 99000), // large jumps are fine
+      sample(-521, 9950, 99000),
+  };
+  for (const SensorSample &s : samples)
+  {
+    TEST_ASSERT_TRUE(batch_add(&batch, &s));
+  }
+
+  CompactHeader h = header(COMPACT_FIELDS);
+  uint8_t buffer[COMPACT_MAX_SIZE];
+  uint8_t length = encode_compact(&h, &batch, buffer, sizeof(buffer));
+  TEST_ASSERT_GREATER_THAN(0, length);
+  TEST_ASSERT_LESS_THAN(4 * sizeof(TxFrameData), length);
+
+  CompactHeader decoded;
+  SampleBatch out;
+  TEST_ASSERT_TRUE(decode_compact(buffer, length, &decoded, &out));
+  TEST_ASSERT_EQUAL(COMPACT_VERSION, decoded.version);
+  TEST_ASSERT_EQUAL_HEX8(COMPACT_FIELDS, decoded.fields);
+  TEST_ASSERT_EQUAL_UINT32(1200, decoded.interval);
+  TEST_ASSERT_EQUAL_UINT16(3700, decoded.voltage);
+  TEST_ASSERT_EQUAL(4, out.count);
+  for (int i = 0; i < 4; i++)
+  {
+    TEST_ASSERT_EQUAL_INT32(samples[i].temperature, out.samples[i].temperature);
+    TEST_ASSERT_EQUAL_INT32(samples[i].humidity, out.samples[i].humidity);
+    TEST_ASSERT_EQUAL_INT32(samples[i].pressure, out.samples[i].pressure);
+  }
+}
+
+void test_compact_extension(void)
+{
+  SampleBatch batch = {};
+  SensorSample s = sample(2150, 4500, 101325);
+  batch_add(&batch, &s);
+
+  const uint8_t extension[] = {0x7F, 0x02, 0xAB, 0xCD};
+  CompactHeader h = header(COMPACT_FIELDS | COMPACT_EXTENSION);
+  h.extension = extension;
+  h.extensionLength = sizeof(extension);
+
+  uint8_t buffer[COMPACT_MAX_SIZE];
+  uint8_t length = encode_compact(&h, &batch, buffer, sizeof(buffer));
+
+  CompactHeader decoded;
+  SampleBatch out;
+  TEST_ASSERT_TRUE(decode_compact(buffer, length, &decoded, &out));
+  TEST_ASSERT_EQUAL(sizeof(extension), decoded.extensionLength);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(extension, decoded.extension, sizeof(extension));
+}
+
+void test_put_extension(void)
+{
+  uint8_t buffer[8];
+  const uint8_t ack[] = {0x00, 0x00, 0x03};
+
+  uint8_t length = put_extension(buffer, 0, sizeof(buffer), COMPACT_EXT_ACK, ack, sizeof(ack));
+  const uint8_t expected[] = {COMPACT_EXT_ACK, 0x03, 0x00, 0x00, 0x03};
+  TEST_ASSERT_EQUAL(5, length);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, sizeof(expected));
+
+  // a second record does not fit
+  TEST_ASSERT_EQUAL(5, put_extension(buffer, length, sizeof(buffer), COMPACT_EXT_ACK, ack, sizeof(ack)));
+}
+
+void test_compact_rejects_corrupt_frames(void)
+{
+  SampleBatch batch = {};
+  SensorSample s = sample(2150, 4500, 101325);
+  batch_add(&batch, &s);
+
+  CompactHeader h = header(COMPACT_FIELDS);
+  uint8_t buffer[COMPACT_MAX_SIZE];
+  uint8_t length = encode_compact(&h, &batch, buffer, sizeof(buffer));
+
+  CompactHeader decoded;
+  SampleBatch out;
+  buffer[3] ^= 0x01;
+  TEST_ASSERT_FALSE(decode_compact(buffer, length, &decoded, &out));
+
+  // valid crc8, but a varint runs past the end
+  buffer[3] ^= 0x01;
+  buffer[length - 2] |= 0x80;
+  buffer[length - 1] = crc8(buffer, length - 1);
+  TEST_ASSERT_FALSE(decode_compact(buffer, length, &decoded, &out));
+
+  // unknown version
+  buffer[0] = (2 << 6) | COMPACT_BATTERY;
+  buffer[length - 1] = crc8(buffer, length - 1);
+  TEST_ASSERT_FALSE(decode_compact(buffer, length, &decoded, &out));
+}
+
+void test_compact_too_small_buffer(void)
+{
+  SampleBatch batch = {};
+  SensorSample s = sample(2150, 4500, 101325);
+  batch_add(&batch, &s);
+
+  CompactHeader h = header(COMPACT_FIELDS);
+  uint8_t buffer[COMPACT_MAX_SIZE];
+  uint8_t length = encode_compact(&h, &batch, NULL, sizeof(buffer));
+  TEST_ASSERT_EQUAL(0, encode_compact(&h, &batch, buffer, length - 1));
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_crc8_check_value);
+  RUN_TEST(test_crc8_empty);
+  RUN_TEST(test_frame_layout);
+  RUN_TEST(test_battery_clamped);
+  RUN_TEST(test_compact_single_sample_layout);
+  RUN_TEST(test_compact_battery_only);
+  RUN_TEST(test_compact_header_only);
+  RUN_TEST(test_compact_batch_roundtrip);
+  RUN_TEST(test_compact_extension);
+  RUN_TEST(test_put_extension);
+  RUN_TEST(test_compact_rejects_corrupt_frames);
+  RUN_TEST(test_compact_too_small_buffer);
+  return UNITY_END();
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Pipeline.hpp>
+#include <BME280Sensor.hpp>
+
+static int begins;
+static int reads;
+
+struct FakeThermometer
+{
+  static const uint8_t fields = COMPACT_TEMPERATURE;
+  static const uint8_t sampleBytes = 3;
+  static bool ok;
+
+  static bool begin()
+  {
+    begins++;
+    return ok;
+  }
+  static bool start() { return ok; }
+  static uint32_t conversionTime() { return 10; }
+  static bool read(SensorSample *sample)
+  {
+    reads++;
+    sample->temperature = 2150;
+    return ok;
+  }
+  static void end() {}
+  static void print(const SensorSample *sample) {}
+};
+bool FakeThermometer::ok = true;
+
+struct FakeBarometer
+{
+  static const uint8_t fields = COMPACT_PRESSURE;
+  static const uint8_t sampleBytes = 3;
+
+  static bool begin()
+  {
+    begins++;
+    return true;
+  }
+  static bool start() { return true; }
+  static uint32_t conversionTime() { return 40; }
+  static bool read(SensorSample *sample)
+  {
+    reads++;
+    sample->pressure = 99000;
+    return true;
+  }
+  static void end() {}
+  static void print(const SensorSample *sample) {}
+};
+
+typedef SensorPipeline<FakeThermometer, FakeBarometer> Pipeline;
+
+void setUp(void)
+{
+  begins = 0;
+  reads = 0;
+  FakeThermometer::ok = true;
+}
+
+void tearDown(void)
+{
+}
+
+void test_fields_and_size_at_compile_time(void)
+{
+  static_assert(Pipeline::fields == (COMPACT_TEMPERATURE | COMPACT_PRESSURE), "fields");
+  static_assert(Pipeline::sampleBytes == 6, "sample bytes");
+  static_assert(SensorPipeline<>::fields == 0, "empty pipeline");
+  static_assert(compact_frame_size<SensorPipeline<>>(16, 0) == 10, "battery only frame");
+  TEST_ASSERT_EQUAL_HEX8(COMPACT_TEMPERATURE | COMPACT_PRESSURE, Pipeline::fields);
+}
+
+void test_read_fills_all_fields(void)
+{
+  SensorSample sample = {};
+  TEST_ASSERT_TRUE(Pipeline::begin());
+  TEST_ASSERT_TRUE(Pipeline::start());
+  TEST_ASSERT_EQUAL_UINT32(40, Pipeline::conversionTime());
+  TEST_ASSERT_TRUE(Pipeline::read(&sample));
+  TEST_ASSERT_EQUAL_INT32(2150, sample.temperature);
+  TEST_ASSERT_EQUAL_INT32(0, sample.humidity);
+  TEST_ASSERT_EQUAL_INT32(99000, sample.pressure);
+}
+
+void test_failing_driver_does_not_skip_others(void)
+{
+  FakeThermometer::ok = false;
+  SensorSample sample = {};
+
+  TEST_ASSERT_FALSE(Pipeline::begin());
+  TEST_ASSERT_FALSE(Pipeline::read(&sample));
+  TEST_ASSERT_EQUAL(2, begins);
+  TEST_ASSERT_EQUAL(2, reads);
+}
+
+void test_aggregator_uses_pipeline_fields(void)
+{
+  SampleAggregator<Pipeline::fields, 5> samples;
+  samples.reset();
+  for (int32_t i = 0; i < 5; i++)
+  {
+    SensorSample s = {2000 + i * 10, 4000 + i, 99000 + i};
+    samples.add(&s);
+  }
+
+  SensorSample mean = samples.aggregate(AGGREGATION_MEAN);
+  TEST_ASSERT_EQUAL(5, samples.size());
+  TEST_ASSERT_EQUAL_INT32(2020, mean.temperature);
+  TEST_ASSERT_EQUAL_INT32(0, mean.humidity); // not in the pipeline
+  TEST_ASSERT_EQUAL_INT32(99002, mean.pressure);
+
+  // the unused field keeps a single slot
+  TEST_ASSERT_TRUE(sizeof(samples) < sizeof(SampleAggregator<COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE, 5>));
+}
+
+void test_bme280_worst_case_fits(void)
+{
+  typedef SensorPipeline<BME280Sensor> Sensors;
+
+  // full range swings between all samples
+  SampleBatch batch = {};
+  for (int i = 0; i < MAX_BATCH_SIZE; i++)
+  {
+    SensorSample s = {(i & 1) ? 8500 : -4000, (i & 1) ? 10000 : 0, (i & 1) ? 110000 : 30000};
+    batch_add(&batch, &s);
+  }
+
+  CompactHeader header = {};
+  header.fields = Sensors::fields | COMPACT_BATTERY;
+  header.interval = 0xFFFFFFFF;
+  header.voltage = 3700;
+
+  uint16_t bound = compact_frame_size<Sensors>(MAX_BATCH_SIZE, 0);
+  uint8_t length = encode_compact(&header, &batch, NULL, 255);
+  TEST_ASSERT_TRUE(length > 0);
+  TEST_ASSERT_TRUE(length <= bound);
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_fields_and_size_at_compile_time);
+  RUN_TEST(test_read_fills_all_fields);
+  RUN_TEST(test_failing_driver_does_not_skip_others);
+  RUN_TEST(test_aggregator_uses_pipeline_fields);
+  RUN_TEST(test_bme280_worst_case_fits);
+  return UNITY_END();
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <AppConfig.hpp>
+#include <Power.hpp>
+
+void setUp(void)
+{
+  fake::reset();
+  power_init();
+}
+
+void tearDown(void)
+{
+}
+
+static void assertEvent(uint8_t index, uint8_t domain, uint8_t event, uint8_t held)
+{
+  const PowerEvent *e = power_log_event(index);
+  TEST_ASSERT_NOT_NULL(e);
+  TEST_ASSERT_EQUAL(domain, e->domain);
+  TEST_ASSERT_EQUAL(event, e->event);
+  TEST_ASSERT_EQUAL_HEX8(held, e->held);
+}
+
+void test_init_everything_off(void)
+{
+  TEST_ASSERT_EQUAL_HEX8(0, power_held());
+  TEST_ASSERT_EQUAL(0, power_log_size());
+  TEST_ASSERT_EQUAL(OUTPUT, fake::modes[Vext]);
+  TEST_ASSERT_EQUAL(HIGH, fake::pins[Vext]);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[SDA]);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[SCL]);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[UART_TX]);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[UART_RX]);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[RGB]);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[ADC]);
+}
+
+void test_i2c_holds_vext(void)
+{
+  power_acquire(POWER_I2C);
+  TEST_ASSERT_TRUE(Wire.enabled);
+  TEST_ASSERT_EQUAL(LOW, fake::pins[Vext]);
+  TEST_ASSERT_EQUAL_HEX8(POWER_BIT(POWER_VEXT) | POWER_BIT(POWER_I2C), power_held());
+
+  power_release(POWER_I2C);
+  TEST_ASSERT_FALSE(Wire.enabled);
+  TEST_ASSERT_EQUAL(HIGH, fake::pins[Vext]);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[SDA]);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[SCL]);
+  TEST_ASSERT_EQUAL_HEX8(0, power_held());
+}
+
+void test_sequence(void)
+{
+  fake::clock = 100;
+  power_acquire(POWER_I2C);
+  fake::clock = 200;
+  power_release(POWER_I2C);
+
+  // rail up before the bus, bus down before the rail
+  TEST_ASSERT_EQUAL(4, power_log_size());
+  assertEvent(0, POWER_VEXT, POWER_EVENT_ON, POWER_BIT(POWER_VEXT));
+  assertEvent(1, POWER_I2C, POWER_EVENT_ON, POWER_BIT(POWER_VEXT) | POWER_BIT(POWER_I2C));
+  assertEvent(2, POWER_I2C, POWER_EVENT_OFF, POWER_BIT(POWER_VEXT));
+  assertEvent(3, POWER_VEXT, POWER_EVENT_OFF, 0);
+  TEST_ASSERT_EQUAL(100, power_log_event(0)->time);
+  TEST_ASSERT_EQUAL(200, power_log_event(3)->time);
+  TEST_ASSERT_NULL(power_log_event(4));
+}
+
+void test_reference_count(void)
+{
+  power_acquire(POWER_I2C);
+  power_acquire(POWER_LED);
+  power_release(POWER_I2C);
+  // the LED still holds the rail
+  TEST_ASSERT_EQUAL(LOW, fake::pins[Vext]);
+  TEST_ASSERT_FALSE(Wire.enabled);
+
+  power_acquire(POWER_UART);
+  power_acquire(POWER_UART);
+  power_release(POWER_UART);
+  TEST_ASSERT_EQUAL(POWER_UART_BAUD, Serial.baud);
+  power_release(POWER_UART);
+  TEST_ASSERT_EQUAL(0, Serial.baud);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[UART_TX]);
+
+  power_release(POWER_LED);
+  TEST_ASSERT_EQUAL(HIGH, fake::pins[Vext]);
+  TEST_ASSERT_EQUAL_HEX8(0, power_held());
+}
+
+void test_release_without_acquire(void)
+{
+  power_acquire(POWER_LED);
+  power_release(POWER_I2C);
+  power_release(POWER_ADC);
+  TEST_ASSERT_EQUAL(LOW, fake::pins[Vext]);
+  TEST_ASSERT_EQUAL_HEX8(POWER_BIT(POWER_VEXT) | POWER_BIT(POWER_LED), power_held());
+  TEST_ASSERT_EQUAL(2, power_log_size());
+}
+
+void test_led_dark_before_rail_drops(void)
+{
+  showBoardLED(0, 50, 0);
+  TEST_ASSERT_EQUAL_HEX32(0x003200, pixels.shown);
+  TEST_ASSERT_EQUAL(LOW, fake::pins[Vext]);
+  showBoardLED(0, 0, 50);
+  clearBoardLED();
+  TEST_ASSERT_EQUAL_HEX32(0, pixels.shown);
+  TEST_ASSERT_EQUAL(HIGH, fake::pins[Vext]);
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[RGB]);
+  TEST_ASSERT_EQUAL_HEX8(0, power_held());
+
+  // clearing a dark LED does not touch the rail
+  power_acquire(POWER_I2C);
+  clearBoardLED();
+  TEST_ASSERT_EQUAL(LOW, fake::pins[Vext]);
+}
+
+void test_park_before_sleep(void)
+{
+  power_acquire(POWER_UART);
+  // a library leaves a released pin configured
+  pinMode(SDA, INPUT_PULLUP);
+  TEST_ASSERT_EQUAL_HEX8(POWER_BIT(POWER_UART), power_park());
+  TEST_ASSERT_EQUAL(ANALOG, fake::modes[SDA]);
+  assertEvent(power_log_size() - 1, POWER_DOMAINS, POWER_EVENT_SLEEP, POWER_BIT(POWER_UART));
+
+  power_release(POWER_UART);
+  TEST_ASSERT_EQUAL_HEX8(0, power_park());
+}
+
+void test_log_keeps_newest(void)
+{
+  for (uint8_t i = 0; i < POWER_LOG_SIZE + 3; i++)
+  {
+    fake::clock = i;
+    power_park();
+  }
+  TEST_ASSERT_EQUAL(POWER_LOG_SIZE, power_log_size());
+  TEST_ASSERT_EQUAL(3, power_log_event(0)->time);
+  TEST_ASSERT_EQUAL(POWER_LOG_SIZE + 2, power_log_event(POWER_LOG_SIZE - 1)->time);
+
+  power_log_clear();
+  TEST_ASSERT_EQUAL(0, power_log_size());
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_init_everything_off);
+  RUN_TEST(test_i2c_holds_vext);
+  RUN_TEST(test_sequence);
+  RUN_TEST(test_reference_count);
+  RUN_TEST(test_release_without_acquire);
+  RUN_TEST(test_led_dark_before_rail_drops);
+  RUN_TEST(test_park_before_sleep);
+  RUN_TEST(test_log_keeps_newest);
+  return UNITY_END();
+}
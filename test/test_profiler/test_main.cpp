@@ -0,0 +1,72 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Profiler.hpp>
+
+void setUp(void)
+{
+  fake::reset();
+  profile_dump(); // clear
+}
+
+void tearDown(void)
+{
+}
+
+void test_events_are_timestamped(void)
+{
+  fake::clock = 1000;
+  PROFILE_BEGIN(PROFILE_SEND);
+  delay(1500);
+  PROFILE_END(PROFILE_SEND);
+
+  TEST_ASSERT_EQUAL(2, profile_count());
+  TEST_ASSERT_EQUAL_UINT32(1000, profile_get(0)->timestamp);
+  TEST_ASSERT_EQUAL_HEX8(PROFILE_SEND | PROFILE_BEGIN_FLAG, profile_get(0)->event);
+  TEST_ASSERT_EQUAL_UINT32(2500, profile_get(1)->timestamp);
+  TEST_ASSERT_EQUAL_HEX8(PROFILE_SEND, profile_get(1)->event);
+  TEST_ASSERT_NULL(profile_get(2));
+}
+
+void test_ring_buffer_keeps_newest(void)
+{
+  for (int i = 0; i < PROFILE_BUFFER_SIZE + 3; i++)
+  {
+    fake::clock = i;
+    PROFILE_END(PROFILE_SENSOR_READ);
+  }
+
+  TEST_ASSERT_EQUAL(PROFILE_BUFFER_SIZE, profile_count());
+  TEST_ASSERT_EQUAL_UINT32(3, profile_get(0)->timestamp);
+  TEST_ASSERT_EQUAL_UINT32(PROFILE_BUFFER_SIZE + 2, profile_get(PROFILE_BUFFER_SIZE - 1)->timestamp);
+}
+
+void test_dump_clears_buffer(void)
+{
+  PROFILE_BEGIN(PROFILE_BATTERY);
+  profile_dump();
+  TEST_ASSERT_EQUAL(0, profile_count());
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_events_are_timestamped);
+  RUN_TEST(test_ring_buffer_keeps_newest);
+  RUN_TEST(test_dump_clears_buffer);
+  return UNITY_END();
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Reporting.hpp>
+
+static ReportState state;
+static SampleBatch batch;
+
+static void add(int32_t temperature, int32_t humidity, int32_t pressure)
+{
+  SensorSample s = {temperature, humidity, pressure};
+  batch_add(&batch, &s);
+}
+
+void setUp(void)
+{
+  memset(&state, 0, sizeof(state));
+  memset(&batch, 0, sizeof(batch));
+  appConfig.deadbandTemperature = 20; // 0.2 C
+  appConfig.deadbandHumidity = 100;   // 1 %
+  appConfig.deadbandPressure = 0;     // ignored
+  appConfig.maxsilence = 3600000;
+}
+
+void tearDown(void)
+{
+}
+
+void test_first_batch_is_sent(void)
+{
+  add(2150, 4500, 101325);
+  TEST_ASSERT_TRUE(report_due(&state, &batch, 0));
+}
+
+void test_inside_deadband_is_skipped(void)
+{
+  SensorSample sent = {2150, 4500, 101325};
+  report_sent(&state, &sent, 1000);
+
+  add(2170, 4400, 90000); // pressure is ignored
+  TEST_ASSERT_FALSE(report_due(&state, &batch, 2000));
+}
+
+void test_any_sample_outside_deadband_is_sent(void)
+{
+  SensorSample sent = {2150, 4500, 101325};
+  report_sent(&state, &sent, 1000);
+
+  add(2150, 4500, 101325);
+  add(2129, 4500, 101325);
+  add(2150, 4500, 101325);
+  TEST_ASSERT_TRUE(report_due(&state, &batch, 2000));
+}
+
+void test_heartbeat(void)
+{
+  SensorSample sent = {2150, 4500, 101325};
+  report_sent(&state, &sent, 1000);
+
+  add(2150, 4500, 101325);
+  TEST_ASSERT_FALSE(report_due(&state, &batch, 1000 + 3599999));
+  TEST_ASSERT_TRUE(report_due(&state, &batch, 1000 + 3600000));
+}
+
+void test_heartbeat_across_millis_overflow(void)
+{
+  SensorSample sent = {2150, 4500, 101325};
+  report_sent(&state, &sent, 0xFFFFFF00);
+
+  add(2150, 4500, 101325);
+  TEST_ASSERT_FALSE(report_due(&state, &batch, 0x00000100));
+}
+
+void test_all_deadbands_off_sends_everything(void)
+{
+  appConfig.deadbandTemperature = 0;
+  appConfig.deadbandHumidity = 0;
+
+  SensorSample sent = {2150, 4500, 101325};
+  report_sent(&state, &sent, 1000);
+
+  add(2150, 4500, 101325);
+  TEST_ASSERT_TRUE(report_due(&state, &batch, 2000));
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_first_batch_is_sent);
+  RUN_TEST(test_inside_deadband_is_skipped);
+  RUN_TEST(test_any_sample_outside_deadband_is_sent);
+  RUN_TEST(test_heartbeat);
+  RUN_TEST(test_heartbeat_across_millis_overflow);
+  RUN_TEST(test_all_deadbands_off_sends_everything);
+  return UNITY_END();
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Scheduler.hpp>
+
+#define MINUTE 60000
+
+static SchedulerState state;
+
+static uint32_t step(int32_t temperature, uint32_t now, uint16_t voltage = 3900)
+{
+  SensorSample s = {temperature, 5000, 101325};
+  return schedule_next(&state, &s, now, voltage);
+}
+
+void setUp(void)
+{
+  memset(&state, 0, sizeof(state));
+  memset(&appConfig, 0, sizeof(appConfig));
+  appConfig.sleeptime = 20 * MINUTE;
+  appConfig.minsleeptime = 5 * MINUTE;
+  appConfig.maxsleeptime = 60 * MINUTE;
+}
+
+void tearDown(void)
+{
+}
+
+void test_disabled_uses_sleeptime(void)
+{
+  TEST_ASSERT_EQUAL_UINT32(20 * MINUTE, step(2000, 0));
+  TEST_ASSERT_EQUAL_UINT32(20 * MINUTE, step(3000, 20 * MINUTE));
+  TEST_ASSERT_EQUAL_UINT32(20 * MINUTE, step(1000, 40 * MINUTE));
+}
+
+void test_fast_change_halves_down_to_min(void)
+{
+  appConfig.rateTemperature = 100; // 1 C per hour
+
+  TEST_ASSERT_EQUAL_UINT32(20 * MINUTE, step(2000, 0));
+  // 1 C in 20 minutes
+  TEST_ASSERT_EQUAL_UINT32(10 * MINUTE, step(2100, 20 * MINUTE));
+  TEST_ASSERT_EQUAL_UINT32(5 * MINUTE, step(2200, 30 * MINUTE));
+  TEST_ASSERT_EQUAL_UINT32(5 * MINUTE, step(2300, 35 * MINUTE));
+}
+
+void test_halves_once_per_sample(void)
+{
+  appConfig.rateTemperature = 100;
+
+  step(2000, 0);
+  TEST_ASSERT_EQUAL_UINT32(10 * MINUTE, step(2100, 20 * MINUTE));
+  // failed reads do not halve again on the same window
+  TEST_ASSERT_EQUAL_UINT32(10 * MINUTE, schedule_next(&state, NULL, 30 * MINUTE, 3900));
+  TEST_ASSERT_EQUAL_UINT32(10 * MINUTE, schedule_next(&state, NULL, 40 * MINUTE, 3900));
+  TEST_ASSERT_EQUAL_UINT8(2, state.count);
+  TEST_ASSERT_EQUAL_UINT32(5 * MINUTE, step(2200, 50 * MINUTE));
+}
+
+void test_no_sample_keeps_interval(void)
+{
+  appConfig.rateTemperature = 100;
+
+  TEST_ASSERT_EQUAL_UINT32(20 * MINUTE, schedule_next(&state, NULL, 0, 3900));
+  TEST_ASSERT_EQUAL_UINT8(0, state.count);
+  step(2000, 20 * MINUTE);
+  // stable window, but nothing new to lengthen on
+  step(2000, 40 * MINUTE);
+  TEST_ASSERT_EQUAL_UINT32(25 * MINUTE, schedule_next(&state, NULL, 65 * MINUTE, 3900));
+  // the battery still applies
+  appConfig.batteryLow = 3500;
+  TEST_ASSERT_EQUAL_UINT32(50 * MINUTE, schedule_next(&state, NULL, 90 * MINUTE, 3400));
+}
+
+void test_stable_lengthens_up_to_max(void)
+{
+  appConfig.rateTemperature = 100;
+
+  uint32_t now = 0;
+  uint32_t interval = step(2000, now);
+  for (int i = 0; i < 10; i++)
+  {
+    now += interval;
+    interval = step(2000, now);
+  }
+  TEST_ASSERT_EQUAL_UINT32(60 * MINUTE, interval);
+}
+
+void test_moderate_change_keeps_interval(void)
+{
+  appConfig.rateTemperature = 100;
+
+  TEST_ASSERT_EQUAL_UINT32(20 * MINUTE, step(2000, 0));
+  // 0.75 C per hour, between half and full threshold
+  TEST_ASSERT_EQUAL_UINT32(20 * MINUTE, step(2025, 20 * MINUTE));
+}
+
+void test_new_sleeptime_restarts(void)
+{
+  appConfig.rateTemperature = 100;
+
+  step(2000, 0);
+  step(2100, 20 * MINUTE); // 10 minutes
+  appConfig.sleeptime = 30 * MINUTE;
+  TEST_ASSERT_EQUAL_UINT32(30 * MINUTE, step(2100, 30 * MINUTE));
+}
+
+void test_low_battery_doubles(void)
+{
+  appConfig.batteryLow = 3500;
+  appConfig.batteryCritical = 3300;
+
+  TEST_ASSERT_EQUAL_UINT32(20 * MINUTE, step(2000, 0, 3600));
+  TEST_ASSERT_EQUAL_UINT32(40 * MINUTE, step(2000, 20 * MINUTE, 3400));
+  TEST_ASSERT_EQUAL_UINT32(60 * MINUTE, step(2000, 60 * MINUTE, 3200));
+}
+
+void test_low_battery_never_shortens(void)
+{
+  appConfig.sleeptime = 120 * MINUTE;
+  appConfig.batteryLow = 3500;
+  appConfig.batteryCritical = 3300;
+
+  TEST_ASSERT_EQUAL_UINT32(120 * MINUTE, step(2000, 0, 3400));
+  TEST_ASSERT_EQUAL_UINT32(120 * MINUTE, step(2000, 0, 3200));
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_disabled_uses_sleeptime);
+  RUN_TEST(test_fast_change_halves_down_to_min);
+  RUN_TEST(test_halves_once_per_sample);
+  RUN_TEST(test_no_sample_keeps_interval);
+  RUN_TEST(test_stable_lengthens_up_to_max);
+  RUN_TEST(test_moderate_change_keeps_interval);
+  RUN_TEST(test_new_sleeptime_restarts);
+  RUN_TEST(test_low_battery_doubles);
+  RUN_TEST(test_low_battery_never_shortens);
+  return UNITY_END();
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unity.h>
+#include <ArduinoFakes.h>
+#include <Session.hpp>
+
+void setUp(void)
+{
+  fake::reset();
+  memset(&appConfig, 0, sizeof(appConfig));
+  memset(appConfig.devEui, 0x42, sizeof(appConfig.devEui));
+  memset(appConfig.appKey, 0x17, sizeof(appConfig.appKey));
+}
+
+void tearDown(void)
+{
+}
+
+// Join, send a few uplinks and power cycle the radio
+static void joinAndReset(uint32_t uplinks)
+{
+  LoRaWAN.joinOTAA(appConfig.appEui, appConfig.appKey, appConfig.devEui);
+  LoRaWAN.datarate = 3;
+  TEST_ASSERT_TRUE(session_save());
+  uint8_t data = 0;
+  for (uint32_t i = 0; i < uplinks; i++)
+  {
+    LoRaWAN.send(1, &data, 2, false);
+    session_update();
+  }
+  LoRaWAN = LoRaWanMinimal();
+}
+
+void test_empty_eeprom_has_no_session(void)
+{
+  TEST_ASSERT_FALSE(session_restore());
+  TEST_ASSERT_EQUAL_UINT32(0, LoRaWAN.abpJoins);
+}
+
+void test_restore_after_reset(void)
+{
+  joinAndReset(5);
+
+  TEST_ASSERT_TRUE(session_restore());
+  TEST_ASSERT_TRUE(LoRaWAN.isJoined());
+  TEST_ASSERT_EQUAL_UINT32(1, LoRaWAN.abpJoins);
+  TEST_ASSERT_EQUAL_HEX32(0x26010001, LoRaWAN.devAddr);
+  TEST_ASSERT_EQUAL_HEX8(0x11, LoRaWAN.nwkSKey[15]);
+  TEST_ASSERT_EQUAL_HEX8(0x21, LoRaWAN.appSKey[15]);
+  TEST_ASSERT_EQUAL_INT8(3, LoRaWAN.datarate);
+  TEST_ASSERT_EQUAL_UINT32(SESSION_COUNTER_GAP, LoRaWAN.uplinkCounter);
+}
+
+void test_restore_keeps_join_accept_settings(void)
+{
+  joinAndReset(1);
+  TEST_ASSERT_EQUAL_UINT32(1000, LoRaWAN.receiveDelay1);
+  TEST_ASSERT_EQUAL_UINT32(0, LoRaWAN.channels[3].Frequency);
+
+  TEST_ASSERT_TRUE(session_restore());
+  TEST_ASSERT_EQUAL_UINT32(5000, LoRaWAN.receiveDelay1);
+  TEST_ASSERT_EQUAL_UINT32(6000, LoRaWAN.receiveDelay2);
+  TEST_ASSERT_EQUAL_UINT32(869525000, LoRaWAN.rx2Channel.Frequency);
+  TEST_ASSERT_EQUAL_UINT8(3, LoRaWAN.rx2Channel.Datarate);
+  for (uint8_t i = 0; i < SESSION_CHANNELS; i++)
+  {
+    const ChannelParams_t *channel = &LoRaWAN.channels[SESSION_FIRST_CHANNEL + i];
+    TEST_ASSERT_EQUAL_UINT32(867100000 + i * 200000, channel->Frequency);
+    TEST_ASSERT_EQUAL_HEX8(0x50, channel->DrRange.Value);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, LoRaWAN.channels[SESSION_FIRST_CHANNEL + SESSION_CHANNELS].Frequency);
+  TEST_ASSERT_EQUAL_HEX16(0x00FF, LoRaWAN.channelsMask);
+}
+
+void test_counter_never_reused(void)
+{
+  joinAndReset(SESSION_COUNTER_GAP + 3);
+
+  TEST_ASSERT_TRUE(session_restore());
+  TEST_ASSERT_TRUE(LoRaWAN.uplinkCounter >= SESSION_COUNTER_GAP + 3);
+}
+
+void test_eeprom_written_once_per_gap(void)
+{
+  uint32_t commits = EEPROM.commits;
+  joinAndReset(SESSION_COUNTER_GAP - 1);
+  TEST_ASSERT_EQUAL_UINT32(commits + 1, EEPROM.commits);
+}
+
+void test_corrupt_record_rejected(void)
+{
+  joinAndReset(1);
+  EEPROM.data[SESSION_OFFSET + offsetof(LoRaSession, devAddr)] ^= 0x01;
+
+  TEST_ASSERT_FALSE(session_restore());
+  TEST_ASSERT_FALSE(LoRaWAN.isJoined());
+}
+
+void test_other_credentials_rejected(void)
+{
+  joinAndReset(1);
+  appConfig.appKey[0] ^= 0x01;
+
+  TEST_ASSERT_FALSE(session_restore());
+}
+
+void test_cleared_session_rejected(void)
+{
+  joinAndReset(1);
+  session_clear();
+
+  TEST_ASSERT_FALSE(session_restore());
+}
+
+void test_unreadable_keys_store_nothing(void)
+{
+  LoRaWAN.keysReadable = false;
+  LoRaWAN.joinOTAA(appConfig.appEui, appConfig.appKey, appConfig.devEui);
+
+  TEST_ASSERT_FALSE(session_save());
+  TEST_ASSERT_FALSE(session_restore());
+}
+
+int main(int argc, char **argv)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_eeprom_has_no_session);
+  RUN_TEST(test_restore_after_reset);
+  RUN_TEST(test_restore_keeps_join_accept_settings);
+  RUN_TEST(test_counter_never_reused);
+  RUN_TEST(test_eeprom_written_once_per_gap);
+  RUN_TEST(test_corrupt_record_rejected);
+  RUN_TEST(test_other_credentials_rejected);
+  RUN_TEST(test_cleared_session_rejected);
+  RUN_TEST(test_unreadable_keys_store_nothing);
+  return UNITY_END();
+}
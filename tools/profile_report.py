@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+#
+# Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Turn a serial log of a -DPROFILE build into a per-phase time and charge
+# breakdown.
+#
+#   pio device monitor | tee trace.log
+#   tools/profile_report.py trace.log [--model tools/current_model.json]
+#
+# Time between the end of one phase and the begin of the next is booked
+# as "active" (MCU running, radio and sensor idle).
+
+import argparse
+import json
+import os
+import re
+import sys
+
+# keep in sync with lib/Profiler/Profiler.hpp
+PHASES = {
+    1: "join",
+    2: "sensor_init",
+    3: "sensor_read",
+    4: "battery",
+    5: "send",
+    6: "sleep",
+}
+
+LINE = re.compile(r"PROFILE (\d+) ([BE]) (\d+)")
+
+
+def parse(lines):
+    events = []
+    dropped = 0
+    for line in lines:
+        if "PROFILE DROPPED" in line:
+            dropped += int(line.split()[-1])
+            continue
+        m = LINE.search(line)
+        if m:
+            events.append((int(m.group(1)), m.group(2), int(m.group(3))))
+    return events, dropped
+
+
+def durations(events):
+    totals = {name: 0 for name in PHASES.values()}
+    totals["active"] = 0
+    counts = {name: 0 for name in totals}
+    open_phases = {}
+    nesting = 0
+    last = None
+    cycles = 0
+
+    for timestamp, kind, phase in events:
+        name = PHASES.get(phase, "phase_%d" % phase)
+        totals.setdefault(name, 0)
+        counts.setdefault(name, 0)
+
+        if last is not None and nesting == 0:
+            totals["active"] += (timestamp - last) & 0xFFFFFFFF
+        last = timestamp
+
+        if kind == "B":
+            open_phases[phase] = timestamp
+            nesting += 1
+        elif phase in open_phases:
+            totals[name] += (timestamp - open_phases.pop(phase)) & 0xFFFFFFFF
+            counts[name] += 1
+            nesting -= 1
+            if name == "sleep":
+                cycles += 1
+
+    return totals, counts, cycles
+
+
+def main():
+    default_model = os.path.join(os.path.dirname(__file__), "current_model.json")
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("trace", nargs="?", help="serial log, stdin if omitted")
+    parser.add_argument("--model", default=default_model, help="current model (JSON)")
+    args = parser.parse_args()
+
+    with open(args.model) as f:
+        model = json.load(f)
+    currents = model["phases"]
+
+    lines = open(args.trace) if args.trace else sys.stdin
+    events, dropped = parse(lines)
+    if not events:
+        sys.exit("no PROFILE lines found")
+
+    totals, counts, cycles = durations(events)
+    total_ms = sum(totals.values())
+    total_mah = 0.0
+
+    print("%-12s %10s %6s %10s %7s %12s" % ("phase", "time ms", "count", "ms/cycle", "share", "charge mAh"))
+    for name, ms in sorted(totals.items(), key=lambda kv: -kv[1]):
+        if ms == 0:
+            continue
+        mah = currents.get(name, currents["active"]) * ms / 3600000.0
+        total_mah += mah
+        per_cycle = ms / cycles if cycles else ms
+        print("%-12s %10d %6d %10.1f %6.1f%% %12.6f" % (name, ms, counts[name], per_cycle, 100.0 * ms / total_ms, mah))
+
+    print()
+    print("trace: %.1f s, %d cycles, %.6f mAh" % (total_ms / 1000.0, cycles, total_mah))
+    if dropped:
+        print("warning: %d events were dropped, increase PROFILE_BUFFER_SIZE" % dropped)
+    if cycles and total_ms:
+        average_ma = total_mah * 3600000.0 / total_ms
+        days = model["battery_mah"] / average_ma / 24.0
+        print("average current: %.4f mA, %d mAh battery lasts %.0f days" % (average_ma, model["battery_mah"], days))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,497 @@
+/*
+ * Copyright 2025 Thorsten Ludewig (t.ludewig@gmail.com)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replay benchmark for the ingestion path: decode uplinks as TTN webhooks
+// deliver them, check the crc8 and write InfluxDB line protocol batches.
+// Reports the decode throughput and the latency from the arrival of an
+// uplink until its lines are flushed.
+//
+//   I="-Itest/mocks/ArduinoFakes -Ilib/Aggregator -Ilib/AppConfig -Ilib/CRC8 -Ilib/Payload -Ilib/Decoder"
+//   g++ -std=c++11 -O2 -DHAS_BME280 $I tools/replay_bench.cpp lib/Decoder/Decoder.cpp
+//       lib/Payload/Payload.cpp lib/CRC8/CRC8.cpp -o replay_bench
+//
+//   ./replay_bench --generate 100000 --devices 2000 --dump uplinks.jsonl
+//   ./replay_bench --input uplinks.jsonl --rate 500 --lines 5000 --output batch.lp
+//
+// The input is one webhook JSON object per line. Only end_device_ids.device_id,
+// received_at, uplink_message.f_port, f_cnt and frm_payload are used.
+
+#include <Decoder.hpp>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct Record
+{
+  std::string device;
+  uint8_t port;
+  uint32_t fcnt;
+  uint64_t received; // ns since epoch
+  std::vector<uint8_t> payload;
+};
+
+struct Options
+{
+  const char *input = NULL;
+  const char *output = NULL;
+  const char *dump = NULL;
+  uint32_t generate = 0;
+  uint32_t devices = 100;
+  uint8_t batchSize = 4;
+  uint32_t corrupt = 0; // per mille
+  double rate = 0;      // uplinks per second, 0 = as fast as possible
+  uint32_t lines = 1000;
+};
+
+// Input ///////////////////////////////////////////////////////////////////////
+
+// Value of "key": in a flat JSON text, string or number
+static bool jsonValue(const std::string &json, const char *key, std::string &value)
+{
+  std::string pattern = std::string("\"") + key + "\"";
+  size_t pos = json.find(pattern);
+  if (pos == std::string::npos)
+  {
+    return false;
+  }
+  pos = json.find(':', pos + pattern.size());
+  if (pos == std::string::npos)
+  {
+    return false;
+  }
+  pos = json.find_first_not_of(" \t", pos + 1);
+  if (pos == std::string::npos)
+  {
+    return false;
+  }
+  if (json[pos] == '"')
+  {
+    size_t end = json.find('"', pos + 1);
+    value = json.substr(pos + 1, end - pos - 1);
+  }
+  else
+  {
+    size_t end = json.find_first_of(",} \t", pos);
+    value = json.substr(pos, end - pos);
+  }
+  return true;
+}
+
+static bool base64Decode(const std::string &text, std::vector<uint8_t> &out)
+{
+  static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  uint32_t bits = 0;
+  int count = 0;
+  out.clear();
+  for (char c : text)
+  {
+    if (c == '=')
+    {
+      break;
+    }
+    const char *p = strchr(alphabet, c);
+    if (!p || !c)
+    {
+      return false;
+    }
+    bits = (bits << 6) | (uint32_t)(p - alphabet);
+    count += 6;
+    if (count >= 8)
+    {
+      count -= 8;
+      out.push_back((bits >> count) & 0xFF);
+    }
+  }
+  return true;
+}
+
+static std::string base64Encode(const std::vector<uint8_t> &data)
+{
+  static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < data.size(); i += 3)
+  {
+    uint32_t v = data[i] << 16;
+    if (i + 1 < data.size())
+      v |= data[i + 1] << 8;
+    if (i + 2 < data.size())
+      v |= data[i + 2];
+    out += alphabet[(v >> 18) & 0x3F];
+    out += alphabet[(v >> 12) & 0x3F];
+    out += i + 1 < data.size() ? alphabet[(v >> 6) & 0x3F] : '=';
+    out += i + 2 < data.size() ? alphabet[v & 0x3F] : '=';
+  }
+  return out;
+}
+
+// RFC 3339 in UTC as TTN writes it, 2025-01-31T12:34:56.123456789Z
+static uint64_t parseTime(const std::string &text)
+{
+  struct tm t = {};
+  unsigned nanos = 0;
+  int digits = 0;
+  if (sscanf(text.c_str(), "%d-%d-%dT%d:%d:%d", &t.tm_year, &t.tm_mon, &t.tm_mday,
+             &t.tm_hour, &t.tm_min, &t.tm_sec) != 6)
+  {
+    return 0;
+  }
+  size_t dot = text.find('.');
+  if (dot != std::string::npos)
+  {
+    for (size_t i = dot + 1; i < text.size() && isdigit(text[i]) && digits < 9; i++, digits++)
+    {
+      nanos = nanos * 10 + (text[i] - '0');
+    }
+    for (; digits < 9; digits++)
+    {
+      nanos *= 10;
+    }
+  }
+  t.tm_year -= 1900;
+  t.tm_mon -= 1;
+  return (uint64_t)timegm(&t) * 1000000000ULL + nanos;
+}
+
+static std::string formatTime(uint64_t ns)
+{
+  time_t seconds = ns / 1000000000ULL;
+  struct tm t;
+  gmtime_r(&seconds, &t);
+  char text[64];
+  snprintf(text, sizeof(text), "%04d-%02d-%02dT%02d:%02d:%02d.%09uZ", t.tm_year + 1900, t.tm_mon + 1,
+           t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, (unsigned)(ns % 1000000000ULL));
+  return text;
+}
+
+static bool readRecords(const char *path, std::vector<Record> &records)
+{
+  FILE *f = fopen(path, "r");
+  if (!f)
+  {
+    perror(path);
+    return false;
+  }
+
+  char *line = NULL;
+  size_t capacity = 0;
+  uint32_t number = 0;
+  while (getline(&line, &capacity, f) > 0)
+  {
+    std::string json(line), value;
+    Record r;
+    number++;
+    if (!jsonValue(json, "device_id", r.device) || !jsonValue(json, "frm_payload", value) ||
+        !base64Decode(value, r.payload))
+    {
+      fprintf(stderr, "%s:%u: no uplink, skipped\n", path, number);
+      continue;
+    }
+    r.port = jsonValue(json, "f_port", value) ? atoi(value.c_str()) : 0;
+    r.fcnt = jsonValue(json, "f_cnt", value) ? strtoul(value.c_str(), NULL, 10) : 0;
+    r.received = jsonValue(json, "received_at", value) ? parseTime(value) : 0;
+    records.push_back(r);
+  }
+  free(line);
+  fclose(f);
+  return true;
+}
+
+// Compact frames of devices doing a random walk, every device sends its
+// batches in turn like a fleet with the same interval
+static void generateRecords(const Options &o, std::vector<Record> &records)
+{
+  srand(1);
+  std::vector<SensorSample> state(o.devices);
+  std::vector<uint32_t> fcnt(o.devices, 0);
+  uint64_t received = 1735689600000000000ULL; // 2025-01-01
+  uint32_t interval = 600;
+
+  for (uint32_t i = 0; i < o.devices; i++)
+  {
+    state[i] = {2000 + rand() % 500, 5000 + rand() % 2000, 100000 + rand() % 3000};
+  }
+
+  for (uint32_t n = 0; n < o.generate; n++)
+  {
+    uint32_t d = n % o.devices;
+    SampleBatch batch = {};
+    for (uint8_t i = 0; i < o.batchSize; i++)
+    {
+      state[d].temperature += rand() % 21 - 10;
+      state[d].humidity += rand() % 41 - 20;
+      state[d].pressure += rand() % 11 - 5;
+      batch_add(&batch, &state[d]);
+    }
+
+    CompactHeader header = {};
+    header.fields = COMPACT_TEMPERATURE | COMPACT_HUMIDITY | COMPACT_PRESSURE | COMPACT_BATTERY;
+    header.status = COMPACT_STATUS_OK;
+    header.interval = o.batchSize > 1 ? interval : 0;
+    header.voltage = 3600 + rand() % 500;
+
+    uint8_t buffer[COMPACT_MAX_SIZE];
+    uint8_t length = encode_compact(&header, &batch, buffer, sizeof(buffer));
+
+    Record r;
+    char name[32];
+    snprintf(name, sizeof(name), "node-%05u", (unsigned)d);
+    r.device = name;
+    r.port = FPORT_COMPACT;
+    r.fcnt = fcnt[d]++;
+    r.received = received + (uint64_t)n * interval * o.batchSize * 1000000000ULL / o.devices;
+    r.payload.assign(buffer, buffer + length);
+    if (o.corrupt && (uint32_t)(rand() % 1000) < o.corrupt)
+    {
+      r.payload[rand() % length] ^= 0x10;
+    }
+    records.push_back(r);
+  }
+}
+
+static void dumpRecords(const char *path, const std::vector<Record> &records)
+{
+  FILE *f = fopen(path, "w");
+  if (!f)
+  {
+    perror(path);
+    return;
+  }
+  for (const Record &r : records)
+  {
+    fprintf(f,
+            "{\"end_device_ids\":{\"device_id\":\"%s\"},\"received_at\":\"%s\","
+            "\"uplink_message\":{\"f_port\":%u,\"f_cnt\":%u,\"frm_payload\":\"%s\"}}\n",
+            r.device.c_str(), formatTime(r.received).c_str(), r.port, (unsigned)r.fcnt,
+            base64Encode(r.payload).c_str());
+  }
+  fclose(f);
+}
+
+// Replay ////////////////////////////////////////////////////////////////////
+
+struct Stats
+{
+  uint32_t results[DECODE_FORMAT + 1] = {};
+  uint64_t lines = 0;
+  uint64_t bytes = 0;
+  std::vector<double> latency; // us
+};
+
+static double percentile(std::vector<double> &values, double p)
+{
+  if (values.empty())
+  {
+    return 0;
+  }
+  size_t index = (size_t)(p / 100.0 * (values.size() - 1) + 0.5);
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+static void replay(const Options &o, const std::vector<Record> &records, Stats &stats)
+{
+  FILE *out = NULL;
+  if (o.output)
+  {
+    out = strcmp(o.output, "-") == 0 ? stdout : fopen(o.output, "w");
+    if (!out)
+    {
+      perror(o.output);
+      return;
+    }
+  }
+
+  // one uplink decodes to at most MAX_BATCH_SIZE lines of about 150 bytes
+  std::vector<char> batch(o.lines * 160 + MAX_BATCH_SIZE * 160);
+  size_t used = 0;
+  uint32_t lines = 0;
+  std::vector<Clock::time_point> pending;
+  stats.latency.reserve(records.size());
+
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    const Record &r = records[i];
+    Clock::time_point arrival = Clock::now();
+    if (o.rate > 0)
+    {
+      arrival = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(i / o.rate));
+      std::this_thread::sleep_until(arrival);
+    }
+
+    Uplink uplink;
+    DecodeResult result = decode_uplink(r.port, r.payload.data(), r.payload.size(), &uplink);
+    stats.results[result]++;
+    if (result != DECODE_OK)
+    {
+      continue;
+    }
+
+    size_t n = format_line_protocol(r.device.c_str(), &uplink, r.fcnt, r.received,
+                                    batch.data() + used, batch.size() - used);
+    used += n;
+    lines += uplink.batch.count;
+    pending.push_back(arrival);
+
+    if (lines >= o.lines || i + 1 == records.size())
+    {
+      if (out)
+      {
+        fwrite(batch.data(), 1, used, out);
+        fflush(out);
+      }
+      Clock::time_point flushed = Clock::now();
+      for (const Clock::time_point &a : pending)
+      {
+        stats.latency.push_back(std::chrono::duration<double, std::micro>(flushed - a).count());
+      }
+      stats.lines += lines;
+      stats.bytes += used;
+      pending.clear();
+      used = 0;
+      lines = 0;
+    }
+  }
+
+  // the last record may have been rejected, flush what is left
+  if (used > 0)
+  {
+    if (out)
+    {
+      fwrite(batch.data(), 1, used, out);
+    }
+    Clock::time_point flushed = Clock::now();
+    for (const Clock::time_point &a : pending)
+    {
+      stats.latency.push_back(std::chrono::duration<double, std::micro>(flushed - a).count());
+    }
+    stats.lines += lines;
+    stats.bytes += used;
+  }
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+  if (out && out != stdout)
+  {
+    fclose(out);
+  }
+
+  FILE *report = out == stdout ? stderr : stdout;
+  fprintf(report, "uplinks      %zu\n", records.size());
+  fprintf(report, "decoded      %u\n", stats.results[DECODE_OK]);
+  fprintf(report, "crc errors   %u\n", stats.results[DECODE_CRC]);
+  fprintf(report, "rejected     %u (port %u, length %u, format %u)\n",
+          stats.results[DECODE_PORT] + stats.results[DECODE_LENGTH] + stats.results[DECODE_FORMAT],
+          stats.results[DECODE_PORT], stats.results[DECODE_LENGTH], stats.results[DECODE_FORMAT]);
+  fprintf(report, "lines        %llu (%llu bytes)\n", (unsigned long long)stats.lines,
+          (unsigned long long)stats.bytes);
+  fprintf(report, "elapsed      %.3f s\n", elapsed);
+  fprintf(report, "throughput   %.0f uplinks/s, %.0f lines/s\n", records.size() / elapsed,
+          stats.lines / elapsed);
+  fprintf(report, "latency us   p50 %.1f  p95 %.1f  p99 %.1f  max %.1f\n",
+          percentile(stats.latency, 50), percentile(stats.latency, 95),
+          percentile(stats.latency, 99), percentile(stats.latency, 100));
+}
+
+// Main //////////////////////////////////////////////////////////////////////
+
+static void usage()
+{
+  fprintf(stderr,
+          "usage: replay_bench (--input FILE | --generate N) [options]\n"
+          "  --input FILE      webhook JSON lines to replay\n"
+          "  --generate N      generate N compact uplinks\n"
+          "  --devices D       generated devices (100)\n"
+          "  --batch-size S    samples per generated uplink (4)\n"
+          "  --corrupt P       corrupt P per mille of the generated uplinks (0)\n"
+          "  --dump FILE       write the uplinks as webhook JSON lines\n"
+          "  --rate R          replay R uplinks per second, 0 = unpaced (0)\n"
+          "  --lines B         lines per line protocol batch (1000)\n"
+          "  --output FILE     write the batches, - for stdout (discarded)\n");
+}
+
+int main(int argc, char **argv)
+{
+  Options o;
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (!value)
+    {
+      usage();
+      return 2;
+    }
+    i++;
+    if (!strcmp(arg, "--input"))
+      o.input = value;
+    else if (!strcmp(arg, "--generate"))
+      o.generate = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--devices"))
+      o.devices = std::max(1UL, strtoul(value, NULL, 10));
+    else if (!strcmp(arg, "--batch-size"))
+      o.batchSize = std::min((unsigned long)MAX_BATCH_SIZE, std::max(1UL, strtoul(value, NULL, 10)));
+    else if (!strcmp(arg, "--corrupt"))
+      o.corrupt = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--dump"))
+      o.dump = value;
+    else if (!strcmp(arg, "--rate"))
+      o.rate = atof(value);
+    else if (!strcmp(arg, "--lines"))
+      o.lines = std::max(1UL, strtoul(value, NULL, 10));
+    else if (!strcmp(arg, "--output"))
+      o.output = value;
+    else
+    {
+      usage();
+      return 2;
+    }
+  }
+
+  std::vector<Record> records;
+  if (o.input)
+  {
+    if (!readRecords(o.input, records))
+    {
+      return 1;
+    }
+  }
+  else if (o.generate)
+  {
+    generateRecords(o, records);
+  }
+  else
+  {
+    usage();
+    return 2;
+  }
+
+  if (o.dump)
+  {
+    dumpRecords(o.dump, records);
+  }
+
+  Stats stats;
+  replay(o, records, stats);
+  return 0;
+}